@@ -11,5 +11,13 @@ public class NetworkedRPGTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		ExtraModuleNames.Add("NetworkedRPG");
 		ExtraModuleNames.Add("NetworkedMenu");
+
+		// Push model replication needs a unique build environment, which an installed engine can't provide. Without
+		// it dirty marking compiles out and push based properties are compared every update as before.
+		if (!UnrealBuildTool.IsEngineInstalled())
+		{
+			BuildEnvironment = TargetBuildEnvironment.Unique;
+			bWithPushModel = true;
+		}
 	}
 }
@@ -8,7 +8,7 @@ public class NetworkedRPG : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "AIModule" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "AIModule", "ReplicationGraph", "NetCore", "SignificanceManager" });
 
 		PrivateDependencyModuleNames.AddRange(new string[]
         {
@@ -17,7 +17,8 @@ public class NetworkedRPG : ModuleRules
 			"OnlineSubsystem",
 			"GameplayAbilities",
 			"GameplayTags",
-			"GameplayTasks"
+			"GameplayTasks",
+			"NavigationSystem"
         });
 	}
 }
@@ -15,12 +15,16 @@ static FVector AimingCameraOffset = FVector(250.f,100.f,80.f);
 #define ECC_Weapon          ECC_GameTraceChannel2
 #define ECC_Targeting       ECC_GameTraceChannel3
 #define ECC_Target          ECC_GameTraceChannel4
+#define ECC_Interaction     ECC_GameTraceChannel5
 
 // For Actor Components
 #define OwnerHasAuthority() (GetOwnerRole() == ROLE_Authority)
 
 int32 DebugCombatComponent = 0;
 
+/** Stat group for the game's systems, view with 'stat NRPG' */
+DECLARE_STATS_GROUP(TEXT("NRPG"), STATGROUP_NRPG, STATCAT_Advanced);
+
 UENUM(BlueprintType)
 enum class ENAbilityInputID : uint8
 {
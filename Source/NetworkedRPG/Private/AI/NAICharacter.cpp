@@ -2,19 +2,134 @@
 
 
 #include "NetworkedRPG/Public/AI/NAICharacter.h"
-#include "Perception/AIPerceptionComponent.h"
+#include "AI/NAIController.h"
+#include "AbilitySystem/NAbilitySystemComponent.h"
+#include "AbilitySystem/NAttributeSetBase.h"
+#include "AbilitySystem/NRegenSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
 
 ANAICharacter::ANAICharacter(const FObjectInitializer& ObjectInitializer) : ANCharacterBase(ObjectInitializer)
 {
-    // AIPerceptionComponent = CreateDefaultSubobject<UAIPerceptionComponent>("AIPerception");
+    AIControllerClass = ANAIController::StaticClass();
+    AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+    // Agents following a shared path keep apart with RVO instead of each finding a path around the others
+    GetCharacterMovement()->bUseRVOAvoidance = true;
+    GetCharacterMovement()->AvoidanceConsiderationRadius = 300.f;
+
+    // Minimal mode, nobody needs the effects of an AI replicated. Tags, cues and attributes still replicate.
+    AbilitySystemComponent = CreateDefaultSubobject<UNAbilitySystemComponent>(TEXT("AbilitySystemComponent"));
+    AbilitySystemComponent->SetIsReplicated(true);
+    AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
+
+    // Registers with the AbilitySystemComponent as a subobject of its owner
+    AttributeSetBase = CreateDefaultSubobject<UNAttributeSetBase>(TEXT("AttributeSetBase"));
+
+    bSignificanceTickMesh = true;
 }
 
+
+void ANAICharacter::SetSignificance(ENSignificance InSignificance, const FNSignificanceSettings& Settings)
+{
+    Super::SetSignificance(InSignificance, Settings);
+
+    // Clients only follow replicated movement and play the montages they are sent
+    if (!HasAuthority())
+    {
+        return;
+    }
+
+    // Nav walking projects to the navmesh instead of sweeping the capsule and finding the floor every move
+    UCharacterMovementComponent* Movement = GetCharacterMovement();
+    if (Settings.bSimplifiedMovement && Movement->MovementMode == MOVE_Walking)
+    {
+        Movement->SetMovementMode(MOVE_NavWalking);
+    }
+    else if (!Settings.bSimplifiedMovement && Movement->MovementMode == MOVE_NavWalking)
+    {
+        // Finds the floor again, or stays on the navmesh if the capsule doesn't fit there yet
+        Movement->SetMovementMode(MOVE_Walking);
+    }
+
+    bSignificanceTickMesh = Settings.bTickMesh;
+    UpdateMeshTick();
+}
+
+
+void ANAICharacter::UpdateMeshTick()
+{
+    // Without a viewer nothing needs the pose of an idle agent, not even for weapon sockets. A fighting one still
+    // needs its montages to advance, their notifies end attacks and weapon swaps.
+    const ANAIController* AIController = GetController<ANAIController>();
+    const UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+    const bool bBusy = (AnimInstance && AnimInstance->IsAnyMontagePlaying()) || (AIController && AIController->GetTargetCharacter());
+
+    GetMesh()->SetComponentTickEnabled(bSignificanceTickMesh || bBusy);
+}
+
+
 void ANAICharacter::BeginPlay()
 {
     Super::BeginPlay();
 
-    // AIPerceptionComponent->Activate();
-    
+    AbilitySystemComponent->InitAbilityActorInfo(this, this);
+
+    if (HasAuthority())
+    {
+        InitializeAttributes();
+        AddStartupEffects();
+        AddCharacterAbilities();
+
+        HealthChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AttributeSetBase->GetHealthAttribute()).AddUObject(this, &ANAICharacter::HealthChanged);
 
+        if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+        {
+            AnimInstance->OnMontageStarted.AddDynamic(this, &ANAICharacter::MontageStarted);
+            AnimInstance->OnMontageEnded.AddDynamic(this, &ANAICharacter::MontageEnded);
+        }
+
+        if (UNRegenSubsystem* RegenSubsystem = GetWorld()->GetSubsystem<UNRegenSubsystem>())
+        {
+            RegenSubsystem->RegisterAttributeSet(AttributeSetBase);
+        }
+    }
+}
+
+
+void ANAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (HasAuthority())
+    {
+        AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AttributeSetBase->GetHealthAttribute()).Remove(HealthChangedDelegateHandle);
+
+        if (UNRegenSubsystem* RegenSubsystem = GetWorld()->GetSubsystem<UNRegenSubsystem>())
+        {
+            RegenSubsystem->UnregisterAttributeSet(AttributeSetBase);
+        }
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void ANAICharacter::HealthChanged(const FOnAttributeChangeData& Data)
+{
+    if (!IsAlive() && !AbilitySystemComponent->HasMatchingGameplayTag(DeadTag))
+    {
+        Die();
+    }
 }
 
+
+void ANAICharacter::MontageStarted(UAnimMontage* Montage)
+{
+    UpdateMeshTick();
+}
+
+
+void ANAICharacter::MontageEnded(UAnimMontage* Montage, bool bInterrupted)
+{
+    UpdateMeshTick();
+}
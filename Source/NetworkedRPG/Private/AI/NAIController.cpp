@@ -2,4 +2,290 @@
 
 
 #include "NetworkedRPG/Public/AI/NAIController.h"
+#include "AI/NAICharacter.h"
+#include "AI/NAIManagerSubsystem.h"
+#include "AI/NAINavigationSubsystem.h"
+#include "AI/NAIPerceptionSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "Characters/NCharacterBase.h"
+#include "Components/Combat/NCombatComponent.h"
+#include "Navigation/PathFollowingComponent.h"
 
+ANAIController::ANAIController()
+{
+    SightRadius = 1500.f;
+    LoseTargetRadius = 2000.f;
+    MemoryDuration = 5.f;
+    AttackRange = 200.f;
+    DirectMoveDistance = 600.f;
+    AttackAbilityInputID = ENAbilityInputID::PrimaryWeaponAbility;
+    CorridorId = INDEX_NONE;
+}
+
+
+void ANAIController::OnPossess(APawn* InPawn)
+{
+    Super::OnPossess(InPawn);
+
+    if (UNAIManagerSubsystem* Manager = UNAIManagerSubsystem::Get(GetWorld()))
+    {
+        Manager->RegisterAgent(this);
+    }
+
+    if (UNAIPerceptionSubsystem* Perception = UNAIPerceptionSubsystem::Get(GetWorld()))
+    {
+        Perception->RegisterListener(this);
+    }
+}
+
+
+void ANAIController::OnUnPossess()
+{
+    SetTargetCharacter(nullptr, nullptr);
+    PerceivedCharacters.Reset();
+
+    if (UNAIManagerSubsystem* Manager = UNAIManagerSubsystem::Get(GetWorld()))
+    {
+        Manager->UnregisterAgent(this);
+    }
+
+    if (UNAIPerceptionSubsystem* Perception = UNAIPerceptionSubsystem::Get(GetWorld()))
+    {
+        Perception->UnregisterListener(this);
+    }
+
+    Super::OnUnPossess();
+}
+
+
+void ANAIController::Decide()
+{
+    ANCharacterBase* ControlledCharacter = GetPawn<ANCharacterBase>();
+    if (!ControlledCharacter || !ControlledCharacter->IsAlive())
+    {
+        SetTargetCharacter(nullptr, nullptr);
+        return;
+    }
+
+    const FVector Location = ControlledCharacter->GetActorLocation();
+
+    // Keep the current target until it dies, gets away or is forgotten
+    ANCharacterBase* Target = TargetCharacter.Get();
+    if (Target && (!Target->IsAlive() || !FindPerceived(Target) || FVector::DistSquared(Location, Target->GetActorLocation()) > FMath::Square(LoseTargetRadius)))
+    {
+        Target = nullptr;
+    }
+
+    bool bNewTarget = false;
+    if (!Target)
+    {
+        const FNAIPerceivedCharacter* Found = FindNearestPerceived(Location);
+        Target = Found ? Found->Character.Get() : nullptr;
+        bNewTarget = Target != nullptr;
+        SetTargetCharacter(Target, Found ? Found->TargetComponent.Get() : nullptr);
+    }
+
+    if (!Target)
+    {
+        return;
+    }
+
+    if (FVector::DistSquared(Location, Target->GetActorLocation()) <= FMath::Square(AttackRange))
+    {
+        if (GetMoveStatus() == EPathFollowingStatus::Moving)
+        {
+            StopMovement();
+        }
+
+        TryAttack(ControlledCharacter);
+    }
+    else
+    {
+        MoveToTarget(Target, bNewTarget);
+    }
+}
+
+
+void ANAIController::MoveToTarget(ANCharacterBase* Target, bool bNewTarget)
+{
+    const float AcceptanceRadius = AttackRange * 0.75f;
+
+    UNAINavigationSubsystem* Navigation = UNAINavigationSubsystem::Get(GetWorld());
+    const float DistanceSquared = FVector::DistSquared(GetPawn()->GetActorLocation(), Target->GetActorLocation());
+    if (!Navigation || DistanceSquared <= FMath::Square(DirectMoveDistance))
+    {
+        // Path following tracks the goal actor itself, so only start a move when idle or the target changed
+        if (bNewTarget || FollowedPath.IsValid() || GetMoveStatus() != EPathFollowingStatus::Moving)
+        {
+            MoveToActor(Target, AcceptanceRadius);
+            SharedPath.Reset();
+            FollowedPath.Reset();
+        }
+        return;
+    }
+
+    const FNavPathSharedPtr Path = Navigation->RequestPath(this, Target, CorridorId);
+    if (!Path.IsValid())
+    {
+        // The corridor waits for its first path, don't keep running after the last target meanwhile
+        if (bNewTarget)
+        {
+            StopMovement();
+        }
+        return;
+    }
+
+    // A corridor's new path is a new object, join it again from where the agent is now
+    if (Path != SharedPath || GetMoveStatus() != EPathFollowingStatus::Moving)
+    {
+        SharedPath = Path;
+
+        const FNavPathSharedPtr AgentPath = Navigation->JoinPath(this, CorridorId);
+        if (!AgentPath.IsValid())
+        {
+            MoveToActor(Target, AcceptanceRadius);
+            FollowedPath.Reset();
+            return;
+        }
+
+        FAIMoveRequest MoveRequest(Target);
+        MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+        RequestMove(MoveRequest, AgentPath);
+        FollowedPath = AgentPath;
+    }
+}
+
+
+void ANAIController::UpdatePerception(const TArray<const FNAITarget*>& VisibleTargets, float Time)
+{
+    for (FNAIPerceivedCharacter& Perceived : PerceivedCharacters)
+    {
+        Perceived.bVisible = false;
+    }
+
+    for (const FNAITarget* Target : VisibleTargets)
+    {
+        FNAIPerceivedCharacter* Perceived = PerceivedCharacters.FindByPredicate([Target](const FNAIPerceivedCharacter& Entry)
+        {
+            return Entry.Character == Target->Character;
+        });
+
+        if (!Perceived)
+        {
+            Perceived = &PerceivedCharacters.AddDefaulted_GetRef();
+            Perceived->Character = Target->Character;
+        }
+
+        Perceived->TargetComponent = Target->TargetComponent;
+        Perceived->LastSeenLocation = Target->Location;
+        Perceived->LastSeenTime = Time;
+        Perceived->bVisible = true;
+    }
+
+    PerceivedCharacters.RemoveAllSwap([this, Time](const FNAIPerceivedCharacter& Entry)
+    {
+        return !Entry.Character.IsValid() || Time - Entry.LastSeenTime > MemoryDuration;
+    });
+}
+
+
+const FNAIPerceivedCharacter* ANAIController::FindNearestPerceived(const FVector& Location) const
+{
+    const FNAIPerceivedCharacter* Nearest = nullptr;
+    float NearestDistanceSquared = MAX_flt;
+
+    for (const FNAIPerceivedCharacter& Perceived : PerceivedCharacters)
+    {
+        const ANCharacterBase* Character = Perceived.Character.Get();
+        if (!Character || !Character->IsAlive())
+        {
+            continue;
+        }
+
+        // Anything in sight before anything remembered
+        if (Nearest && Nearest->bVisible && !Perceived.bVisible)
+        {
+            continue;
+        }
+
+        const float DistanceSquared = FVector::DistSquared(Location, Perceived.LastSeenLocation);
+        if (!Nearest || (Perceived.bVisible && !Nearest->bVisible) || DistanceSquared < NearestDistanceSquared)
+        {
+            NearestDistanceSquared = DistanceSquared;
+            Nearest = &Perceived;
+        }
+    }
+
+    return Nearest;
+}
+
+
+const FNAIPerceivedCharacter* ANAIController::FindPerceived(const ANCharacterBase* Character) const
+{
+    return PerceivedCharacters.FindByPredicate([Character](const FNAIPerceivedCharacter& Entry)
+    {
+        return Entry.Character.Get() == Character;
+    });
+}
+
+
+void ANAIController::SetTargetCharacter(ANCharacterBase* InTarget, UPrimitiveComponent* TargetComponent)
+{
+    if (TargetCharacter.Get() == InTarget)
+    {
+        return;
+    }
+
+    TargetCharacter = InTarget;
+
+    // Keeps the mesh of a culled agent ticking while it fights
+    if (ANAICharacter* AICharacter = GetPawn<ANAICharacter>())
+    {
+        AICharacter->UpdateMeshTick();
+    }
+
+    const ANCharacterBase* ControlledCharacter = GetPawn<ANCharacterBase>();
+    UNCombatComponent* CombatComponent = ControlledCharacter ? ControlledCharacter->GetCombatComponent() : nullptr;
+
+    if (InTarget)
+    {
+        SetFocus(InTarget);
+        if (CombatComponent)
+        {
+            CombatComponent->LockTarget(TargetComponent);
+        }
+    }
+    else
+    {
+        ClearFocus(EAIFocusPriority::Gameplay);
+        StopMovement();
+        SharedPath.Reset();
+        FollowedPath.Reset();
+        CorridorId = INDEX_NONE;
+        if (CombatComponent)
+        {
+            CombatComponent->LockTarget(nullptr);
+        }
+    }
+}
+
+
+bool ANAIController::TryAttack(ANCharacterBase* ControlledCharacter) const
+{
+    UAbilitySystemComponent* ASC = ControlledCharacter->GetAbilitySystemComponent();
+    if (!ASC)
+    {
+        return false;
+    }
+
+    const int32 InputID = static_cast<int32>(AttackAbilityInputID);
+    for (const FGameplayAbilitySpec& Spec : ASC->GetActivatableAbilities())
+    {
+        if (Spec.InputID == InputID)
+        {
+            return !Spec.IsActive() && ASC->TryActivateAbility(Spec.Handle);
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,350 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/NAIManagerSubsystem.h"
+#include "AI/NAIController.h"
+#include "AI/NAINavigationSubsystem.h"
+#include "AI/NAIPerceptionSubsystem.h"
+#include "Characters/NCharacterBase.h"
+#include "NSignificanceManager.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Update"), STAT_NAIUpdate, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("AI Decisions"), STAT_NAIDecisions, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Agents"), STAT_NAIAgents, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Decisions Made"), STAT_NAIDecisionsMade, STATGROUP_NRPG);
+
+static int32 AIDecisionsPerFrame = 20;
+FAutoConsoleVariableRef CVarAIDecisionsPerFrame(
+    TEXT("NRPG.AI.DecisionsPerFrame"),
+    AIDecisionsPerFrame,
+    TEXT("Max AI agents that decide per frame, the rest wait for their turn in the round robin."),
+    ECVF_Default
+    );
+
+static float AIDecisionBudgetMs = 0.5f;
+FAutoConsoleVariableRef CVarAIDecisionBudgetMs(
+    TEXT("NRPG.AI.DecisionBudgetMs"),
+    AIDecisionBudgetMs,
+    TEXT("Milliseconds of AI decisions per frame, after which the rest wait for the next frame. 0 for no limit."),
+    ECVF_Default
+    );
+
+static int32 DebugAIManager = 0;
+FAutoConsoleVariableRef CVarDebugAIManager(
+    TEXT("NRPG.Debug.AIManager"),
+    DebugAIManager,
+    TEXT("Print AI registration: 0 - Off, 1 - On"),
+    ECVF_Cheat
+    );
+
+namespace NAIManager
+{
+    /** Frames before a benchmark starts measuring, for the significance manager to apply the viewpoints' buckets and
+      * the agents to pick their targets */
+    static constexpr int32 BenchmarkWarmUpFrames = 60;
+
+    /** Measures the server ms per frame of the registered agents, see UNAIManagerSubsystem::StartBenchmark() */
+    static void Benchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        UNAIManagerSubsystem* Manager = UNAIManagerSubsystem::Get(World);
+        if (!Manager || World->GetNetMode() == NM_Client)
+        {
+            Print(World, FString::Printf(TEXT("%s Only run on the server."), *FString(__FUNCTION__)), EPrintType::Warning);
+            return;
+        }
+
+        if (Manager->GetNumAgents() == 0)
+        {
+            Print(World, FString::Printf(TEXT("%s No AI agents, spawn some with 'NRPG.Significance.SpawnCrowd <Count>' first."), *FString(__FUNCTION__)), EPrintType::Warning);
+            return;
+        }
+
+        const int32 Frames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300;
+        const int32 NumViewpoints = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4;
+        const bool bOpposingTeams = Args.Num() > 2 ? FCString::Atoi(*Args[2]) != 0 : true;
+        Manager->StartBenchmark(Frames, NumViewpoints, bOpposingTeams);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAIBenchmark(
+    TEXT("NRPG.AI.Benchmark"),
+    TEXT("Prints the average AI update and game thread ms per frame of the server over the next frames, for the agents spawned so far. ")
+    TEXT("Places <Viewpoints> significance viewpoints among the agents as stand ins for players, and with <OpposingTeams> ")
+    TEXT("moves every other agent to the other team for good, so they fight. ")
+    TEXT("Run headless with -server -nullrhi, after 'NRPG.Significance.SpawnCrowd <Count>'. Args: <Frames=300> <Viewpoints=4> <OpposingTeams=1>"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&NAIManager::Benchmark)
+    );
+
+
+void UNAIManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    NextAgent = 0;
+    BenchmarkWarmUpFramesRemaining = 0;
+    BenchmarkFramesRemaining = 0;
+}
+
+
+void UNAIManagerSubsystem::Deinitialize()
+{
+    DEC_DWORD_STAT_BY(STAT_NAIAgents, Agents.Num());
+    Agents.Empty();
+
+    Super::Deinitialize();
+}
+
+
+void UNAIManagerSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NAIUpdate);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    RunDecisions();
+
+    if (BenchmarkFramesRemaining > 0)
+    {
+        UpdateBenchmark(StartTime, FPlatformTime::Seconds() - StartTime);
+    }
+}
+
+
+bool UNAIManagerSubsystem::IsTickable() const
+{
+    const UWorld* World = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && World && World->IsGameWorld() && Agents.Num() > 0;
+}
+
+
+TStatId UNAIManagerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNAIManagerSubsystem, STATGROUP_Tickables);
+}
+
+
+UNAIManagerSubsystem* UNAIManagerSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UNAIManagerSubsystem>() : nullptr;
+}
+
+
+void UNAIManagerSubsystem::RegisterAgent(ANAIController* Agent)
+{
+    if (!Agent || !Agent->HasAuthority() || Agents.Contains(Agent))
+    {
+        return;
+    }
+
+    if (DebugAIManager)
+    {
+        Print(GetWorld(), FString::Printf(TEXT("%s %s"), *FString(__FUNCTION__), *Agent->GetName()));
+    }
+
+    // Behind the cursor, so it decides after everyone already waiting
+    Agents.Insert(Agent, NextAgent);
+    ++NextAgent;
+    INC_DWORD_STAT(STAT_NAIAgents);
+}
+
+
+void UNAIManagerSubsystem::UnregisterAgent(ANAIController* Agent)
+{
+    const int32 Index = Agents.IndexOfByKey(Agent);
+    if (Index == INDEX_NONE)
+    {
+        return;
+    }
+
+    if (DebugAIManager)
+    {
+        Print(GetWorld(), FString::Printf(TEXT("%s %s"), *FString(__FUNCTION__), *Agent->GetName()));
+    }
+
+    // Stable, the order is the round robin
+    Agents.RemoveAt(Index);
+    if (Index < NextAgent)
+    {
+        --NextAgent;
+    }
+    DEC_DWORD_STAT(STAT_NAIAgents);
+}
+
+
+void UNAIManagerSubsystem::StartBenchmark(int32 Frames, int32 NumViewpoints, bool bOpposingTeams)
+{
+    TArray<ANCharacterBase*> Characters;
+    FVector Center = FVector::ZeroVector;
+    for (const TWeakObjectPtr<ANAIController>& Agent : Agents)
+    {
+        if (ANCharacterBase* Character = Agent.IsValid() ? Agent->GetPawn<ANCharacterBase>() : nullptr)
+        {
+            Center += Character->GetActorLocation();
+            Characters.Add(Character);
+        }
+    }
+
+    if (Characters.Num() == 0)
+    {
+        return;
+    }
+
+    Center /= Characters.Num();
+
+    // Alternating in spawn order, so every agent in the crowd's grid has hostile neighbours
+    if (bOpposingTeams)
+    {
+        const ENTeam FirstTeam = Characters[0]->GetTeam();
+        const ENTeam OtherTeam = FirstTeam == ENTeam::Enemy ? ENTeam::Friendly : ENTeam::Enemy;
+        for (int32 i = 0; i < Characters.Num(); ++i)
+        {
+            Characters[i]->SetTeam(i % 2 == 0 ? FirstTeam : OtherTeam);
+        }
+    }
+
+    // A headless server has no player viewpoints, so every agent would be culled. Stand ins spread through the crowd
+    // at eye height, looking at its center.
+    TArray<FTransform> Viewpoints;
+    for (int32 i = 0; i < FMath::Min(NumViewpoints, Characters.Num()); ++i)
+    {
+        const FVector Location = Characters[i * Characters.Num() / NumViewpoints]->GetActorLocation() + FVector(0.f, 0.f, 100.f);
+        const FVector Direction = Center - Location;
+        Viewpoints.Emplace(Direction.IsNearlyZero() ? FRotator::ZeroRotator : Direction.Rotation(), Location);
+    }
+
+    if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+    {
+        SignificanceManager->SetExtraViewpoints(Viewpoints);
+    }
+
+    BenchmarkWarmUpFramesRemaining = NAIManager::BenchmarkWarmUpFrames;
+    BenchmarkFramesRemaining = FMath::Max(Frames, 1);
+    BenchmarkFrames = 0;
+    BenchmarkDecisionSeconds = 0.0;
+    BenchmarkFrameSeconds = 0.0;
+    BenchmarkLastFrameTime = 0.0;
+
+    Print(GetWorld(), FString::Printf(TEXT("%s Measuring %d agents with %d viewpoints over %d frames, after %d frames of warm up."),
+        *FString(__FUNCTION__),
+        Agents.Num(),
+        Viewpoints.Num(),
+        BenchmarkFramesRemaining,
+        BenchmarkWarmUpFramesRemaining));
+}
+
+
+void UNAIManagerSubsystem::RunDecisions()
+{
+    SCOPE_CYCLE_COUNTER(STAT_NAIDecisions);
+
+    const double StartTime = FPlatformTime::Seconds();
+    const double BudgetSeconds = AIDecisionBudgetMs / 1000.0;
+
+    // Never more than once around, so nobody decides twice in a frame
+    int32 DecisionsLeft = FMath::Min(AIDecisionsPerFrame, Agents.Num());
+    int32 Decided = 0;
+    while (DecisionsLeft > 0 && Agents.Num() > 0)
+    {
+        if (NextAgent >= Agents.Num())
+        {
+            NextAgent = 0;
+        }
+
+        ANAIController* Agent = Agents[NextAgent].Get();
+        if (!Agent)
+        {
+            Agents.RemoveAt(NextAgent);
+            DEC_DWORD_STAT(STAT_NAIAgents);
+
+            // One less agent left to go around
+            DecisionsLeft = FMath::Min(DecisionsLeft, Agents.Num() - Decided);
+            continue;
+        }
+
+        ++NextAgent;
+        --DecisionsLeft;
+        ++Decided;
+        Agent->Decide();
+        INC_DWORD_STAT(STAT_NAIDecisionsMade);
+
+        if (BudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= BudgetSeconds)
+        {
+            break;
+        }
+    }
+}
+
+
+void UNAIManagerSubsystem::UpdateBenchmark(double FrameStartTime, double DecisionSeconds)
+{
+    // The game thread's time since the last frame, less the time the server slept to hold its tick rate. DeltaTime
+    // includes the sleep, so it would read the tick rate's frame time until the server can't keep up.
+    const double FrameSeconds = BenchmarkLastFrameTime > 0.0 ? FrameStartTime - BenchmarkLastFrameTime - FApp::GetIdleTime() : 0.0;
+    BenchmarkLastFrameTime = FrameStartTime;
+
+    if (BenchmarkWarmUpFramesRemaining > 0)
+    {
+        if (--BenchmarkWarmUpFramesRemaining == 0)
+        {
+            BenchmarkStartPerceptionSeconds = GetPerceptionSeconds();
+            BenchmarkStartNavigationSeconds = GetNavigationSeconds();
+        }
+
+        return;
+    }
+
+    BenchmarkDecisionSeconds += DecisionSeconds;
+    BenchmarkFrameSeconds += FMath::Max(FrameSeconds, 0.0);
+    ++BenchmarkFrames;
+
+    if (--BenchmarkFramesRemaining > 0)
+    {
+        return;
+    }
+
+    if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+    {
+        SignificanceManager->SetExtraViewpoints(TArray<FTransform>());
+    }
+
+    // Shows whether the agents had anything to do, none with a target means the numbers are of idle agents
+    int32 NumWithTarget = 0;
+    for (const TWeakObjectPtr<ANAIController>& Agent : Agents)
+    {
+        NumWithTarget += Agent.IsValid() && Agent->GetTargetCharacter() != nullptr;
+    }
+
+    const double PerceptionSeconds = GetPerceptionSeconds() - BenchmarkStartPerceptionSeconds;
+    const double NavigationSeconds = GetNavigationSeconds() - BenchmarkStartNavigationSeconds;
+    const double AISeconds = BenchmarkDecisionSeconds + PerceptionSeconds + NavigationSeconds;
+
+    Print(GetWorld(), FString::Printf(TEXT("%s %d agents, %d with a target: AI %.3f ms/frame (decisions %.3f, perception %.3f, navigation %.3f), server game thread %.2f ms/frame, over %d frames."),
+        *FString(__FUNCTION__),
+        Agents.Num(),
+        NumWithTarget,
+        AISeconds * 1000.0 / BenchmarkFrames,
+        BenchmarkDecisionSeconds * 1000.0 / BenchmarkFrames,
+        PerceptionSeconds * 1000.0 / BenchmarkFrames,
+        NavigationSeconds * 1000.0 / BenchmarkFrames,
+        BenchmarkFrameSeconds * 1000.0 / BenchmarkFrames,
+        BenchmarkFrames),
+        EPrintType::Success);
+}
+
+
+double UNAIManagerSubsystem::GetPerceptionSeconds() const
+{
+    const UNAIPerceptionSubsystem* Perception = UNAIPerceptionSubsystem::Get(GetWorld());
+    return Perception ? Perception->GetTickSeconds() : 0.0;
+}
+
+
+double UNAIManagerSubsystem::GetNavigationSeconds() const
+{
+    const UNAINavigationSubsystem* Navigation = UNAINavigationSubsystem::Get(GetWorld());
+    return Navigation ? Navigation->GetTickSeconds() : 0.0;
+}
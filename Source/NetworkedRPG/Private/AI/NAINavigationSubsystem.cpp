@@ -0,0 +1,429 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/NAINavigationSubsystem.h"
+#include "AI/NAIController.h"
+#include "NavigationSystem.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Navigation Update"), STAT_NAINavigationUpdate, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("AI Navigation Find Path"), STAT_NAINavigationFindPath, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Navigation Corridors"), STAT_NAINavigationCorridors, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Navigation Path Requests"), STAT_NAINavigationRequests, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Navigation Corridors Joined"), STAT_NAINavigationJoined, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Navigation Paths Found"), STAT_NAINavigationPathsFound, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Navigation Paths Deferred"), STAT_NAINavigationPathsDeferred, STATGROUP_NRPG);
+
+static int32 AISharedNavigation = 1;
+FAutoConsoleVariableRef CVarAISharedNavigation(
+    TEXT("NRPG.AI.SharedNavigation"),
+    AISharedNavigation,
+    TEXT("Share AI paths per goal and group: 0 - Off, every agent finds its own path, 1 - On"),
+    ECVF_Default
+    );
+
+static float AINavGroupCellSize = 1000.f;
+FAutoConsoleVariableRef CVarAINavGroupCellSize(
+    TEXT("NRPG.AI.NavGroupCellSize"),
+    AINavGroupCellSize,
+    TEXT("Agents chasing the same goal from the same cell of this size share a path."),
+    ECVF_Default
+    );
+
+static float AINavJoinDistance = 300.f;
+FAutoConsoleVariableRef CVarAINavJoinDistance(
+    TEXT("NRPG.AI.NavJoinDistance"),
+    AINavJoinDistance,
+    TEXT("Agents this close to a path leading to their goal follow it instead of opening a corridor."),
+    ECVF_Default
+    );
+
+static float AINavRepathInterval = 0.5f;
+FAutoConsoleVariableRef CVarAINavRepathInterval(
+    TEXT("NRPG.AI.NavRepathInterval"),
+    AINavRepathInterval,
+    TEXT("Min seconds between paths of a corridor."),
+    ECVF_Default
+    );
+
+static float AINavRepathDistance = 200.f;
+FAutoConsoleVariableRef CVarAINavRepathDistance(
+    TEXT("NRPG.AI.NavRepathDistance"),
+    AINavRepathDistance,
+    TEXT("A corridor finds a new path once its goal moved further than this from the end of the path."),
+    ECVF_Default
+    );
+
+static int32 AINavPathsPerFrame = 4;
+FAutoConsoleVariableRef CVarAINavPathsPerFrame(
+    TEXT("NRPG.AI.NavPathsPerFrame"),
+    AINavPathsPerFrame,
+    TEXT("Max corridor paths found per frame. 0 for no limit."),
+    ECVF_Default
+    );
+
+static float AINavCorridorLifetime = 2.f;
+FAutoConsoleVariableRef CVarAINavCorridorLifetime(
+    TEXT("NRPG.AI.NavCorridorLifetime"),
+    AINavCorridorLifetime,
+    TEXT("Seconds a corridor stays open after its last agent asked for it."),
+    ECVF_Default
+    );
+
+static int32 DebugAINavigation = 0;
+FAutoConsoleVariableRef CVarDebugAINavigation(
+    TEXT("NRPG.Debug.AINavigation"),
+    DebugAINavigation,
+    TEXT("Draw AI corridor paths when found: 0 - Off, 1 - On"),
+    ECVF_Cheat
+    );
+
+
+void UNAINavigationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    NextCorridorId = 0;
+    TickSeconds = 0.0;
+}
+
+
+void UNAINavigationSubsystem::Deinitialize()
+{
+    DEC_DWORD_STAT_BY(STAT_NAINavigationCorridors, Corridors.Num());
+    Corridors.Empty();
+    PathQueue.Empty();
+
+    Super::Deinitialize();
+}
+
+
+void UNAINavigationSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NAINavigationUpdate);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    UpdateCorridors(GetWorld()->GetTimeSeconds());
+
+    TickSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+
+bool UNAINavigationSubsystem::IsTickable() const
+{
+    const UWorld* World = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && World && World->IsGameWorld() && Corridors.Num() > 0;
+}
+
+
+TStatId UNAINavigationSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNAINavigationSubsystem, STATGROUP_Tickables);
+}
+
+
+UNAINavigationSubsystem* UNAINavigationSubsystem::Get(const UWorld* World)
+{
+    return World && AISharedNavigation ? World->GetSubsystem<UNAINavigationSubsystem>() : nullptr;
+}
+
+
+FNavPathSharedPtr UNAINavigationSubsystem::RequestPath(const ANAIController* Agent, AActor* Goal, int32& InOutCorridorId)
+{
+    const APawn* Pawn = Agent ? Agent->GetPawn() : nullptr;
+    if (!Pawn || !Goal)
+    {
+        InOutCorridorId = INDEX_NONE;
+        return nullptr;
+    }
+
+    INC_DWORD_STAT(STAT_NAINavigationRequests);
+
+    const FVector Location = Pawn->GetNavAgentLocation();
+    const float Time = GetWorld()->GetTimeSeconds();
+
+    // Stay in the current corridor while it leads to the goal and the agent is still on its way along it
+    FNAINavCorridor* Corridor = Corridors.Find(InOutCorridorId);
+    if (!Corridor || Corridor->Goal.Get() != Goal || (Corridor->Path.IsValid() && !IsNearPath(*Corridor, Location)))
+    {
+        const FIntPoint Cell = GetCell(Location);
+        InOutCorridorId = FindCorridor(Goal, Location, Cell);
+        Corridor = Corridors.Find(InOutCorridorId);
+
+        if (Corridor)
+        {
+            INC_DWORD_STAT(STAT_NAINavigationJoined);
+        }
+        else
+        {
+            UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+            ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(Agent->GetNavAgentPropertiesRef()) : nullptr;
+            if (!NavData)
+            {
+                InOutCorridorId = INDEX_NONE;
+                return nullptr;
+            }
+
+            InOutCorridorId = NextCorridorId++;
+            Corridor = &Corridors.Add(InOutCorridorId);
+            Corridor->Goal = Goal;
+            Corridor->NavData = NavData;
+            Corridor->Cell = Cell;
+            Corridor->PathGoalLocation = FVector::ZeroVector;
+            Corridor->PathTime = 0.f;
+            Corridor->bPathFailed = false;
+            Corridor->RequestLocationSum = FVector::ZeroVector;
+            Corridor->NumRequests = 0;
+            INC_DWORD_STAT(STAT_NAINavigationCorridors);
+        }
+    }
+
+    if (Corridor->NumRequests == 0)
+    {
+        Corridor->FirstRequestLocation = Location;
+    }
+
+    Corridor->RequestLocationSum += Location;
+    ++Corridor->NumRequests;
+    Corridor->LastRequestTime = Time;
+
+    return Corridor->Path;
+}
+
+
+FNavPathSharedPtr UNAINavigationSubsystem::JoinPath(const ANAIController* Agent, int32 CorridorId) const
+{
+    const FNAINavCorridor* Corridor = Corridors.Find(CorridorId);
+    const APawn* Pawn = Agent ? Agent->GetPawn() : nullptr;
+    ANavigationData* NavData = Corridor ? Corridor->NavData.Get() : nullptr;
+    if (!Pawn || !NavData || !Corridor->Path.IsValid())
+    {
+        return nullptr;
+    }
+
+    const FVector Location = Pawn->GetNavAgentLocation();
+    const TArray<FNavPathPoint>& Points = Corridor->Path->GetPathPoints();
+    if (Points.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    // Joins where the path passes closest, agents beside a later segment don't walk back to the start
+    FVector JoinLocation = Points[0].Location;
+    int32 NextIndex = 1;
+    float JoinDistanceSquared = FVector::DistSquared(Location, JoinLocation);
+    for (int32 Index = 1; Index < Points.Num(); ++Index)
+    {
+        const FVector Closest = FMath::ClosestPointOnSegment(Location, Points[Index - 1].Location, Points[Index].Location);
+        const float DistanceSquared = FVector::DistSquared(Location, Closest);
+        if (DistanceSquared < JoinDistanceSquared)
+        {
+            JoinDistanceSquared = DistanceSquared;
+            JoinLocation = Closest;
+            NextIndex = Index;
+        }
+    }
+
+    TArray<FVector> AgentPoints;
+    AgentPoints.Add(Location);
+
+    // The closest point can be behind a wall or across a gap, then a short path of the agent's own leads there
+    FVector HitLocation;
+    if (NavData->Raycast(Location, JoinLocation, HitLocation, NavData->GetDefaultQueryFilter(), Agent))
+    {
+        UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+        if (!NavSys)
+        {
+            return nullptr;
+        }
+
+        const FPathFindingQuery Query(Agent, *NavData, Location, JoinLocation);
+        const FPathFindingResult Result = NavSys->FindPathSync(Query);
+        if (!Result.IsSuccessful() || !Result.Path.IsValid())
+        {
+            return nullptr;
+        }
+
+        const TArray<FNavPathPoint>& LocalPoints = Result.Path->GetPathPoints();
+        for (int32 Index = 1; Index < LocalPoints.Num() - 1; ++Index)
+        {
+            AgentPoints.Add(LocalPoints[Index].Location);
+        }
+    }
+
+    AgentPoints.Add(JoinLocation);
+    for (int32 Index = NextIndex; Index < Points.Num(); ++Index)
+    {
+        if (!Points[Index].Location.Equals(AgentPoints.Last()))
+        {
+            AgentPoints.Add(Points[Index].Location);
+        }
+    }
+
+    const FNavPathSharedPtr AgentPath = MakeShareable(new FNavigationPath(AgentPoints));
+    AgentPath->SetNavigationDataUsed(NavData);
+    return AgentPath;
+}
+
+
+int32 UNAINavigationSubsystem::FindCorridor(const AActor* Goal, const FVector& Location, const FIntPoint& Cell) const
+{
+    // Only a few corridors lead to each goal, one per group chasing it
+    int32 JoinId = INDEX_NONE;
+    for (const TPair<int32, FNAINavCorridor>& Pair : Corridors)
+    {
+        const FNAINavCorridor& Corridor = Pair.Value;
+        if (Corridor.Goal.Get() != Goal)
+        {
+            continue;
+        }
+
+        if (Corridor.Cell == Cell)
+        {
+            return Pair.Key;
+        }
+
+        if (JoinId == INDEX_NONE && Corridor.Path.IsValid() && IsNearPath(Corridor, Location))
+        {
+            JoinId = Pair.Key;
+        }
+    }
+
+    return JoinId;
+}
+
+
+bool UNAINavigationSubsystem::IsNearPath(const FNAINavCorridor& Corridor, const FVector& Location)
+{
+    const TArray<FNavPathPoint>& Points = Corridor.Path->GetPathPoints();
+    const float JoinDistanceSquared = FMath::Square(AINavJoinDistance);
+
+    if (Points.Num() == 1)
+    {
+        return FVector::DistSquared(Points[0].Location, Location) <= JoinDistanceSquared;
+    }
+
+    for (int32 Index = 1; Index < Points.Num(); ++Index)
+    {
+        if (FMath::PointDistToSegmentSquared(Location, Points[Index - 1].Location, Points[Index].Location) <= JoinDistanceSquared)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void UNAINavigationSubsystem::UpdateCorridors(float Time)
+{
+    PathQueue.Reset();
+
+    for (TMap<int32, FNAINavCorridor>::TIterator It = Corridors.CreateIterator(); It; ++It)
+    {
+        FNAINavCorridor& Corridor = It.Value();
+        const AActor* Goal = Corridor.Goal.Get();
+        if (!Goal || !Corridor.NavData.IsValid() || Time - Corridor.LastRequestTime > AINavCorridorLifetime)
+        {
+            It.RemoveCurrent();
+            DEC_DWORD_STAT(STAT_NAINavigationCorridors);
+            continue;
+        }
+
+        // A failed search is retried after the repath interval like any other, wherever the goal is
+        const bool bWaited = Time - Corridor.PathTime >= AINavRepathInterval;
+        const bool bDue = Corridor.bPathFailed
+            ? bWaited
+            : !Corridor.Path.IsValid() || (bWaited && FVector::DistSquared(Goal->GetActorLocation(), Corridor.PathGoalLocation) > FMath::Square(AINavRepathDistance));
+
+        if (bDue && Corridor.NumRequests > 0)
+        {
+            PathQueue.Add(It.Key());
+        }
+    }
+
+    // Corridors never searched first, then the oldest searches
+    PathQueue.Sort([this](const int32 A, const int32 B)
+    {
+        const FNAINavCorridor& CorridorA = Corridors[A];
+        const FNAINavCorridor& CorridorB = Corridors[B];
+        const bool bNewA = !CorridorA.Path.IsValid() && !CorridorA.bPathFailed;
+        const bool bNewB = !CorridorB.Path.IsValid() && !CorridorB.bPathFailed;
+        if (bNewA != bNewB)
+        {
+            return bNewA;
+        }
+        return CorridorA.PathTime < CorridorB.PathTime;
+    });
+
+    const int32 PathsPerFrame = AINavPathsPerFrame > 0 ? FMath::Min(AINavPathsPerFrame, PathQueue.Num()) : PathQueue.Num();
+    for (int32 Index = 0; Index < PathsPerFrame; ++Index)
+    {
+        FindPath(Corridors[PathQueue[Index]], Time);
+    }
+
+    INC_DWORD_STAT_BY(STAT_NAINavigationPathsDeferred, PathQueue.Num() - PathsPerFrame);
+}
+
+
+bool UNAINavigationSubsystem::FindPath(FNAINavCorridor& Corridor, float Time)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NAINavigationFindPath);
+
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const AActor* Goal = Corridor.Goal.Get();
+    ANavigationData* NavData = Corridor.NavData.Get();
+    if (!NavSys || !Goal || !NavData)
+    {
+        return false;
+    }
+
+    const FVector End = Goal->GetActorLocation();
+
+    // The average of agents on both sides of a wall can be inside it, then start where one of them stands
+    FVector Start = Corridor.RequestLocationSum / Corridor.NumRequests;
+    FVector HitLocation;
+    if (NavData->Raycast(Corridor.FirstRequestLocation, Start, HitLocation, NavData->GetDefaultQueryFilter(), this))
+    {
+        Start = Corridor.FirstRequestLocation;
+    }
+
+    Corridor.RequestLocationSum = FVector::ZeroVector;
+    Corridor.NumRequests = 0;
+    Corridor.PathTime = Time;
+    Corridor.PathGoalLocation = End;
+
+    const FPathFindingQuery Query(this, *NavData, Start, End);
+    const FPathFindingResult Result = NavSys->FindPathSync(Query);
+    Corridor.bPathFailed = !Result.IsSuccessful() || !Result.Path.IsValid();
+    if (Corridor.bPathFailed)
+    {
+        return false;
+    }
+
+    // A new path object, agents following the old one switch over on their next decision
+    Corridor.Path = Result.Path;
+    INC_DWORD_STAT(STAT_NAINavigationPathsFound);
+
+    if (DebugAINavigation)
+    {
+        const TArray<FNavPathPoint>& Points = Corridor.Path->GetPathPoints();
+        for (int32 Index = 1; Index < Points.Num(); ++Index)
+        {
+            DrawDebugLine(GetWorld(), Points[Index - 1].Location, Points[Index].Location, FColor::Green, false, AINavRepathInterval);
+        }
+    }
+
+    return true;
+}
+
+
+FIntPoint UNAINavigationSubsystem::GetCell(const FVector& Location)
+{
+    const float CellSize = FMath::Max(AINavGroupCellSize, 1.f);
+    return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
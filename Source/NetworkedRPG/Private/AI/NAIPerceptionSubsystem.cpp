@@ -0,0 +1,406 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/NAIPerceptionSubsystem.h"
+#include "AI/NAIController.h"
+#include "Characters/NCharacterBase.h"
+#include "Components/PrimitiveComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Perception Update"), STAT_NAIPerceptionUpdate, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("AI Perception Index Update"), STAT_NAIPerceptionIndexUpdate, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Perception Listeners"), STAT_NAIPerceptionListeners, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Perceivable Characters"), STAT_NAIPerceivableCharacters, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Sight Pairs Cached"), STAT_NAISightPairsCached, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Sight Pairs Checked"), STAT_NAISightPairsChecked, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Sight Cache Hits"), STAT_NAISightCacheHits, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Sight Traces"), STAT_NAISightTraces, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Sight Traces Over Budget"), STAT_NAISightTracesOverBudget, STATGROUP_NRPG);
+
+static float AIPerceptionInterval = 0.2f;
+FAutoConsoleVariableRef CVarAIPerceptionInterval(
+    TEXT("NRPG.AI.PerceptionInterval"),
+    AIPerceptionInterval,
+    TEXT("Seconds between AI perception updates. 0 updates every frame."),
+    ECVF_Default
+    );
+
+static float AICellSize = 1000.f;
+FAutoConsoleVariableRef CVarAICellSize(
+    TEXT("NRPG.AI.CellSize"),
+    AICellSize,
+    TEXT("Size of the cells of the AI perception index."),
+    ECVF_Default
+    );
+
+static float AISightCacheLifetime = 0.5f;
+FAutoConsoleVariableRef CVarAISightCacheLifetime(
+    TEXT("NRPG.AI.SightCacheLifetime"),
+    AISightCacheLifetime,
+    TEXT("Seconds a line of sight result between an agent and a target is reused before it is traced again."),
+    ECVF_Default
+    );
+
+static int32 AISightTracesPerUpdate = 128;
+FAutoConsoleVariableRef CVarAISightTracesPerUpdate(
+    TEXT("NRPG.AI.SightTracesPerUpdate"),
+    AISightTracesPerUpdate,
+    TEXT("Max line of sight traces in a perception update. 0 for no limit."),
+    ECVF_Default
+    );
+
+static int32 AISightTracesPerAgent = 4;
+FAutoConsoleVariableRef CVarAISightTracesPerAgent(
+    TEXT("NRPG.AI.SightTracesPerAgent"),
+    AISightTracesPerAgent,
+    TEXT("Max line of sight traces for one agent in a perception update. 0 for no limit."),
+    ECVF_Default
+    );
+
+static int32 DebugAIPerception = 0;
+FAutoConsoleVariableRef CVarDebugAIPerception(
+    TEXT("NRPG.Debug.AIPerception"),
+    DebugAIPerception,
+    TEXT("Draw AI sight traces: 0 - Off, 1 - On"),
+    ECVF_Cheat
+    );
+
+
+void UNAIPerceptionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FirstListener = 0;
+    UpdateTime = -1.f;
+    TickSeconds = 0.0;
+    SightTraceDelegate.BindUObject(this, &UNAIPerceptionSubsystem::OnSightTraceDone);
+}
+
+
+void UNAIPerceptionSubsystem::Deinitialize()
+{
+    DEC_DWORD_STAT_BY(STAT_NAIPerceptionListeners, Listeners.Num());
+    DEC_DWORD_STAT_BY(STAT_NAIPerceivableCharacters, Characters.Num());
+    DEC_DWORD_STAT_BY(STAT_NAISightPairsCached, SightResults.Num());
+    Listeners.Empty();
+    Characters.Empty();
+    IndexedTargets.Empty();
+    Cells.Empty();
+    SightResults.Empty();
+    PendingTraces.Empty();
+    SightTraceDelegate.Unbind();
+
+    Super::Deinitialize();
+}
+
+
+void UNAIPerceptionSubsystem::Tick(float DeltaTime)
+{
+    const float Time = GetWorld()->GetTimeSeconds();
+    if (UpdateTime >= 0.f && Time - UpdateTime < AIPerceptionInterval)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_NAIPerceptionUpdate);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    UpdateTime = Time;
+    UpdateIndex();
+    PruneSightResults(Time);
+
+    // The last batch was delivered at the start of this frame, so its slots are free
+    PendingTraces.Reset();
+
+    int32 TracesLeft = AISightTracesPerUpdate > 0 ? AISightTracesPerUpdate : MAX_int32;
+
+    // Start from a different listener each update, so the same agents don't always get the budget first
+    const int32 Num = Listeners.Num();
+    FirstListener = Num > 0 ? (FirstListener + 1) % Num : 0;
+    for (int32 Offset = 0; Offset < Num; ++Offset)
+    {
+        if (ANAIController* Listener = Listeners[(FirstListener + Offset) % Num].Get())
+        {
+            UpdateListener(Listener, Time, TracesLeft);
+        }
+    }
+
+    // Removed after the loop so the indices above stay valid
+    for (int32 Index = Listeners.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Listeners[Index].IsValid())
+        {
+            Listeners.RemoveAtSwap(Index);
+            DEC_DWORD_STAT(STAT_NAIPerceptionListeners);
+        }
+    }
+
+    TickSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+
+bool UNAIPerceptionSubsystem::IsTickable() const
+{
+    const UWorld* World = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && World && World->IsGameWorld() && Listeners.Num() > 0;
+}
+
+
+TStatId UNAIPerceptionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNAIPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+
+UNAIPerceptionSubsystem* UNAIPerceptionSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UNAIPerceptionSubsystem>() : nullptr;
+}
+
+
+void UNAIPerceptionSubsystem::RegisterListener(ANAIController* Listener)
+{
+    if (!Listener || !Listener->HasAuthority() || Listeners.Contains(Listener))
+    {
+        return;
+    }
+
+    Listeners.Add(Listener);
+    INC_DWORD_STAT(STAT_NAIPerceptionListeners);
+}
+
+
+void UNAIPerceptionSubsystem::UnregisterListener(ANAIController* Listener)
+{
+    if (Listeners.RemoveSwap(Listener) > 0)
+    {
+        DEC_DWORD_STAT(STAT_NAIPerceptionListeners);
+    }
+}
+
+
+void UNAIPerceptionSubsystem::RegisterCharacter(ANCharacterBase* Character)
+{
+    if (!Character || !Character->HasAuthority() || Characters.Contains(Character))
+    {
+        return;
+    }
+
+    Characters.Add(Character);
+    INC_DWORD_STAT(STAT_NAIPerceivableCharacters);
+}
+
+
+void UNAIPerceptionSubsystem::UnregisterCharacter(ANCharacterBase* Character)
+{
+    if (Characters.RemoveSwap(Character) > 0)
+    {
+        DEC_DWORD_STAT(STAT_NAIPerceivableCharacters);
+    }
+}
+
+
+void UNAIPerceptionSubsystem::UpdateIndex()
+{
+    SCOPE_CYCLE_COUNTER(STAT_NAIPerceptionIndexUpdate);
+
+    IndexedTargets.Reset();
+
+    // Keep the cell arrays allocated, the same cells tend to stay occupied
+    for (TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+    {
+        Cell.Value.Reset();
+    }
+
+    for (int32 Index = Characters.Num() - 1; Index >= 0; --Index)
+    {
+        ANCharacterBase* Character = Characters[Index].Get();
+        if (!Character)
+        {
+            Characters.RemoveAtSwap(Index);
+            DEC_DWORD_STAT(STAT_NAIPerceivableCharacters);
+            continue;
+        }
+
+        FNAITarget Target;
+        Target.Character = Character;
+        Target.TargetComponent = FindTargetComponent(Character);
+        Target.Location = Character->GetActorLocation();
+        Target.Team = Character->GetTeam();
+        Target.bAlive = Character->IsAlive();
+
+        Cells.FindOrAdd(GetCell(Target.Location)).Add(IndexedTargets.Add(Target));
+    }
+}
+
+
+void UNAIPerceptionSubsystem::UpdateListener(ANAIController* Listener, float Time, int32& TracesLeft)
+{
+    const ANCharacterBase* Observer = Listener->GetPawn<ANCharacterBase>();
+    if (!Observer || !Observer->IsAlive())
+    {
+        return;
+    }
+
+    VisibleTargets.Reset();
+
+    const FVector Location = Observer->GetActorLocation();
+    const FVector EyesLocation = Observer->GetPawnViewLocation();
+    const ENTeam Team = Observer->GetTeam();
+    const float Radius = Listener->GetSightRadius();
+    const float RadiusSquared = FMath::Square(Radius);
+    int32 AgentTracesLeft = AISightTracesPerAgent > 0 ? AISightTracesPerAgent : MAX_int32;
+
+    const FIntPoint Min = GetCell(Location - FVector(Radius));
+    const FIntPoint Max = GetCell(Location + FVector(Radius));
+    for (int32 X = Min.X; X <= Max.X; ++X)
+    {
+        for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+        {
+            const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y));
+            if (!Cell)
+            {
+                continue;
+            }
+
+            for (const int32 TargetIndex : *Cell)
+            {
+                const FNAITarget& Target = IndexedTargets[TargetIndex];
+                const ANCharacterBase* TargetCharacter = Target.Character.Get();
+                if (!Target.bAlive || Target.Team == Team || !TargetCharacter || FVector::DistSquared(Location, Target.Location) > RadiusSquared)
+                {
+                    continue;
+                }
+
+                INC_DWORD_STAT(STAT_NAISightPairsChecked);
+
+                const uint64 PairKey = GetPairKey(Observer, TargetCharacter);
+                const FNAISightResult* Result = SightResults.Find(PairKey);
+
+                // Reuse a recent result, a trace in flight counts as recent from its request
+                if (Result && Time - Result->Time < AISightCacheLifetime)
+                {
+                    INC_DWORD_STAT(STAT_NAISightCacheHits);
+                }
+                else if (TracesLeft > 0 && AgentTracesLeft > 0)
+                {
+                    if (RequestSightTrace(PairKey, EyesLocation, Target.Location, Observer, TargetCharacter))
+                    {
+                        --TracesLeft;
+                        --AgentTracesLeft;
+                    }
+                    Result = SightResults.Find(PairKey);
+                }
+                else
+                {
+                    INC_DWORD_STAT(STAT_NAISightTracesOverBudget);
+                }
+
+                // Over budget or in flight, the last known result stands
+                if (Result && Result->bVisible)
+                {
+                    VisibleTargets.Add(&Target);
+                }
+            }
+        }
+    }
+
+    Listener->UpdatePerception(VisibleTargets, Time);
+}
+
+
+bool UNAIPerceptionSubsystem::RequestSightTrace(uint64 PairKey, const FVector& Start, const FVector& End, const AActor* Observer, const AActor* Target)
+{
+    FCollisionQueryParams Params(SCENE_QUERY_STAT(NAISight), false, Observer);
+    Params.AddIgnoredActor(Target);
+
+    const uint32 UserData = static_cast<uint32>(PendingTraces.Num());
+    const FTraceHandle Handle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Test, Start, End, ECC_Visibility, Params, FCollisionResponseParams::DefaultResponseParam, &SightTraceDelegate, UserData);
+    if (!Handle.IsValid())
+    {
+        return false;
+    }
+
+    PendingTraces.Add(PairKey);
+    INC_DWORD_STAT(STAT_NAISightTraces);
+
+    // Keeps the previous visibility until the trace is back
+    FNAISightResult* Result = SightResults.Find(PairKey);
+    if (!Result)
+    {
+        Result = &SightResults.Add(PairKey);
+        Result->bVisible = false;
+        INC_DWORD_STAT(STAT_NAISightPairsCached);
+    }
+    Result->Time = GetWorld()->GetTimeSeconds();
+
+    if (DebugAIPerception)
+    {
+        DrawDebugLine(GetWorld(), Start, End, FColor::Cyan, false, AIPerceptionInterval);
+    }
+
+    return true;
+}
+
+
+void UNAIPerceptionSubsystem::OnSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+    if (!PendingTraces.IsValidIndex(TraceDatum.UserData))
+    {
+        return;
+    }
+
+    if (FNAISightResult* Result = SightResults.Find(PendingTraces[TraceDatum.UserData]))
+    {
+        // A test trace only returns a hit when blocked
+        Result->bVisible = TraceDatum.OutHits.Num() == 0;
+        Result->Time = GetWorld()->GetTimeSeconds();
+    }
+}
+
+
+void UNAIPerceptionSubsystem::PruneSightResults(float Time)
+{
+    // Pairs still in range are traced again within the lifetime, give those some slack for the trace budget
+    const float MaxAge = FMath::Max(AISightCacheLifetime, AIPerceptionInterval) * 4.f;
+    for (TMap<uint64, FNAISightResult>::TIterator It = SightResults.CreateIterator(); It; ++It)
+    {
+        if (Time - It.Value().Time > MaxAge)
+        {
+            It.RemoveCurrent();
+            DEC_DWORD_STAT(STAT_NAISightPairsCached);
+        }
+    }
+}
+
+
+uint64 UNAIPerceptionSubsystem::GetPairKey(const AActor* Observer, const AActor* Target)
+{
+    return static_cast<uint64>(Observer->GetUniqueID()) << 32 | Target->GetUniqueID();
+}
+
+
+FIntPoint UNAIPerceptionSubsystem::GetCell(const FVector& Location)
+{
+    const float CellSize = FMath::Max(AICellSize, 1.f);
+    return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+
+UPrimitiveComponent* UNAIPerceptionSubsystem::FindTargetComponent(const ANCharacterBase* Character)
+{
+    // The component player targeting finds, falling back to the capsule
+    TInlineComponentArray<UPrimitiveComponent*> Primitives(Character);
+    for (UPrimitiveComponent* Primitive : Primitives)
+    {
+        if (Primitive->GetCollisionObjectType() == ECC_Target)
+        {
+            return Primitive;
+        }
+    }
+
+    return Cast<UPrimitiveComponent>(Character->GetRootComponent());
+}
@@ -17,6 +17,7 @@ UNGameplayAbility::UNGameplayAbility()
 {
     InstancingPolicy = EGameplayAbilityInstancingPolicy::InstancedPerActor;
     bActivateAbilityOnGranted = false;
+    bIsCombatAbility = true;
 }
 
 
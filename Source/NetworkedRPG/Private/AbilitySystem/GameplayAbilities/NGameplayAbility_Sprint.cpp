@@ -6,19 +6,25 @@
 #include "AbilitySystem/NAbilitySystemComponent.h"
 #include "Abilities/Tasks/AbilityTask_WaitInputRelease.h"
 #include "Abilities/Tasks/AbilityTask_WaitGameplayTag.h"
-#include "Abilities/Tasks/AbilityTask_WaitDelay.h"
-#include "Abilities/Tasks/AbilityTask_NetworkSyncPoint.h"
+
+UNGameplayAbility_Sprint::UNGameplayAbility_Sprint()
+{
+    // Sprinting alone keeps the owner at its idle net rate
+    bIsCombatAbility = false;
+}
 
 void UNGameplayAbility_Sprint::ActivateAbility(const FGameplayAbilitySpecHandle Handle,
     const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
     const FGameplayEventData* TriggerEventData)
 {
-    
+    bEndSprint = false;
     GESprintingHandle = ApplyGameplayEffectToOwner(Handle, ActorInfo, ActivationInfo, GESprint.GetDefaultObject(), 1.0, 1);
 
     if (UNCharacterMovementComponent* MC = Cast<UNCharacterMovementComponent>(ActorInfo->MovementComponent))
     {
+        // Stamina is drained per move by the movement component, which tells us when it runs out
         MC->StartSprinting();
+        MC->OnSprintStaminaDepleted.AddUniqueDynamic(this, &UNGameplayAbility_Sprint::OnSprintEnd);
 
         if (UNAbilitySystemComponent* ASC = Cast<UNAbilitySystemComponent>(ActorInfo->AbilitySystemComponent))
         {
@@ -30,44 +36,6 @@ void UNGameplayAbility_Sprint::ActivateAbility(const FGameplayAbilitySpecHandle
             WaitSprintEndTagAddedTask = UAbilityTask_WaitGameplayTagAdded::WaitGameplayTagAdd(this, TagSprintEnd);
             WaitSprintEndTagAddedTask->Added.AddDynamic(this, &UNGameplayAbility_Sprint::OnSprintEnd);
             WaitSprintEndTagAddedTask->Activate();
-            
-            ProcessCost();
-        }
-    }
-}
-
-void UNGameplayAbility_Sprint::ProcessCost()
-{
-    UE_LOG(LogTemp, Warning, TEXT("ProcessCost()"))
-    WaitDelayTask = UAbilityTask_WaitDelay::WaitDelay(this, 0.05);
-    WaitDelayTask->OnFinish.AddDynamic(this, &UNGameplayAbility_Sprint::OnWaitDelayFinish);
-    WaitDelayTask->Activate();
-}
-
-void UNGameplayAbility_Sprint::OnWaitDelayFinish()
-{
-    UE_LOG(LogTemp, Warning, TEXT("OnWaitDelayFinish()"))
-    SyncPoint = UAbilityTask_NetworkSyncPoint::WaitNetSync(this, EAbilityTaskNetSyncType::BothWait);
-    SyncPoint->OnSync.AddDynamic(this, &UNGameplayAbility_Sprint::OnSync);
-    SyncPoint->Activate();
-}
-
-void UNGameplayAbility_Sprint::OnSync()
-{
-    UE_LOG(LogTemp, Warning, TEXT("OnSync()"))
-    if (UNCharacterMovementComponent* MC = Cast<UNCharacterMovementComponent>(GetActorInfo().MovementComponent))
-    {
-        if (MC->GetCurrentAcceleration().Size() > 0 && !MC->IsFalling())
-        {
-            if (!CommitAbilityCost(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo(), GetCurrentActivationInfo()))
-            {
-                EndAbility();
-            }  
-        }
-
-        if (!bEndSprint)
-        {
-            ProcessCost();
         }
     }
 }
@@ -80,24 +48,24 @@ void UNGameplayAbility_Sprint::OnInputReleased(float TimeHeld)
 
 void UNGameplayAbility_Sprint::OnSprintEnd()
 {
-    SyncPoint = UAbilityTask_NetworkSyncPoint::WaitNetSync(this, EAbilityTaskNetSyncType::BothWait);
-    SyncPoint->OnSync.AddDynamic(this, &UNGameplayAbility_Sprint::EndAbility);
-    SyncPoint->Activate();
+    if (!bEndSprint)
+    {
+        EndAbility();
+    }
 }
 
 void UNGameplayAbility_Sprint::EndAbility()
 {
-    UE_LOG(LogTemp, Warning, TEXT("Sprint Ended!!"))
-    bEndSprint = true;
     bool bReplicateEndAbility = true;
     bool bWasCancelled = false;
-    Super::EndAbility(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo(), GetCurrentActivationInfo(), bReplicateEndAbility, bWasCancelled);
+    EndAbility(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo(), GetCurrentActivationInfo(), bReplicateEndAbility, bWasCancelled);
 }
 
 void UNGameplayAbility_Sprint::EndAbility(const FGameplayAbilitySpecHandle Handle,
     const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
     bool bReplicateEndAbility, bool bWasCancelled)
 {
+    bEndSprint = true;
     FActiveGameplayEffectHandle GESprintRemovalHandle = ApplyGameplayEffectToOwner(Handle, ActorInfo, ActivationInfo, GESprintRemoval.GetDefaultObject(), 1.0, 1);
 
     BP_RemoveGameplayEffectFromOwnerWithHandle(GESprintingHandle, -1);
@@ -106,6 +74,8 @@ void UNGameplayAbility_Sprint::EndAbility(const FGameplayAbilitySpecHandle Handl
     if (UNCharacterMovementComponent* MC = Cast<UNCharacterMovementComponent>(GetActorInfo().MovementComponent))
     {
         MC->StopSprinting();
+        MC->OnSprintStaminaDepleted.RemoveDynamic(this, &UNGameplayAbility_Sprint::OnSprintEnd);
+        
         if (IsValid(WaitSprintEndTagAddedTask))
         {
             WaitSprintEndTagAddedTask->EndTask();
@@ -116,6 +86,8 @@ void UNGameplayAbility_Sprint::EndAbility(const FGameplayAbilitySpecHandle Handl
             // ASC->RemoveGameplayCueLocal()
         }
     }
+
+    Super::EndAbility(Handle, ActorInfo, ActivationInfo, bReplicateEndAbility, bWasCancelled);
 }
 
 
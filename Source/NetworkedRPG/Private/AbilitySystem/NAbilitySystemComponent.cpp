@@ -5,13 +5,145 @@
 #include "AbilitySystem/GameplayAbilities/NGameplayAbility.h"
 #include "AbilitySystemGlobals.h"
 #include "GameplayCueManager.h"
+#include "NAssetManager.h"
+#include "NetTypes.h"
 #include "Net/UnrealNetwork.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Rep Items Dirtied"), STAT_NMontageRepItemsDirtied, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Rep Positions Sent"), STAT_NMontageRepPositionsSent, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Rep Items Serialized"), STAT_NMontageRepItemsSerialized, STATGROUP_NRPG);
 
 static TAutoConsoleVariable<float> CVarReplayMontageErrorThreshold(TEXT("replay.MontageErrorThreshold"), 0.5f, TEXT("Tolerance level for when montage playback position correction occurs in replays"));
 
+/** Replicated montage fields are sent as fixed point, see FGameplayAbilityRepAnimMontageForMesh::NetSerialize. */
+namespace NMontageRep
+{
+    // +-32.767 in steps of 0.001
+    using FPlayRate = NNetQuantize::TFixed<1000, 16>;
+
+    // Up to 655.35s in steps of 0.01s
+    using FPosition = NNetQuantize::TUnsignedFixed<100, 16>;
+
+    // Up to 65.535s in steps of 0.001s
+    using FBlendTime = NNetQuantize::TUnsignedFixed<1000, 16>;
+
+    // PositionRepId wraps at 16
+    static constexpr uint32 PositionRepIdBits = 4;
+    static constexpr uint8 PositionRepIdMask = (1 << PositionRepIdBits) - 1;
+
+    /** Position error beyond which clients are corrected, the server resends position past this as well. */
+    static float GetPositionErrorThreshold(const UWorld* World)
+    {
+        const bool bIsPlayingReplay = World && World->IsPlayingReplay();
+        return bIsPlayingReplay ? CVarReplayMontageErrorThreshold.GetValueOnGameThread() : 0.1f;
+    }
+}
+
+/** Returns true if any of the fields we replicate differ. */
+static bool HasRepMontageInfoChanged(const FGameplayAbilityRepAnimMontage& A, const FGameplayAbilityRepAnimMontage& B)
+{
+    return A.AnimMontage != B.AnimMontage
+        || A.PlayRate != B.PlayRate
+        || A.Position != B.Position
+        || A.BlendTime != B.BlendTime
+        || A.NextSectionID != B.NextSectionID
+        || A.IsStopped != B.IsStopped
+        || A.ForcePlayBit != B.ForcePlayBit;
+}
+
+
+bool FGameplayAbilityRepAnimMontageForMesh::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    bOutSuccess = true;
+
+    UObject* MeshObject = Mesh;
+    bOutSuccess &= Map->SerializeObject(Ar, USkeletalMeshComponent::StaticClass(), MeshObject);
+
+    // Montage as a registry id if it has one, otherwise as an object reference
+    const UNAssetManager& AssetManager = UNAssetManager::Get();
+    const int32 RegisteredRepId = Ar.IsSaving() ? AssetManager.GetMontageRepId(RepMontageInfo.AnimMontage) : INDEX_NONE;
+    uint8 bHasMontageRepId = RegisteredRepId != INDEX_NONE;
+    Ar.SerializeBits(&bHasMontageRepId, 1);
+
+    UObject* MontageObject = RepMontageInfo.AnimMontage;
+    if (bHasMontageRepId)
+    {
+        uint32 MontageRepId = uint32(RegisteredRepId);
+        Ar.SerializeIntPacked(MontageRepId);
+        MontageObject = Ar.IsLoading() ? AssetManager.GetMontageFromRepId(MontageRepId) : MontageObject;
+    }
+    else
+    {
+        bOutSuccess &= Map->SerializeObject(Ar, UAnimMontage::StaticClass(), MontageObject);
+    }
+
+    uint8 Flags = uint8(RepMontageInfo.ForcePlayBit | RepMontageInfo.IsStopped << 1 | RepMontageInfo.SkipPositionCorrection << 2 | RepMontageInfo.bSkipPlayRate << 3);
+    Ar.SerializeBits(&Flags, 4);
+
+    // Most montages play at the default rate, only send the rate when it is not 1
+    uint8 bDefaultPlayRate = RepMontageInfo.PlayRate == 1.f;
+    Ar.SerializeBits(&bDefaultPlayRate, 1);
+
+    float PlayRate = RepMontageInfo.PlayRate;
+    if (!bDefaultPlayRate)
+    {
+        NMontageRep::FPlayRate::Serialize(PlayRate, Ar);
+    }
+
+    // Position and NextSectionID only matter while playing, BlendTime only once stopped
+    const bool bIsStopped = Flags & (1 << 1);
+    if (!bIsStopped)
+    {
+        Ar.SerializeBits(&PositionRepId, NMontageRep::PositionRepIdBits);
+        NMontageRep::FPosition::Serialize(RepMontageInfo.Position, Ar);
+        Ar << RepMontageInfo.NextSectionID;
+    }
+    else
+    {
+        NMontageRep::FBlendTime::Serialize(RepMontageInfo.BlendTime, Ar);
+    }
+
+    if (Ar.IsLoading())
+    {
+        Mesh = Cast<USkeletalMeshComponent>(MeshObject);
+        RepMontageInfo.AnimMontage = Cast<UAnimMontage>(MontageObject);
+        RepMontageInfo.ForcePlayBit = Flags & 1;
+        RepMontageInfo.IsStopped = bIsStopped;
+        RepMontageInfo.SkipPositionCorrection = (Flags >> 2) & 1;
+        RepMontageInfo.bSkipPlayRate = (Flags >> 3) & 1;
+        RepMontageInfo.PlayRate = bDefaultPlayRate ? 1.f : PlayRate;
+    }
+    else
+    {
+        INC_DWORD_STAT(STAT_NMontageRepItemsSerialized);
+    }
+
+    return true;
+}
+
+
+void FGameplayAbilityRepAnimMontageForMesh::PostReplicatedAdd(const FNRepAnimMontageForMeshArray& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->OnRep_ReplicatedAnimMontageForMesh(*this);
+    }
+}
+
+
+void FGameplayAbilityRepAnimMontageForMesh::PostReplicatedChange(const FNRepAnimMontageForMeshArray& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->OnRep_ReplicatedAnimMontageForMesh(*this);
+    }
+}
+
 
 UNAbilitySystemComponent::UNAbilitySystemComponent()
 {
+    RepAnimMontageInfoForMeshes.Owner = this;
 }
 
 
@@ -25,14 +157,10 @@ void UNAbilitySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProper
 
 bool UNAbilitySystemComponent::GetShouldTick() const
 {
-    for (const FGameplayAbilityRepAnimMontageForMesh RepMontageInfo : RepAnimMontageInfoForMeshes)
+    const bool bHasReplicatedMontageInfoToUpdate = IsOwnerActorAuthoritative() && ActiveMontageMeshes.Num() > 0;
+    if (bHasReplicatedMontageInfoToUpdate)
     {
-        const bool bHasReplicatedMontageInfoToUpdate = (IsOwnerActorAuthoritative() && RepMontageInfo.RepMontageInfo.IsStopped == false);
-    
-        if (bHasReplicatedMontageInfoToUpdate)
-        {
-            return true;
-        }
+        return true;
     }
 
     return Super::GetShouldTick();
@@ -43,9 +171,18 @@ void UNAbilitySystemComponent::TickComponent(float DeltaTime, ELevelTick TickTyp
 {
     if (IsOwnerActorAuthoritative())
     {
-        for (FGameplayAbilityLocalAnimMontageForMesh& MontageInfo : LocalAnimMontageInfoForMeshes)
+        // Only meshes with a playing montage, copied since a stopped montage removes its mesh during the update
+        const TArray<TWeakObjectPtr<USkeletalMeshComponent>> MeshesToUpdate = ActiveMontageMeshes;
+        for (const TWeakObjectPtr<USkeletalMeshComponent>& Mesh : MeshesToUpdate)
         {
-            AnimMontage_UpdateReplicatedDataForMesh(MontageInfo.Mesh);
+            if (USkeletalMeshComponent* ValidMesh = Mesh.Get())
+            {
+                AnimMontage_UpdateReplicatedDataForMesh(ValidMesh);
+            }
+            else
+            {
+                ActiveMontageMeshes.Remove(Mesh);
+            }
         }
     }
 
@@ -57,9 +194,8 @@ void UNAbilitySystemComponent::InitAbilityActorInfo(AActor* InOwnerActor, AActor
 {
     Super::InitAbilityActorInfo(InOwnerActor, InAvatarActor);
 
-    // LocalAnimMontageInfoForMeshes = TArray<FGameplayAbilityLocalAnimMontageForMesh>();
-    // RepAnimMontageInfoForMeshes = TArray<FGameplayAbilityRepAnimMontageForMesh>();
-    
+    RemoveMontageInfoForOtherMeshes(InAvatarActor);
+
     if (bPendingMontageRep)
     {
         OnRep_ReplicatedAnimMontageForMesh();
@@ -89,20 +225,74 @@ int32 UNAbilitySystemComponent::K2_GetTagCount(FGameplayTag TagToCheck) const
 
 FGameplayAbilitySpecHandle UNAbilitySystemComponent::FindAbilitySpecHandleForClass(TSubclassOf<UGameplayAbility> AbilityClass, UObject* OptionalSourceObject)
 {
+    FGameplayAbilitySpecHandle Found;
+    bool bMultipleFound = false;
+    for (auto It = AbilitySpecHandlesByClass.CreateConstKeyIterator(AbilityClass); It; ++It)
+    {
+        if (!OptionalSourceObject || It.Value().Value == OptionalSourceObject)
+        {
+            bMultipleFound = Found.IsValid();
+            if (bMultipleFound)
+            {
+                break;
+            }
+            Found = It.Value().Key;
+        }
+    }
+
+    if (!bMultipleFound)
+    {
+        return Found;
+    }
+
+    // The multimap's order is arbitrary, with several matching specs return the first in ActivatableAbilities as before
     ABILITYLIST_SCOPE_LOCK();
-    for (FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+    for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+    {
+        if (Spec.Ability && Spec.Ability->GetClass() == AbilityClass && (!OptionalSourceObject || Spec.SourceObject == OptionalSourceObject))
+        {
+            return Spec.Handle;
+        }
+    }
+
+    return Found;
+}
+
+void UNAbilitySystemComponent::FindAbilitySpecHandlesForClasses(const TArray<TSubclassOf<UGameplayAbility>>& AbilityClasses, TArray<FGameplayAbilitySpecHandle>& OutHandles, UObject* OptionalSourceObject)
+{
+    OutHandles.Reset(AbilityClasses.Num());
+    for (const TSubclassOf<UGameplayAbility>& AbilityClass : AbilityClasses)
+    {
+        OutHandles.Add(FindAbilitySpecHandleForClass(AbilityClass, OptionalSourceObject));
+    }
+}
+
+void UNAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+    if (AbilitySpec.Ability)
+    {
+        AbilitySpecHandlesByClass.Add(AbilitySpec.Ability->GetClass(), TPair<FGameplayAbilitySpecHandle, const UObject*>(AbilitySpec.Handle, AbilitySpec.SourceObject));
+    }
+
+    Super::OnGiveAbility(AbilitySpec);
+}
+
+void UNAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+    if (AbilitySpec.Ability)
     {
-        TSubclassOf<UGameplayAbility> SpecAbilityClass = Spec.Ability->GetClass();
-        if (SpecAbilityClass == AbilityClass)
+        // Match by handle only, the source object may have changed since the ability was given
+        for (auto It = AbilitySpecHandlesByClass.CreateKeyIterator(AbilitySpec.Ability->GetClass()); It; ++It)
         {
-            if (!OptionalSourceObject || (OptionalSourceObject && Spec.SourceObject == OptionalSourceObject))
+            if (It.Value().Key == AbilitySpec.Handle)
             {
-                return Spec.Handle;
+                It.RemoveCurrent();
+                break;
             }
         }
     }
 
-    return FGameplayAbilitySpecHandle();
+    Super::OnRemoveAbility(AbilitySpec);
 }
 
 void UNAbilitySystemComponent::K2_AddLooseGameplayTag(const FGameplayTag& GameplayTag, int32 Count)
@@ -216,8 +406,12 @@ float UNAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* InAnimating
                     AbilityRepMontageInfo.RepMontageInfo.AnimMontage = NewAnimMontage;
                     AbilityRepMontageInfo.RepMontageInfo.ForcePlayBit = !bool(AbilityRepMontageInfo.RepMontageInfo.ForcePlayBit);
 
+                    // New montage, always send the start position
+                    AbilityRepMontageInfo.PositionRepTime = -1.f;
+
                     // Update parameters that change during montage life time.
-                    AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+                    AnimMontage_UpdateReplicatedDataForMesh(AbilityRepMontageInfo);
+                    RepAnimMontageInfoForMeshes.MarkItemDirty(AbilityRepMontageInfo);
 
                     // Force net update on out avatar actor
                     if (AbilityActorInfo->AvatarActor != nullptr)
@@ -282,9 +476,9 @@ void UNAbilitySystemComponent::CurrentMontageStopForMesh(USkeletalMeshComponent*
 
 void UNAbilitySystemComponent::StopAllCurrentMontages(float OverrideBlendOutTime)
 {
-    for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+    for (TPair<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>& MontageInfoForMesh : LocalAnimMontageInfoForMeshes)
     {
-        CurrentMontageStopForMesh(GameplayAbilityLocalAnimMontageForMesh.Mesh, OverrideBlendOutTime);
+        CurrentMontageStopForMesh(MontageInfoForMesh.Key, OverrideBlendOutTime);
     }
 }
 
@@ -301,12 +495,12 @@ void UNAbilitySystemComponent::StopMontageIfCurrentForMesh(USkeletalMeshComponen
 void UNAbilitySystemComponent::ClearAnimatingAbilityForAllMeshes(UGameplayAbility* Ability)
 {
     UNGameplayAbility* NAbility = Cast<UNGameplayAbility>(Ability);
-    for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+    for (TPair<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>& MontageInfoForMesh : LocalAnimMontageInfoForMeshes)
     {
-        if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility == Ability)
+        if (MontageInfoForMesh.Value.LocalMontageInfo.AnimatingAbility == Ability)
         {
-            NAbility->SetCurrentMontageForMesh(GameplayAbilityLocalAnimMontageForMesh.Mesh, nullptr);
-            GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility = nullptr;
+            NAbility->SetCurrentMontageForMesh(MontageInfoForMesh.Key, nullptr);
+            MontageInfoForMesh.Value.LocalMontageInfo.AnimatingAbility = nullptr;
         }
     }
 }
@@ -375,9 +569,9 @@ void UNAbilitySystemComponent::CurrentMontageSetPlayRateForMesh(USkeletalMeshCom
 
 bool UNAbilitySystemComponent::IsAnimatingAbilityForAnyMesh(UGameplayAbility* InAbility) const
 {
-    for (const FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+    for (const TPair<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>& MontageInfoForMesh : LocalAnimMontageInfoForMeshes)
     {
-        if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility == InAbility)
+        if (MontageInfoForMesh.Value.LocalMontageInfo.AnimatingAbility == InAbility)
         {
             return true;
         }
@@ -388,11 +582,11 @@ bool UNAbilitySystemComponent::IsAnimatingAbilityForAnyMesh(UGameplayAbility* In
 UGameplayAbility* UNAbilitySystemComponent::GetAnimatingAbilityFromAnyMesh()
 {
     // Only one ability can be animating for all meshes
-    for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+    for (TPair<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>& MontageInfoForMesh : LocalAnimMontageInfoForMeshes)
     {
-        if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility)
+        if (MontageInfoForMesh.Value.LocalMontageInfo.AnimatingAbility)
         {
-            return GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility;
+            return MontageInfoForMesh.Value.LocalMontageInfo.AnimatingAbility;
         }
     }
 
@@ -403,14 +597,14 @@ TArray<UAnimMontage*> UNAbilitySystemComponent::GetCurrentMontages() const
 {
     TArray<UAnimMontage*> Montages;
 
-    for (FGameplayAbilityLocalAnimMontageForMesh GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+    for (const TPair<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>& MontageInfoForMesh : LocalAnimMontageInfoForMeshes)
     {
-        UAnimInstance* AnimInstance = GetMeshAnimInstance(GameplayAbilityLocalAnimMontageForMesh.Mesh);
+        UAnimInstance* AnimInstance = GetMeshAnimInstance(MontageInfoForMesh.Key);
+        UAnimMontage* AnimMontage = MontageInfoForMesh.Value.LocalMontageInfo.AnimMontage;
 
-        if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage && AnimInstance
-            && AnimInstance->Montage_IsActive(GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage))
+        if (AnimMontage && AnimInstance && AnimInstance->Montage_IsActive(AnimMontage))
         {
-            Montages.Add(GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage);
+            Montages.Add(AnimMontage);
         }
     }
 
@@ -509,32 +703,74 @@ float UNAbilitySystemComponent::GetCurrentMontageSectionTimeLeftForMesh(USkeleta
 FGameplayAbilityLocalAnimMontageForMesh& UNAbilitySystemComponent::GetLocalAnimMontageInfoForMesh(
     USkeletalMeshComponent* InMesh)
 {
-    for (FGameplayAbilityLocalAnimMontageForMesh& MontageInfo : LocalAnimMontageInfoForMeshes)
+    if (FGameplayAbilityLocalAnimMontageForMesh* MontageInfo = LocalAnimMontageInfoForMeshes.Find(InMesh))
     {
-        if (MontageInfo.Mesh == InMesh)
-        {
-            return MontageInfo;
-        }
+        return *MontageInfo;
     }
 
-    FGameplayAbilityLocalAnimMontageForMesh MontageInfo = FGameplayAbilityLocalAnimMontageForMesh(InMesh);
-    LocalAnimMontageInfoForMeshes.Add(MontageInfo);
-    return LocalAnimMontageInfoForMeshes.Last();
+    return LocalAnimMontageInfoForMeshes.Add(InMesh, FGameplayAbilityLocalAnimMontageForMesh(InMesh));
 }
 
 FGameplayAbilityRepAnimMontageForMesh& UNAbilitySystemComponent::GetGameplayAbilityRepAnimMontageInfoForMesh(USkeletalMeshComponent* InMesh)
 {
-    for (FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes)
+    if (const int32* Index = RepAnimMontageIndexForMeshes.Find(InMesh))
     {
-        if (RepMontageInfo.Mesh == InMesh)
+        return RepAnimMontageInfoForMeshes.Items[*Index];
+    }
+
+    const int32 NewIndex = RepAnimMontageInfoForMeshes.Items.Add(FGameplayAbilityRepAnimMontageForMesh(InMesh));
+    RepAnimMontageIndexForMeshes.Add(InMesh, NewIndex);
+    
+    FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo = RepAnimMontageInfoForMeshes.Items[NewIndex];
+    RepAnimMontageInfoForMeshes.MarkItemDirty(RepMontageInfo);
+    return RepMontageInfo;
+}
+
+void UNAbilitySystemComponent::RemoveMontageInfoForOtherMeshes(const AActor* InAvatarActor)
+{
+    // Weapons are separate actors attached to the avatar, so compare the attachment root rather than the owner
+    const auto IsOtherMesh = [InAvatarActor](const USkeletalMeshComponent* Mesh)
+    {
+        return !IsValid(Mesh) || Mesh->GetAttachmentRootActor() != InAvatarActor;
+    };
+
+    for (TMap<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh>::TIterator It = LocalAnimMontageInfoForMeshes.CreateIterator(); It; ++It)
+    {
+        if (IsOtherMesh(It.Key()))
         {
-            return RepMontageInfo;
+            It.RemoveCurrent();
         }
     }
 
-    FGameplayAbilityRepAnimMontageForMesh RepMontageInfo = FGameplayAbilityRepAnimMontageForMesh(InMesh);
-    RepAnimMontageInfoForMeshes.Add(RepMontageInfo);
-    return RepAnimMontageInfoForMeshes.Last();
+    // Clients get the removal through the fast array
+    if (!IsOwnerActorAuthoritative())
+    {
+        return;
+    }
+
+    ActiveMontageMeshes.RemoveAll([&IsOtherMesh](const TWeakObjectPtr<USkeletalMeshComponent>& Mesh)
+    {
+        return IsOtherMesh(Mesh.Get());
+    });
+
+    TArray<FGameplayAbilityRepAnimMontageForMesh>& Items = RepAnimMontageInfoForMeshes.Items;
+    const int32 NumRemoved = Items.RemoveAll([&IsOtherMesh](const FGameplayAbilityRepAnimMontageForMesh& Item)
+    {
+        return IsOtherMesh(Item.Mesh);
+    });
+
+    if (NumRemoved > 0)
+    {
+        RepAnimMontageInfoForMeshes.MarkArrayDirty();
+
+        RepAnimMontageIndexForMeshes.Reset();
+        for (int32 Index = 0; Index < Items.Num(); ++Index)
+        {
+            RepAnimMontageIndexForMeshes.Add(Items[Index].Mesh, Index);
+        }
+
+        UpdateShouldTick();
+    }
 }
 
 void UNAbilitySystemComponent::OnPredictiveMontageRejectedForMesh(USkeletalMeshComponent* InMesh,
@@ -566,18 +802,27 @@ void UNAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
     UAnimInstance* AnimInstance = GetMeshAnimInstance(OutRepAnimMontageInfo.Mesh);
     FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(OutRepAnimMontageInfo.Mesh);
 
+    // Mesh has gone away, stop updating it
+    if (!AnimInstance)
+    {
+        ActiveMontageMeshes.Remove(OutRepAnimMontageInfo.Mesh);
+    }
+
     if (AnimInstance && AnimMontageInfo.LocalMontageInfo.AnimMontage)
     {
+        const FGameplayAbilityRepAnimMontage PreviousRepMontageInfo = OutRepAnimMontageInfo.RepMontageInfo;
+        
         OutRepAnimMontageInfo.RepMontageInfo.AnimMontage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
 
         // Compress Flags
         const bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+        const float ServerPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
 
         if (!bIsStopped)
         {
-            OutRepAnimMontageInfo.RepMontageInfo.PlayRate = AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-            OutRepAnimMontageInfo.RepMontageInfo.Position = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-            OutRepAnimMontageInfo.RepMontageInfo.BlendTime = AnimInstance->Montage_GetBlendTime(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+            // Quantized so only changes clients would receive mark the item dirty
+            OutRepAnimMontageInfo.RepMontageInfo.PlayRate = NMontageRep::FPlayRate::Quantize(AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+            OutRepAnimMontageInfo.RepMontageInfo.BlendTime = NMontageRep::FBlendTime::Quantize(AnimInstance->Montage_GetBlendTime(AnimMontageInfo.LocalMontageInfo.AnimMontage));
         }
 
         if (OutRepAnimMontageInfo.RepMontageInfo.IsStopped != bIsStopped)
@@ -585,6 +830,15 @@ void UNAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
             // Set this prior to calling UpdateShouldTick, so we start ticking if we are playing a Montage
             OutRepAnimMontageInfo.RepMontageInfo.IsStopped = bIsStopped;
 
+            if (bIsStopped)
+            {
+                ActiveMontageMeshes.Remove(OutRepAnimMontageInfo.Mesh);
+            }
+            else
+            {
+                ActiveMontageMeshes.AddUnique(OutRepAnimMontageInfo.Mesh);
+            }
+
             // When we start or stop an animation, update the clients right away for the Avatar Actor
             if (AbilityActorInfo->AvatarActor != nullptr)
             {
@@ -597,14 +851,14 @@ void UNAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
 
         // Replicate NextSectionID to keep it in sync.
         // We actually replicate NextSectionID+1 on a BYTE to put INDEX_NONE in there.
-        const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(OutRepAnimMontageInfo.RepMontageInfo.Position);
+        const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(ServerPosition);
         if (CurrentSectionID != INDEX_NONE)
         {
             const int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, CurrentSectionID);
             if (NextSectionID >= (256 - 1))
             {
                 ABILITY_LOG(Error, TEXT("AnimMontage_UpdateReplicatedData. NextSectionID = %d. RepAnimMontageInfo.Position: %.2f, CurrentSectionID: %d. LocalAnimMontageInfo.AnimMontage %s"),
-                    NextSectionID, OutRepAnimMontageInfo.RepMontageInfo.Position, CurrentSectionID, *GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+                    NextSectionID, ServerPosition, CurrentSectionID, *GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage));
                 ensure(NextSectionID < (256 - 1));
             }
 
@@ -614,6 +868,43 @@ void UNAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
         {
             OutRepAnimMontageInfo.RepMontageInfo.NextSectionID = 0;
         }
+
+        // Clients advance the montage themselves, so position is only sent when the section changes or a client
+        // playing on from the last sent position would have drifted past the correction threshold
+        bool bSendPosition = false;
+        if (!bIsStopped)
+        {
+            const FGameplayAbilityRepAnimMontage& RepMontageInfo = OutRepAnimMontageInfo.RepMontageInfo;
+            const UAnimMontage* AnimMontage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
+
+            bSendPosition = OutRepAnimMontageInfo.PositionRepTime < 0.f
+                || RepMontageInfo.IsStopped != PreviousRepMontageInfo.IsStopped
+                || RepMontageInfo.PlayRate != PreviousRepMontageInfo.PlayRate
+                || RepMontageInfo.NextSectionID != PreviousRepMontageInfo.NextSectionID
+                || AnimMontage->GetSectionIndexFromPosition(RepMontageInfo.Position) != CurrentSectionID;
+
+            if (!bSendPosition)
+            {
+                const float ElapsedTime = GetWorld()->GetTimeSeconds() - OutRepAnimMontageInfo.PositionRepTime;
+                const float ExpectedPosition = RepMontageInfo.Position + ElapsedTime * RepMontageInfo.PlayRate * AnimMontage->RateScale;
+                bSendPosition = FMath::Abs(ServerPosition - ExpectedPosition) > NMontageRep::GetPositionErrorThreshold(GetWorld());
+            }
+        }
+
+        if (bSendPosition)
+        {
+            OutRepAnimMontageInfo.RepMontageInfo.Position = NMontageRep::FPosition::Quantize(ServerPosition);
+            OutRepAnimMontageInfo.PositionRepId = (OutRepAnimMontageInfo.PositionRepId + 1) & NMontageRep::PositionRepIdMask;
+            OutRepAnimMontageInfo.PositionRepTime = GetWorld()->GetTimeSeconds();
+            INC_DWORD_STAT(STAT_NMontageRepPositionsSent);
+        }
+
+        // Only this mesh's item is re-serialized, and only if something changed
+        if (bSendPosition || HasRepMontageInfoChanged(PreviousRepMontageInfo, OutRepAnimMontageInfo.RepMontageInfo))
+        {
+            RepAnimMontageInfoForMeshes.MarkItemDirty(OutRepAnimMontageInfo);
+            INC_DWORD_STAT(STAT_NMontageRepItemsDirtied);
+        }
     }
 }
 
@@ -626,130 +917,143 @@ void UNAbilitySystemComponent::AnimMontage_UpdateForcedPlayFlagsForMesh(FGamepla
 
 void UNAbilitySystemComponent::OnRep_ReplicatedAnimMontageForMesh()
 {
-    for (FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh : RepAnimMontageInfoForMeshes)
+    for (FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh : RepAnimMontageInfoForMeshes.Items)
     {
-        FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(NewRepMontageInfoForMesh.Mesh);
+        OnRep_ReplicatedAnimMontageForMesh(NewRepMontageInfoForMesh);
+    }
+}
 
-        UWorld* World = GetWorld();
+void UNAbilitySystemComponent::OnRep_ReplicatedAnimMontageForMesh(FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh)
+{
+    // The mesh isn't resolved yet, or belongs to an avatar destroyed on this client
+    if (!NewRepMontageInfoForMesh.Mesh)
+    {
+        return;
+    }
 
-        if (NewRepMontageInfoForMesh.RepMontageInfo.bSkipPlayRate)
-        {
-            NewRepMontageInfoForMesh.RepMontageInfo.PlayRate = 1.f;
-        }
+    FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(NewRepMontageInfoForMesh.Mesh);
 
-        const bool bIsPlayingReplay = World && World->IsPlayingReplay();
+    UWorld* World = GetWorld();
 
-        const float MONTAGE_REP_POS_ERR_THRESH = bIsPlayingReplay ? CVarReplayMontageErrorThreshold.GetValueOnGameThread() : 0.1f;
+    if (NewRepMontageInfoForMesh.RepMontageInfo.bSkipPlayRate)
+    {
+        NewRepMontageInfoForMesh.RepMontageInfo.PlayRate = 1.f;
+    }
 
-        UAnimInstance* AnimInstance = GetMeshAnimInstance(NewRepMontageInfoForMesh.Mesh);
-        if (!AnimInstance || !IsReadyForReplicatedMontageForMesh())
+    const float MONTAGE_REP_POS_ERR_THRESH = NMontageRep::GetPositionErrorThreshold(World);
+
+    UAnimInstance* AnimInstance = GetMeshAnimInstance(NewRepMontageInfoForMesh.Mesh);
+    if (!AnimInstance || !IsReadyForReplicatedMontageForMesh())
+    {
+        bPendingMontageRep = true;
+        return;
+    }
+    bPendingMontageRep = false;
+
+    if (!AbilityActorInfo->IsLocallyControlled())
+    {
+        static const auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("net.Montage.Debug"));
+        bool DebugMontage = (CVar && CVar->GetValueOnGameThread() == 1);
+        if (DebugMontage)
         {
-            bPendingMontageRep = true;
-            return;
+            ABILITY_LOG(Warning, TEXT("\n\nOnRep_ReplicatedAnimMontage, %s"), *GetNameSafe(this));
+            ABILITY_LOG(Warning, TEXT("\tAnimMontage: %s\n\tPlayRate: %f\n\tPosition: %f\n\tBlendTime: %f\n\tNextSectionID: %d\n\tIsStopped: %d\n\tForcePlayBit: %d"),
+                *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage),
+                NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
+                NewRepMontageInfoForMesh.RepMontageInfo.Position,
+                NewRepMontageInfoForMesh.RepMontageInfo.BlendTime,
+                NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID,
+                NewRepMontageInfoForMesh.RepMontageInfo.IsStopped,
+                NewRepMontageInfoForMesh.RepMontageInfo.ForcePlayBit);
+            ABILITY_LOG(Warning, TEXT("\tLocalAnimMontageInfo.AnimMontage: %s\n\tPosition: %f"),
+                *GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage), AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
         }
-        bPendingMontageRep = false;
 
-        if (!AbilityActorInfo->IsLocallyControlled())
+        if (NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage)
         {
-            static const auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("net.Montage.Debug"));
-            bool DebugMontage = (CVar && CVar->GetValueOnGameThread() == 1);
-            if (DebugMontage)
+            // New Montage to play
+            const bool ReplicatedPlayBit = bool(NewRepMontageInfoForMesh.RepMontageInfo.ForcePlayBit);
+            if ((AnimMontageInfo.LocalMontageInfo.AnimMontage != NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage) || (AnimMontageInfo.LocalMontageInfo.PlayBit != ReplicatedPlayBit))
             {
-                ABILITY_LOG(Warning, TEXT("\n\nOnRep_ReplicatedAnimMontage, %s"), *GetNameSafe(this));
-                ABILITY_LOG(Warning, TEXT("\tAnimMontage: %s\n\tPlayRate: %f\n\tPosition: %f\n\tBlendTime: %f\n\tNextSectionID: %d\n\tIsStopped: %d\n\tForcePlayBit: %d"),
-                    *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage),
-                    NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
-                    NewRepMontageInfoForMesh.RepMontageInfo.Position,
-                    NewRepMontageInfoForMesh.RepMontageInfo.BlendTime,
-                    NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID,
-                    NewRepMontageInfoForMesh.RepMontageInfo.IsStopped,
-                    NewRepMontageInfoForMesh.RepMontageInfo.ForcePlayBit);
-                ABILITY_LOG(Warning, TEXT("\tLocalAnimMontageInfo.AnimMontage: %s\n\tPosition: %f"),
-                    *GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage), AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+                AnimMontageInfo.LocalMontageInfo.PlayBit = ReplicatedPlayBit;
+                PlayMontageSimulatedForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
             }
 
-            if (NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage)
+            if (AnimMontageInfo.LocalMontageInfo.AnimMontage == nullptr)
             {
-                // New Montage to play
-                const bool ReplicatedPlayBit = bool(NewRepMontageInfoForMesh.RepMontageInfo.ForcePlayBit);
-                if ((AnimMontageInfo.LocalMontageInfo.AnimMontage != NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage) || (AnimMontageInfo.LocalMontageInfo.PlayBit != ReplicatedPlayBit))
-                {
-                    AnimMontageInfo.LocalMontageInfo.PlayBit = ReplicatedPlayBit;
-                    PlayMontageSimulatedForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
-                }
+                ABILITY_LOG(Warning, TEXT("OnRep_ReplicatedAnimMontage: PlayMontageSimulated failed. Name: %s, AnimMontage: %s"), *GetNameSafe(this), *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage));
+                return;
+            }
 
-                if (AnimMontageInfo.LocalMontageInfo.AnimMontage == nullptr)
-                {
-                    ABILITY_LOG(Warning, TEXT("OnRep_ReplicatedAnimMontage: PlayMontageSimulated failed. Name: %s, AnimMontage: %s"), *GetNameSafe(this), *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage));
-                    return;
-                }
+            // Play rate has changed
+            if (AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage) != NewRepMontageInfoForMesh.RepMontageInfo.PlayRate)
+            {
+                AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
+            }
+
+            // Compressed flags
+            const bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+            const bool bReplicatedIsStopped = bool(NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
 
-                // Play rate has changed
-                if (AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage) != NewRepMontageInfoForMesh.RepMontageInfo.PlayRate)
+            // Process stopping first, so we don't change sections and cause blending to pop
+            if (bReplicatedIsStopped)
+            {
+                if (!bIsStopped)
                 {
-                    AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
+                    CurrentMontageStopForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.BlendTime);
                 }
+            }
+            // Position is only resent on section change or drift, only correct against a position we haven't applied yet
+            else if (!NewRepMontageInfoForMesh.RepMontageInfo.SkipPositionCorrection && AnimMontageInfo.PositionRepId != NewRepMontageInfoForMesh.PositionRepId)
+            {
+                AnimMontageInfo.PositionRepId = NewRepMontageInfoForMesh.PositionRepId;
 
-                // Compressed flags
-                const bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-                const bool bReplicatedIsStopped = bool(NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
+                const int32 RepSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(NewRepMontageInfoForMesh.RepMontageInfo.Position);
+                const int32 RepNextSectionID = int32(NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID) - 1;
 
-                // Process stopping first, so we don't change sections and cause blending to pop
-                if (bReplicatedIsStopped)
+                // And NextSectionID for the replicated SectionID
+                if (RepSectionID != INDEX_NONE)
                 {
-                    if (!bIsStopped)
+                    const int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, RepSectionID);
+
+                    // If NextSectionID is different than replicated one, then set it.
+                    if (NextSectionID != RepNextSectionID)
                     {
-                        CurrentMontageStopForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.BlendTime);
+                        AnimInstance->Montage_SetNextSection(AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepNextSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage); 
                     }
-                }
-                else if (!NewRepMontageInfoForMesh.RepMontageInfo.SkipPositionCorrection)
-                {
-                    const int32 RepSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(NewRepMontageInfoForMesh.RepMontageInfo.Position);
-                    const int32 RepNextSectionID = int32(NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID) - 1;
 
-                    // And NextSectionID for the replicated SectionID
-                    if (RepSectionID != INDEX_NONE)
+                    // Make sure we haven't received that update too late and the client hasn't already jumped to another section.
+                    const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+                    if ((CurrentSectionID != RepSectionID) && (CurrentSectionID != RepNextSectionID))
                     {
-                        const int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, RepSectionID);
-
-                        // If NextSectionID is different than replicated one, then set it.
-                        if (NextSectionID != RepNextSectionID)
-                        {
-                            AnimInstance->Montage_SetNextSection(AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepNextSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage); 
-                        }
-
-                        // Make sure we haven't received that update too late and the client hasn't already jumped to another section.
-                        const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
-                        if ((CurrentSectionID != RepSectionID) && (CurrentSectionID != RepNextSectionID))
-                        {
-                            // Client is in a wrong section, telaport him into the beginning of the right section
-                            const float SectionStartTime = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetAnimCompositeSection(RepSectionID).GetTime();
-                            AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, SectionStartTime);
-                        }
+                        // Client is in a wrong section, telaport him into the beginning of the right section
+                        const float SectionStartTime = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetAnimCompositeSection(RepSectionID).GetTime();
+                        AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, SectionStartTime);
                     }
+                }
 
-                    // Update Position. If error is too great, jump to replicated position.
-                    const float CurrentPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-                    const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(CurrentPosition);
-                    const float DeltaPosition = NewRepMontageInfoForMesh.RepMontageInfo.Position - CurrentPosition;
+                // Update Position. If error is too great, jump to replicated position.
+                const float CurrentPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+                const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(CurrentPosition);
+                const float DeltaPosition = NewRepMontageInfoForMesh.RepMontageInfo.Position - CurrentPosition;
 
-                    // Only check threshold if we are located in the same section. Different sections require a bit more work as we could be jumping around the timeline.
-                    // And therefor DeltaPosition is not as trivial to determine.
-                    if ((CurrentSectionID == RepSectionID) && (FMath::Abs(DeltaPosition) > MONTAGE_REP_POS_ERR_THRESH) && (NewRepMontageInfoForMesh.RepMontageInfo.PlayRate == 0))
+                // Only check threshold if we are located in the same section. Different sections require a bit more work as we could be jumping around the timeline.
+                // And therefor DeltaPosition is not as trivial to determine.
+                // Applied while playing too, the server only resends position on a playing montage when the client drifted.
+                if ((CurrentSectionID == RepSectionID) && (FMath::Abs(DeltaPosition) > MONTAGE_REP_POS_ERR_THRESH))
+                {
+                    // fast forward to server position and trigger notifies
+                    if (FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage))
                     {
-                        // fast forward to server position and trigger notifies
-                        if (FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(NewRepMontageInfoForMesh.RepMontageInfo.AnimMontage))
+                        const float DeltaTime = !FMath::IsNearlyZero(NewRepMontageInfoForMesh.RepMontageInfo.PlayRate) ? (DeltaPosition / NewRepMontageInfoForMesh.RepMontageInfo.PlayRate) : 0.f;
+                        if (DeltaTime >= 0.f)
                         {
-                            const float DeltaTime = !FMath::IsNearlyZero(NewRepMontageInfoForMesh.RepMontageInfo.PlayRate) ? (DeltaPosition / NewRepMontageInfoForMesh.RepMontageInfo.PlayRate) : 0.f;
-                            if (DeltaTime >= 0.f)
-                            {
-                                MontageInstance->UpdateWeight(DeltaTime);
-                                MontageInstance->HandleEvents(CurrentPosition, NewRepMontageInfoForMesh.RepMontageInfo.Position, nullptr);
-                                AnimInstance->TriggerAnimNotifies(DeltaTime);
-                            }
+                            MontageInstance->UpdateWeight(DeltaTime);
+                            MontageInstance->HandleEvents(CurrentPosition, NewRepMontageInfoForMesh.RepMontageInfo.Position, nullptr);
+                            AnimInstance->TriggerAnimNotifies(DeltaTime);
                         }
-                        AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.Position);
                     }
+                    AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.Position);
                 }
             }
         }
@@ -5,6 +5,7 @@
 #include "GameplayEffect.h"
 #include "GameplayEffectExtension.h"
 #include "Characters/NCharacter.h"
+#include "Components/NNetFrequencyComponent.h"
 #include "Player/NPlayerController.h"
 #include "Net/UnrealNetwork.h"
 
@@ -124,6 +125,10 @@ void UNAttributeSetBase::PostGameplayEffectExecute(const FGameplayEffectModCallb
         
         if (LocalDamageDone > 0.0f)
         {
+            // Both sides replicate at their combat rate for a while
+            UNNetFrequencyComponent::NotifyActorCombat(TargetActor);
+            UNNetFrequencyComponent::NotifyActorCombat(SourceCharacter);
+
             bool bWasAlive = true;
 
             if (TargetCharacter)
@@ -197,14 +202,8 @@ void UNAttributeSetBase::PostGameplayEffectExecute(const FGameplayEffectModCallb
     {
    
         SetStamina(FMath::Clamp(GetStamina(), 0.0f, GetMaxStamina()));
-        if (GetStamina() == GetMaxStamina())
-        {
-            GetOwningAbilitySystemComponent()->AddLooseGameplayTag(MaxStaminaTag);
-        }
-        else
-        {
-            GetOwningAbilitySystemComponent()->RemoveLooseGameplayTag(MaxStaminaTag);
-        }
+        // Set the count rather than add / remove, regen from UNRegenSubsystem sets this tag as well
+        GetOwningAbilitySystemComponent()->SetLooseGameplayTagCount(MaxStaminaTag, GetStamina() == GetMaxStamina() ? 1 : 0);
     }
     else if (Data.EvaluatedData.Attribute == GetShieldAttribute())
     {
@@ -0,0 +1,287 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AbilitySystem/NRegenSubsystem.h"
+#include "AbilitySystem/NAttributeSetBase.h"
+#include "AbilitySystemComponent.h"
+#include "GameplayEffect.h"
+#include "TimerManager.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("Regen Tick"), STAT_NRegenTick, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("Regen Gather"), STAT_NRegenGather, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("Regen Integrate"), STAT_NRegenIntegrate, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("Regen Apply"), STAT_NRegenApply, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regen Attribute Sets"), STAT_NRegenAttributeSets, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regen Attributes Changed"), STAT_NRegenAttributesChanged, STATGROUP_NRPG);
+
+static float RegenUpdatesPerSecond = 5.f;
+FAutoConsoleVariableRef CVarRegenUpdatesPerSecond(
+    TEXT("NRPG.Regen.UpdatesPerSecond"),
+    RegenUpdatesPerSecond,
+    TEXT("Rate of the server regen update. Takes effect the next time the regen timer is started."),
+    ECVF_Default
+    );
+
+static int32 DebugRegenSubsystem = 0;
+FAutoConsoleVariableRef CVarDebugRegenSubsystem(
+    TEXT("NRPG.Debug.RegenSubsystem"),
+    DebugRegenSubsystem,
+    TEXT("Print debug information for RegenSubsystem: 0 - Off, 1 - Low, 2 - High"),
+    ECVF_Cheat
+    );
+
+namespace NRegen
+{
+    /** The regenerated attribute for each pool, in pool order. */
+    static FGameplayAttribute CurrentAttribute(int32 Pool)
+    {
+        switch (Pool)
+        {
+        case 0: return UNAttributeSetBase::GetHealthAttribute();
+        case 1: return UNAttributeSetBase::GetManaAttribute();
+        case 2: return UNAttributeSetBase::GetStaminaAttribute();
+        default: return UNAttributeSetBase::GetShieldAttribute();
+        }
+    }
+
+    /** The attribute each pool regenerates at, in pool order. */
+    static FGameplayAttribute RegenRateAttribute(int32 Pool)
+    {
+        switch (Pool)
+        {
+        case 0: return UNAttributeSetBase::GetHealthRegenRateAttribute();
+        case 1: return UNAttributeSetBase::GetManaRegenRateAttribute();
+        case 2: return UNAttributeSetBase::GetStaminaRegenRateAttribute();
+        default: return UNAttributeSetBase::GetShieldRegenRateAttribute();
+        }
+    }
+
+    static constexpr int32 StaminaPool = 2;
+}
+
+
+void UNRegenSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    RegenInterval = 0.f;
+
+    // Cache tags
+    DeadTag = FGameplayTag::RequestGameplayTag(FName("State.Dead"));
+    RegenBlockedTag = FGameplayTag::RequestGameplayTag(FName("State.RegenBlocked"));
+    MaxStaminaTag = FGameplayTag::RequestGameplayTag(FName("State.Stats.MaxStamina"));
+}
+
+
+void UNRegenSubsystem::Deinitialize()
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(RegenTimerHandle);
+    }
+
+    AttributeSets.Empty();
+
+    Super::Deinitialize();
+}
+
+
+void UNRegenSubsystem::RegisterAttributeSet(UNAttributeSetBase* AttributeSet)
+{
+    UWorld* World = GetWorld();
+    if (!World || World->GetNetMode() == NM_Client)
+    {
+        if (DebugRegenSubsystem)
+        {
+            Print(World, FString::Printf(TEXT("%s Called on Client. Only call on server."), *FString(__FUNCTION__)), EPrintType::Warning);
+        }
+
+        return;
+    }
+
+    if (!AttributeSet)
+    {
+        return;
+    }
+
+    AttributeSets.AddUnique(AttributeSet);
+
+    if (!RegenTimerHandle.IsValid() && RegenUpdatesPerSecond > 0.f)
+    {
+        RegenInterval = 1.f / RegenUpdatesPerSecond;
+        World->GetTimerManager().SetTimer(RegenTimerHandle, this, &UNRegenSubsystem::RegenTick, RegenInterval, true);
+    }
+
+    if (DebugRegenSubsystem)
+    {
+        Print(World, FString::Printf(TEXT("%s %s registered, %d sets."), *FString(__FUNCTION__), *AttributeSet->GetName(), AttributeSets.Num()), EPrintType::Log);
+    }
+}
+
+
+void UNRegenSubsystem::UnregisterAttributeSet(UNAttributeSetBase* AttributeSet)
+{
+    AttributeSets.RemoveSwap(AttributeSet);
+}
+
+
+bool UNRegenSubsystem::IsRegenEffect(const UGameplayEffect* Effect)
+{
+    if (!Effect || Effect->Period.Value <= 0.f)
+    {
+        return false;
+    }
+
+    // Only a modifier on a pool scaled by that pool's regen rate, periodic damage, drains and buffs on the same
+    // attributes are not regen
+    TArray<FGameplayEffectAttributeCaptureDefinition> CaptureDefinitions;
+    for (const FGameplayModifierInfo& Modifier : Effect->Modifiers)
+    {
+        for (int32 Pool = 0; Pool < NumPools; ++Pool)
+        {
+            if (Modifier.Attribute != NRegen::CurrentAttribute(Pool))
+            {
+                continue;
+            }
+
+            CaptureDefinitions.Reset();
+            Modifier.ModifierMagnitude.GetAttributeCaptureDefinitions(CaptureDefinitions);
+            for (const FGameplayEffectAttributeCaptureDefinition& Definition : CaptureDefinitions)
+            {
+                if (Definition.AttributeToCapture == NRegen::RegenRateAttribute(Pool))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void UNRegenSubsystem::RegenTick()
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRegenTick);
+
+    const int32 Num = GatherAttributes();
+    if (Num == 0)
+    {
+        GetWorld()->GetTimerManager().ClearTimer(RegenTimerHandle);
+        return;
+    }
+
+    // Timer runs at a fixed rate, so integrate over its interval rather than the (possibly late) real time. The interval
+    // the timer was started with, the cvar may have changed since.
+    IntegrateRegen(Num, RegenInterval);
+    ApplyDeltas(Num);
+}
+
+
+int32 UNRegenSubsystem::GatherAttributes()
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRegenGather);
+
+    // Drop sets whose owners have been destroyed
+    AttributeSets.RemoveAllSwap([](const TWeakObjectPtr<UNAttributeSetBase>& Set) { return !Set.IsValid() || !Set->GetOwningAbilitySystemComponent(); });
+
+    const int32 Num = AttributeSets.Num();
+    SET_DWORD_STAT(STAT_NRegenAttributeSets, Num);
+
+    CurrentValues.SetNumUninitialized(Num * NumPools, false);
+    MaxValues.SetNumUninitialized(Num * NumPools, false);
+    RegenRates.SetNumUninitialized(Num * NumPools, false);
+    Deltas.SetNumUninitialized(Num * NumPools, false);
+    RegenScales.SetNumUninitialized(Num, false);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const UNAttributeSetBase* Set = AttributeSets[i].Get();
+        const UAbilitySystemComponent* ASC = Set->GetOwningAbilitySystemComponent();
+
+        RegenScales[i] = ASC->HasMatchingGameplayTag(DeadTag) || ASC->HasMatchingGameplayTag(RegenBlockedTag) ? 0.f : 1.f;
+
+        CurrentValues[0 * Num + i] = Set->GetHealth();
+        MaxValues[0 * Num + i] = Set->GetMaxHealth();
+        RegenRates[0 * Num + i] = Set->GetHealthRegenRate();
+
+        CurrentValues[1 * Num + i] = Set->GetMana();
+        MaxValues[1 * Num + i] = Set->GetMaxMana();
+        RegenRates[1 * Num + i] = Set->GetManaRegenRate();
+
+        CurrentValues[2 * Num + i] = Set->GetStamina();
+        MaxValues[2 * Num + i] = Set->GetMaxStamina();
+        RegenRates[2 * Num + i] = Set->GetStaminaRegenRate();
+
+        CurrentValues[3 * Num + i] = Set->GetShield();
+        MaxValues[3 * Num + i] = Set->GetMaxShield();
+        RegenRates[3 * Num + i] = Set->GetShieldRegenRate();
+    }
+
+    return Num;
+}
+
+
+void UNRegenSubsystem::IntegrateRegen(int32 Num, float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRegenIntegrate);
+
+    const float* RESTRICT Current = CurrentValues.GetData();
+    const float* RESTRICT Max = MaxValues.GetData();
+    const float* RESTRICT Rate = RegenRates.GetData();
+    const float* RESTRICT Scale = RegenScales.GetData();
+    float* RESTRICT Delta = Deltas.GetData();
+
+    // Branchless so the compiler can vectorize each pool, clamp keeps the result within [0, Max]
+    for (int32 Pool = 0; Pool < NumPools; ++Pool)
+    {
+        const int32 Offset = Pool * Num;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 Index = Offset + i;
+            const float Headroom = FMath::Max(Max[Index] - Current[Index], 0.f);
+            Delta[Index] = FMath::Clamp(Rate[Index] * DeltaTime * Scale[i], -Current[Index], Headroom);
+        }
+    }
+}
+
+
+void UNRegenSubsystem::ApplyDeltas(int32 Num)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRegenApply);
+
+    int32 Changed = 0;
+    for (int32 Pool = 0; Pool < NumPools; ++Pool)
+    {
+        const FGameplayAttribute Attribute = NRegen::CurrentAttribute(Pool);
+        const int32 Offset = Pool * Num;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const float Delta = Deltas[Offset + i];
+            if (Delta == 0.f)
+            {
+                continue;
+            }
+
+            // Writing the base value keeps any active modifiers on top, and fires the attribute change delegates once
+            UAbilitySystemComponent* ASC = AttributeSets[i]->GetOwningAbilitySystemComponent();
+            ASC->SetNumericAttributeBase(Attribute, ASC->GetNumericAttributeBase(Attribute) + Delta);
+            ++Changed;
+
+            // Matches UNAttributeSetBase::PostGameplayEffectExecute, which is not called for direct base value changes
+            if (Pool == NRegen::StaminaPool && CurrentValues[Offset + i] + Delta >= MaxValues[Offset + i])
+            {
+                ASC->SetLooseGameplayTagCount(MaxStaminaTag, 1);
+            }
+        }
+    }
+
+    SET_DWORD_STAT(STAT_NRegenAttributesChanged, Changed);
+
+    if (DebugRegenSubsystem > 1)
+    {
+        Print(GetWorld(), FString::Printf(TEXT("%s %d sets, %d attributes changed."), *FString(__FUNCTION__), Num, Changed), EPrintType::Log);
+    }
+}
@@ -2,6 +2,7 @@
 
 
 #include "AbilitySystem/Targeting/NGATA_Trace.h"
+#include "AbilitySystem/Targeting/NTargetTypes.h"
 #include "AbilitySystemComponent.h"
 #include "GameplayAbilitySpec.h"
 
@@ -291,9 +292,7 @@ FGameplayAbilityTargetDataHandle ANGATA_Trace::MakeTargetData(const TArray<FHitR
     for (int32 i = 0; i < HitResults.Num(); i++)
     {
         // Note: These are cleaned up by the FGameplayAbilityTargetDataHandle (via an internal TSharedPtr)
-        FGameplayAbilityTargetData_SingleTargetHit* ReturnData = new FGameplayAbilityTargetData_SingleTargetHit();
-        ReturnData->HitResult = HitResults[i];
-        ReturnDataHandle.Add(ReturnData);
+        ReturnDataHandle.Add(new FNGameplayAbilityTargetData_TraceHit(HitResults[i]));
     }
 
     return ReturnDataHandle;
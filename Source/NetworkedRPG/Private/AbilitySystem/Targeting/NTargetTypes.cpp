@@ -26,3 +26,29 @@ void UNTargetType_UseEventData::GetTargets(ANCharacterBase* TargetingCharacter,
 		OutActors.Add(const_cast<AActor*>(EventData.Target));
 	}
 }
+
+bool FNGameplayAbilityTargetData_TraceHit::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	UObject* HitActor = HitResult.Actor.Get();
+	bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), HitActor);
+
+	uint8 bBlockingHit = HitResult.bBlockingHit;
+	Ar.SerializeBits(&bBlockingHit, 1);
+
+	bOutSuccess &= SerializePackedVector<10, 24>(HitResult.TraceStart, Ar);
+	bOutSuccess &= SerializePackedVector<10, 24>(HitResult.TraceEnd, Ar);
+	bOutSuccess &= SerializePackedVector<10, 24>(HitResult.ImpactPoint, Ar);
+	bOutSuccess &= FVector_NetQuantizeUnitOct::FQuantizer::Serialize(HitResult.ImpactNormal, Ar);
+
+	if (Ar.IsLoading())
+	{
+		HitResult.Actor = Cast<AActor>(HitActor);
+		HitResult.bBlockingHit = bBlockingHit;
+		HitResult.Location = HitResult.ImpactPoint;
+		HitResult.Normal = HitResult.ImpactNormal;
+	}
+
+	return true;
+}
@@ -12,6 +12,7 @@
 #include "Components/NMovementSystemComponent.h"
 #include "Components/Combat/NCombatComponent.h"
 #include "AbilitySystem/NAbilitySystemComponent.h"
+#include "AbilitySystem/NRegenSubsystem.h"
 #include "Perception/AIPerceptionStimuliSourceComponent.h"
 #include "AbilitySystemComponent.h"
 #include "Camera/CameraComponent.h"
@@ -71,8 +72,11 @@ void ANCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifet
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ANCharacter, Camera);
-	DOREPLIFETIME(ANCharacter, CameraSpringArm);
+	// Set once in the constructor, push based so they are never compared after the initial replication
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ANCharacter, Camera, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ANCharacter, CameraSpringArm, Params);
 }
 
 
@@ -132,6 +136,12 @@ void ANCharacter::PossessedBy(AController* NewController)
 	AddStartupEffects();
 	AddCharacterAbilities();
 
+	// Regen is driven centrally on the server instead of by a periodic GE per character
+	if (UNRegenSubsystem* RegenSubsystem = GetWorld()->GetSubsystem<UNRegenSubsystem>())
+	{
+		RegenSubsystem->RegisterAttributeSet(AttributeSetBase);
+	}
+
 	if (ANPlayerController* PC = Cast<ANPlayerController>(GetController()))
 	{
 		PC->CreateHUD();
@@ -156,6 +166,21 @@ void ANCharacter::PossessedBy(AController* NewController)
 }
 
 
+// Server only
+void ANCharacter::UnPossessed()
+{
+	if (AttributeSetBase)
+	{
+		if (UNRegenSubsystem* RegenSubsystem = GetWorld()->GetSubsystem<UNRegenSubsystem>())
+		{
+			RegenSubsystem->UnregisterAttributeSet(AttributeSetBase);
+		}
+	}
+
+	Super::UnPossessed();
+}
+
+
 // Client only
 void ANCharacter::OnRep_PlayerState()
 {
@@ -5,6 +5,7 @@
 #include "AbilitySystem/GameplayAbilities/NGameplayAbility.h"
 #include "AbilitySystem/NAttributeSetBase.h"
 #include "AbilitySystem/NAbilitySystemComponent.h"
+#include "AbilitySystem/NRegenSubsystem.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
@@ -16,7 +17,11 @@
 #include "Components/TextRenderComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/NMovementSystemComponent.h"
+#include "Components/NNetFrequencyComponent.h"
 #include "Components/Combat/NCombatComponent.h"
+#include "NPushModel.h"
+#include "NSignificanceManager.h"
+#include "AI/NAIPerceptionSubsystem.h"
 
 
 FAutoConsoleVariableRef CVarDebugCharacter(
@@ -47,6 +52,10 @@ ANCharacterBase::ANCharacterBase(const FObjectInitializer& ObjectInitializer)
 	
 	MovementSystemComponent = CreateDefaultSubobject<UNMovementSystemComponent>("MovementSystemComponent");
 	CombatComponent = CreateDefaultSubobject<UNCombatComponent>("CombatComponent");
+	NetFrequencyComponent = CreateDefaultSubobject<UNNetFrequencyComponent>("NetFrequencyComponent");
+
+	Significance = ENSignificance::Critical;
+	DefaultVisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
 }
 
 
@@ -54,7 +63,20 @@ void ANCharacterBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutL
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 	
-	DOREPLIFETIME(ANCharacterBase, MovementSystemComponent);
+	// Set once in the constructor, push based so it is never compared after the initial replication
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ANCharacterBase, MovementSystemComponent, Params);
+}
+
+
+void ANCharacterBase::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	FScopeCycleCounter CycleCounter(NetFrequencyComponent->NotifyPreReplication());
+
+	Super::PreReplication(ChangedPropertyTracker);
+
+	NPushModel::ValidateProperties(this);
 }
 
 
@@ -74,9 +96,81 @@ void ANCharacterBase::OnHit(float Strength, float ZRotation) const
 }
 
 
+void ANCharacterBase::SetSignificance(ENSignificance InSignificance, const FNSignificanceSettings& Settings)
+{
+	Significance = InSignificance;
+
+	if (IsLocallyControlled())
+	{
+		return;
+	}
+
+	// Server side player movement is driven by their moves, only simulated and AI movement is ticked here
+	if (!IsPlayerControlled() || GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		GetCharacterMovement()->SetComponentTickInterval(Settings.TickInterval);
+	}
+
+	MovementSystemComponent->SetComponentTickInterval(Settings.TickInterval);
+
+	GetMesh()->SetComponentTickInterval(Settings.AnimTickInterval);
+	GetMesh()->VisibilityBasedAnimTickOption = Settings.bTickPoseWhenNotRendered ? DefaultVisibilityBasedAnimTickOption : EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+
+	// A PlayerState's ASC is shared with its other characters, only the character's own is slowed
+	if (AbilitySystemComponent && AbilitySystemComponent->GetOwner() == this)
+	{
+		AbilitySystemComponent->SetComponentTickInterval(Settings.TickInterval);
+	}
+
+	// Equipped weapons
+	TArray<AActor*> AttachedActors;
+	GetAttachedActors(AttachedActors);
+	for (AActor* AttachedActor : AttachedActors)
+	{
+		AttachedActor->SetActorTickInterval(Settings.TickInterval);
+	}
+
+	// Scales the combat or idle rate, only applied on the server
+	NetFrequencyComponent->SetFrequencyScale(Settings.NetUpdateFrequencyScale);
+
+	UNSignificanceManager::SetCosmeticsActive(this, Settings.bCosmetics);
+}
+
+
 void ANCharacterBase::BeginPlay()
 {
 	Super::BeginPlay();
+
+	DefaultVisibilityBasedAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+
+	if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->RegisterActor(this, UNSignificanceManager::CharacterTag);
+	}
+
+	if (HasAuthority())
+	{
+		if (UNAIPerceptionSubsystem* AIPerception = UNAIPerceptionSubsystem::Get(GetWorld()))
+		{
+			AIPerception->RegisterCharacter(this);
+		}
+	}
+}
+
+
+void ANCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterActor(this);
+	}
+
+	if (UNAIPerceptionSubsystem* AIPerception = UNAIPerceptionSubsystem::Get(GetWorld()))
+	{
+		AIPerception->UnregisterCharacter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
@@ -224,6 +318,16 @@ void ANCharacterBase::Die()
 
 	OnCharacterDied.Broadcast(this);
 
+	// Send the death now rather than at the next net update
+	if (HasAuthority())
+	{
+		ForceNetUpdate();
+		if (APlayerState* PS = GetPlayerState())
+		{
+			PS->ForceNetUpdate();
+		}
+	}
+
 	if (IsValid(AbilitySystemComponent))
 	{
 		AbilitySystemComponent->CancelAllAbilities();
@@ -446,6 +550,17 @@ void ANCharacterBase::AddStartupEffects()
 
 	for (TSubclassOf<UGameplayEffect> GameplayEffect : StartupEffects)
 	{
+		// Regen is driven by UNRegenSubsystem, a periodic regen effect left in StartupEffects would apply it twice
+		if (UNRegenSubsystem::IsRegenEffect(GameplayEffect.GetDefaultObject()))
+		{
+			if (DebugCharacter)
+			{
+				Print(GetWorld(), FString::Printf(TEXT("%s Skipped regen effect %s, UNRegenSubsystem drives regen."),*FString(__FUNCTION__), *GetNameSafe(GameplayEffect)), EPrintType::Warning);
+			}
+			
+			continue;
+		}
+
 		FGameplayEffectSpecHandle NewHandle = AbilitySystemComponent->MakeOutgoingSpec(GameplayEffect, GetCharacterLevel(), EffectContext);
 		if (NewHandle.IsValid())
 		{
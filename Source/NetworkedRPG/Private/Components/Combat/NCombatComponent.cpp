@@ -11,7 +11,9 @@
 #include "AbilitySystem/NAbilitySystemComponent.h"
 #include "NAssetManager.h"
 #include "Items/Data/NEquipmentItem.h"
+#include "Items/Actors/NWeaponActor.h"
 #include "Characters/NCharacter.h"
+#include "NPushModel.h"
 
 #include "GameFramework/Pawn.h"
 #include "GameFramework/PlayerController.h"
@@ -22,6 +24,9 @@
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Actors Spawned"), STAT_NWeaponActorsSpawned, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Actors Reused"), STAT_NWeaponActorsReused, STATGROUP_NRPG);
+
 
 FAutoConsoleVariableRef CVarDebugCombatComponent(
 	TEXT("NRPG.Debug.CombatComponent"),
@@ -75,6 +80,14 @@ UNCombatComponent::UNCombatComponent()
 
 	CollisionObjectType = ECC_Targeting;
 
+	EquipRequestInterval = 0.1f;
+	MaxPooledWeaponActors = 2;
+	LocalEquipPredictionKey = 0;
+	bEquipRequestPending = false;
+	LastEquipRequestTime = -1.f;
+	RequestedEquippedMask = 0;
+	RequestedEquipPredictionKey = 0;
+
 	SetIsReplicated(true);
 }
 
@@ -119,19 +132,50 @@ void UNCombatComponent::BeginPlay()
 }
 
 
+void UNCombatComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (ANWeaponActor* WeaponActor : WeaponActorPool)
+	{
+		if (IsValid(WeaponActor))
+		{
+			WeaponActor->Destroy();
+		}
+	}
+	WeaponActorPool.Empty();
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+
 void UNCombatComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
 	// Equipment Slots
-	DOREPLIFETIME(UNCombatComponent, WeaponSlots);
-	DOREPLIFETIME(UNCombatComponent, ArmourSlots);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNCombatComponent, WeaponSlots, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNCombatComponent, ArmourSlots, Params);
 
 	// TODO make this only rep to owner once implemented
-	DOREPLIFETIME(UNCombatComponent, ItemSlots);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNCombatComponent, ItemSlots, Params);
+
+	// Weapon equip prediction
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNCombatComponent, EquipAck, Params);
 
 	// Targeting system
-	DOREPLIFETIME_CONDITION(UNCombatComponent, Target, COND_SkipOwner);
+	Params.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNCombatComponent, Target, Params);
+}
+
+
+void UNCombatComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	NPushModel::ValidateProperties(this);
 }
 
 
@@ -235,6 +279,7 @@ bool UNCombatComponent::SlotItem(FNInventorySlot& InventorySlot)
 		{
 			ReplacedItem = Slot.GetItemCopy();
 			Slotted = Slot.SlotItem(InventorySlot);
+			MarkSlotDirty(Slot.SlotId);
 		}
 	}
 
@@ -285,6 +330,7 @@ bool UNCombatComponent::AutoSlotItem(FNInventorySlot& InventorySlot)
 	if (Slot)
 	{
 		Slot.SlotItem(InventorySlot);
+		MarkSlotDirty(Slot.SlotId);
 		return true;
 	}
 
@@ -321,6 +367,7 @@ bool UNCombatComponent::RemoveItemFromSlot(const ENItemSlotId& SlotId)
 	if (SlotToRemove)
 	{
 		RemovedItem = SlotToRemove.DeSlotItem();
+		MarkSlotDirty(SlotId);
 	}
 
 	if (RemovedItem)
@@ -387,10 +434,11 @@ bool UNCombatComponent::UpdateSlotNumber(const int32& OriginalSlotNumber, const
 		Print(GetWorld(), FString::Printf(TEXT("%s"), *FString(__FUNCTION__)), EPrintType::Log);	
 	}
 	
-	FNInventorySlot& Slot = FindSlot(OriginalSlotNumber);
+	FNEquipmentSlot& Slot = FindSlot(OriginalSlotNumber);
 	if (Slot)
 	{
 		Slot.SlotNumber = NewSlotNumber;
+		MarkSlotDirty(Slot.SlotId);
 		return true;
 	}
 
@@ -510,8 +558,16 @@ void UNCombatComponent::OnRep_WeaponSlots(TArray<FNWeaponSlot> OldWeaponSlots)
 		Print(GetWorld(), FString::Printf(TEXT("%s"),*FString(__FUNCTION__)));
 	}
 	
+	const bool bPredicting = OwningCharacter && OwningCharacter->IsLocallyControlled();
+	
 	for (int32 SlotIndex = 0; SlotIndex < FMath::Min(WeaponSlots.Num(),OldWeaponSlots.Num()); SlotIndex ++)
 	{
+		// Equipped state is predicted by the owning client and reconciled through EquipAck, keep it unless the weapon changed
+		if (bPredicting && WeaponSlots[SlotIndex].ItemData == OldWeaponSlots[SlotIndex].ItemData)
+		{
+			WeaponSlots[SlotIndex].KeepPredictedState(OldWeaponSlots[SlotIndex]);
+		}
+		
 		UpdateWeaponSlot(WeaponSlots[SlotIndex], OldWeaponSlots[SlotIndex]);
 	}
 
@@ -621,6 +677,33 @@ void UNCombatComponent::UpdateItemSlot(FNEquipmentSlot& ItemSlot, FNEquipmentSlo
 }
 
 
+void UNCombatComponent::MarkSlotDirty(ENItemSlotId SlotId)
+{
+	switch (SlotId)
+	{
+	case ENItemSlotId::None:
+		break;
+	case ENItemSlotId::Ranged:
+	case ENItemSlotId::Melee:
+		NMARK_PROPERTY_DIRTY(UNCombatComponent, WeaponSlots, this);
+		UpdateEquipAck();
+		break;
+	case ENItemSlotId::Head:
+	case ENItemSlotId::Neck:
+	case ENItemSlotId::RightRing:
+	case ENItemSlotId::LeftRing:
+	case ENItemSlotId::Torso:
+	case ENItemSlotId::Waist:
+	case ENItemSlotId::Legs:
+	case ENItemSlotId::Feet:
+		NMARK_PROPERTY_DIRTY(UNCombatComponent, ArmourSlots, this);
+		break;
+	default:
+		NMARK_PROPERTY_DIRTY(UNCombatComponent, ItemSlots, this);
+	}
+}
+
+
 USkeletalMeshComponent* UNCombatComponent::GetOwnerMesh() const
 {
 	return OwningCharacter->GetMesh();
@@ -700,12 +783,24 @@ void UNCombatComponent::EquipWeapon(ENItemSlotId SlotId)
 	if (Slot.IsHolstered())
 	{
 		Slot.Equip();
-		bSuccess = true;
+		bSuccess = Slot.IsEquipped();
 	}
 
-	if (!OwnerHasAuthority() && bSuccess)
+	if (!bSuccess)
+	{
+		return;
+	}
+	
+	if (OwnerHasAuthority())
 	{
-		ServerEquipWeapon(SlotId);
+		MarkSlotDirty(SlotId);
+		
+		// Don't wait for the owner's next net update, it may be at its idle rate
+		GetOwner()->ForceNetUpdate();
+	}
+	else
+	{
+		PredictWeaponChange();
 	}
 }
 
@@ -723,12 +818,64 @@ void UNCombatComponent::HolsterWeapon(ENItemSlotId SlotId)
 	if (Slot.IsEquipped())
 	{
 		Slot.Holster();
-		bSuccess = true;
+		bSuccess = Slot.IsHolstered();
+	}
+
+	if (!bSuccess)
+	{
+		return;
+	}
+	
+	if (OwnerHasAuthority())
+	{
+		MarkSlotDirty(SlotId);
+		
+		// Don't wait for the owner's next net update, it may be at its idle rate
+		GetOwner()->ForceNetUpdate();
+	}
+	else
+	{
+		PredictWeaponChange();
+	}
+}
+
+
+ANWeaponActor* UNCombatComponent::AcquireWeaponActor(TSubclassOf<ANWeaponActor> WeaponActorClass)
+{
+	for (int32 Index = WeaponActorPool.Num() - 1; Index >= 0; --Index)
+	{
+		ANWeaponActor* WeaponActor = WeaponActorPool[Index];
+		if (IsValid(WeaponActor) && WeaponActor->GetClass() == WeaponActorClass)
+		{
+			WeaponActorPool.RemoveAtSwap(Index);
+			INC_DWORD_STAT(STAT_NWeaponActorsReused);
+			return WeaponActor;
+		}
 	}
 
-	if (!OwnerHasAuthority() && bSuccess)
+	INC_DWORD_STAT(STAT_NWeaponActorsSpawned);
+	return GetWorld()->SpawnActor<ANWeaponActor>(WeaponActorClass);
+}
+
+
+void UNCombatComponent::ReleaseWeaponActor(ANWeaponActor* WeaponActor)
+{
+	if (!IsValid(WeaponActor))
 	{
-		ServerHolsterWeapon(SlotId);
+		return;
+	}
+
+	// Drop actors destroyed elsewhere before checking for space
+	WeaponActorPool.RemoveAll([](const ANWeaponActor* Pooled){ return !IsValid(Pooled); });
+	
+	if (WeaponActorPool.Num() < MaxPooledWeaponActors)
+	{
+		WeaponActor->Release();
+		WeaponActorPool.Add(WeaponActor);
+	}
+	else
+	{
+		WeaponActor->Destroy();
 	}
 }
 
@@ -749,6 +896,8 @@ void UNCombatComponent::UpdateCombatState(ENCombatType InCombatType, ENStance In
 	ActiveCombatType = InCombatType;
 	
 	UpdateCameraMode();
+
+	Interface->GetMovementSystemComponent()->SetCombatType(InCombatType, false);
 	
 	Interface->GetMovementSystemComponent()->SetRotationMode(
         InCombatType == ENCombatType::Ranged ?
@@ -836,6 +985,175 @@ void UNCombatComponent::SetActiveWeaponSwap(bool InActiveWeaponSwap)
 			Print(GetWorld(), FString::Printf(TEXT("%s"),*FString(__FUNCTION__)), EPrintType::Log);	
 		}
 	}
+	
+	// Deferred, the weapon actor that broadcast this is still finishing its swap
+	if (!bActiveWeaponChange)
+	{
+		if (OwnerHasAuthority())
+		{
+			if (RequestedEquipPredictionKey != EquipAck.PredictionKey)
+			{
+				GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UNCombatComponent::ApplyRequestedWeaponState);
+			}
+		}
+		else
+		{
+			GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UNCombatComponent::ReconcileWeaponState);
+		}
+	}
+}
+
+
+uint8 UNCombatComponent::GetEquippedWeaponMask() const
+{
+	uint8 Mask = 0;
+	for (int32 SlotIndex = 0; SlotIndex < FMath::Min(WeaponSlots.Num(), 8); SlotIndex++)
+	{
+		if (WeaponSlots[SlotIndex].IsEquipped())
+		{
+			Mask |= 1 << SlotIndex;
+		}
+	}
+
+	return Mask;
+}
+
+
+void UNCombatComponent::PredictWeaponChange()
+{
+	++LocalEquipPredictionKey;
+	bEquipRequestPending = true;
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (TimerManager.IsTimerActive(EquipRequestTimerHandle))
+	{
+		// Already scheduled, will send this change with the final state
+		return;
+	}
+
+	const float Delay = LastEquipRequestTime + EquipRequestInterval - GetWorld()->GetTimeSeconds();
+	if (LastEquipRequestTime >= 0.f && Delay > 0.f)
+	{
+		TimerManager.SetTimer(EquipRequestTimerHandle, this, &UNCombatComponent::SendWeaponStateRequest, Delay, false);
+	}
+	else
+	{
+		// Next tick so a holster and an equip in the same frame go as one request
+		EquipRequestTimerHandle = TimerManager.SetTimerForNextTick(this, &UNCombatComponent::SendWeaponStateRequest);
+	}
+}
+
+
+void UNCombatComponent::SendWeaponStateRequest()
+{
+	bEquipRequestPending = false;
+	LastEquipRequestTime = GetWorld()->GetTimeSeconds();
+	
+	ServerSetWeaponsEquipped(GetEquippedWeaponMask(), LocalEquipPredictionKey);
+}
+
+
+void UNCombatComponent::ApplyRequestedWeaponState()
+{
+	// Continued from SetActiveWeaponSwap() when the current swap ends
+	if (bActiveWeaponChange)
+	{
+		return;
+	}
+
+	// Holster first so swapping weapons puts one away before drawing the other
+	for (int32 SlotIndex = 0; SlotIndex < FMath::Min(WeaponSlots.Num(), 8); SlotIndex++)
+	{
+		FNWeaponSlot& Slot = WeaponSlots[SlotIndex];
+		if (!(RequestedEquippedMask & (1 << SlotIndex)) && Slot.IsEquipped())
+		{
+			HolsterWeapon(Slot.SlotId);
+			if (bActiveWeaponChange)
+			{
+				return;
+			}
+		}
+	}
+
+	for (int32 SlotIndex = 0; SlotIndex < FMath::Min(WeaponSlots.Num(), 8); SlotIndex++)
+	{
+		FNWeaponSlot& Slot = WeaponSlots[SlotIndex];
+		if ((RequestedEquippedMask & (1 << SlotIndex)) && Slot.IsHolstered())
+		{
+			EquipWeapon(Slot.SlotId);
+			if (bActiveWeaponChange)
+			{
+				return;
+			}
+		}
+	}
+
+	// Anything still different could not be applied, the client rolls back to EquipAck
+	EquipAck.PredictionKey = RequestedEquipPredictionKey;
+	UpdateEquipAck();
+}
+
+
+void UNCombatComponent::UpdateEquipAck()
+{
+	if (!OwnerHasAuthority())
+	{
+		return;
+	}
+	
+	EquipAck.EquippedMask = GetEquippedWeaponMask();
+	NMARK_PROPERTY_DIRTY(UNCombatComponent, EquipAck, this);
+}
+
+
+void UNCombatComponent::ReconcileWeaponState()
+{
+	if (OwnerHasAuthority() || !OwningCharacter || !OwningCharacter->IsLocallyControlled())
+	{
+		return;
+	}
+
+	// Only once the server has seen every prediction, and not mid animation
+	if (EquipAck.PredictionKey != LocalEquipPredictionKey || bEquipRequestPending || bActiveWeaponChange)
+	{
+		return;
+	}
+
+	for (int32 SlotIndex = 0; SlotIndex < FMath::Min(WeaponSlots.Num(), 8); SlotIndex++)
+	{
+		FNWeaponSlot& Slot = WeaponSlots[SlotIndex];
+		const bool bServerEquipped = (EquipAck.EquippedMask & (1 << SlotIndex)) != 0;
+		if (!Slot.IsSlotted() || Slot.IsEquipped() == bServerEquipped)
+		{
+			continue;
+		}
+
+		if (DebugCombatComponent)
+		{
+			Print(GetWorld(), FString::Printf(TEXT("%s Rolling back %s to %s."), *FString(__FUNCTION__), *Slot.ToString(), bServerEquipped ? TEXT("equipped") : TEXT("holstered")), EPrintType::Warning);
+		}
+
+		// Animate back rather than snap, the next mismatch is handled when this swap ends
+		if (bServerEquipped)
+		{
+			Slot.Equip();
+		}
+		else
+		{
+			Slot.Holster();
+		}
+		
+		if (bActiveWeaponChange)
+		{
+			return;
+		}
+	}
+}
+
+
+void UNCombatComponent::OnRep_EquipAck()
+{
+	ReconcileWeaponState();
 }
 
 
@@ -989,11 +1307,35 @@ void UNCombatComponent::CreateTargetWidget()
 }
 
 
+void UNCombatComponent::LockTarget(UPrimitiveComponent* TargetToLock)
+{
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		if (DebugCombatComponent)
+		{
+			Print(GetWorld(), FString::Printf(TEXT("%s Called on Client. Only call on server."), *FString(__FUNCTION__)), EPrintType::Warning);
+		}
+		return;
+	}
+
+	// Doesn't enable the tick, that only keeps a local player's camera on the target
+	if (TargetToLock)
+	{
+		Lock(TargetToLock);
+	}
+	else
+	{
+		UnLock();
+	}
+}
+
+
 void UNCombatComponent::SetTarget(UPrimitiveComponent* InTarget)
 {
 	if (Target != InTarget)
 	{
 		Target = InTarget;
+		NMARK_PROPERTY_DIRTY(UNCombatComponent, Target, this);
 
 		OnTargetUpdated.Broadcast(InTarget);
 	}
@@ -1195,13 +1537,11 @@ bool UNCombatComponent::ServerUnLock_Validate()
 }
 
 
-void UNCombatComponent::ServerEquipWeapon_Implementation(ENItemSlotId SlotId)
-{
-	EquipWeapon(SlotId);
-}
-
-
-void UNCombatComponent::ServerHolsterWeapon_Implementation(ENItemSlotId SlotId)
+void UNCombatComponent::ServerSetWeaponsEquipped_Implementation(uint8 EquippedMask, uint8 PredictionKey)
 {
-	HolsterWeapon(SlotId);
+	// Bits past the weapon slots are ignored
+	RequestedEquippedMask = EquippedMask & ((1 << FMath::Min(WeaponSlots.Num(), 8)) - 1);
+	RequestedEquipPredictionKey = PredictionKey;
+	
+	ApplyRequestedWeaponState();
 }
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include "Components/Inventory/NInventoryComponent.h"
 #include "Components/Combat/NCombatComponent.h"
 #include "NAssetManager.h"
+#include "NPushModel.h"
 #include "Items/Data/NItem.h"
 #include "Items/Actors/NPickupActor.h"
+#include "Items/NPickupDropSubsystem.h"
 #include "Player/NPlayerController.h"
 #include "UI/Inventory/NDropItemWidget.h"
 #include "UI/Inventory/NInventoryWidget.h"
@@ -33,7 +35,18 @@ void UNInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME_CONDITION(UNInventoryComponent, InventoryData, COND_OwnerOnly);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNInventoryComponent, InventoryData, Params);
+}
+
+
+void UNInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	NPushModel::ValidateProperties(this);
 }
 
 
@@ -75,6 +88,7 @@ int32 UNInventoryComponent::AddInventoryItem(UNItem* NewItem, int32 ItemCount, i
 				const int32 AddCount = FMath::Min(ItemCount, Slot.ItemData->StackMaxCount - Slot.Count);
 				Slot.Count += AddCount;
 				ItemCount -= AddCount;
+				NMARK_PROPERTY_DIRTY(UNInventoryComponent, InventoryData, this);
 
 				if (DebugInventoryComponent)
 				{
@@ -216,6 +230,7 @@ FNInventorySlot& UNInventoryComponent::AddNewItemSlot(UNItem* NewItem, int32& It
 	const int32 AddCount = FMath::Min(ItemCount, NewItem->StackMaxCount);
 	InventoryData.Emplace(FNInventorySlot(NewItem, AddCount, InventoryData.Num()));
 	ItemCount -= AddCount;
+	NMARK_PROPERTY_DIRTY(UNInventoryComponent, InventoryData, this);
 	
 	// If count is greater than can fit in this slot, and we still have room in inventory, call again
 	if (ItemCount > 0 && InventoryData.Num() < MaxSlots)
@@ -292,7 +307,9 @@ void UNInventoryComponent::SlotItem(const FNInventorySlot& InventorySlot)
 	FNInventorySlot& Slot = FindInventorySlot(InventorySlot);
 	if (Slot)
 	{
+		// Also flags the inventory slot as slotted
 		CombatComponent->SlotItem(Slot);
+		NMARK_PROPERTY_DIRTY(UNInventoryComponent, InventoryData, this);
 	}
 	else
 	{
@@ -398,6 +415,11 @@ bool UNInventoryComponent::RemoveInventoryItem(const FNInventorySlot& InInventor
 		InventoryData.RemoveAt(IndexToRemove);
 	}
 
+	if (bItemRemoved)
+	{
+		NMARK_PROPERTY_DIRTY(UNInventoryComponent, InventoryData, this);
+	}
+
 	if (DebugInventoryComponent && !bItemRemoved)
 	{
 		Print(GetWorld(), FString::Printf(TEXT("%s Failed. Item not removed."), *FString(__FUNCTION__)), EPrintType::Error);
@@ -436,9 +458,25 @@ void UNInventoryComponent::SpawnItemPickup(UNItem* ItemData, int32 Count) const
 	}
 	
 	const FTransform SpawnTransform = Cast<ANPlayerController>(GetOwner())->GetPawn()->GetActorTransform();
-	ANPickupActor* PickupActor = GetWorld()->SpawnActorDeferred<ANPickupActor>(Cast<ANetworkedRPGGameMode>(GetWorld()->GetAuthGameMode())->PickupItem, SpawnTransform);
+
+	const TSubclassOf<AActor> PickupClass = Cast<ANetworkedRPGGameMode>(GetWorld()->GetAuthGameMode())->PickupItem;
+
+	// Add to a drop of the same item at our feet rather than piling up another one
+	UNPickupDropSubsystem* DropSubsystem = UNPickupDropSubsystem::Get(GetWorld());
+	const ANPickupActor* PickupDefaults = PickupClass ? Cast<ANPickupActor>(PickupClass->GetDefaultObject()) : nullptr;
+	if (DropSubsystem && PickupDefaults && DropSubsystem->MergeDrop(ItemData, PickupDefaults->GetItemLevel(), Count, SpawnTransform.GetLocation()))
+	{
+		return;
+	}
+	
+	ANPickupActor* PickupActor = GetWorld()->SpawnActorDeferred<ANPickupActor>(PickupClass, SpawnTransform);
 	PickupActor->FinishSpawning(SpawnTransform);
 	PickupActor->SetItem(ItemData, Count);
+
+	if (DropSubsystem)
+	{
+		DropSubsystem->RegisterDrop(PickupActor);
+	}
 }
 
 
@@ -448,6 +486,7 @@ void UNInventoryComponent::OnCombatItemRemovedFromSlot(const FNInventorySlot& Re
 	if (Slot)
 	{
 		Slot.bIsSlotted = false;
+		NMARK_PROPERTY_DIRTY(UNInventoryComponent, InventoryData, this);
 	}
 
 	if (DebugInventoryComponent)
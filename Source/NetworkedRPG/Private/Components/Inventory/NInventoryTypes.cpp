@@ -3,6 +3,7 @@
 
 #include "Components/Inventory/NInventoryTypes.h"
 #include "Components/Inventory/NInventoryComponent.h"
+#include "Components/Combat/NCombatComponent.h"
 #include "Items/Data/NItem.h"
 #include "Items/Data/NWeaponItem.h"
 #include "Items/Actors/NMeleeWeaponActor.h"
@@ -351,15 +352,14 @@ bool FNWeaponSlot::SetItemData(UNItem* InItemData)
         return false;
     }
 
-    // Spawn the new WeaponActor
-    ANWeaponActor* NewWeaponActor;
+    TSubclassOf<ANWeaponActor> WeaponActorClass;
     switch(WeaponItem->SlotId)
     {
     case ENItemSlotId::Ranged:
-        NewWeaponActor = OwnerCharacter->GetMesh()->GetWorld()->SpawnActor<ANRangedWeaponActor>();
+        WeaponActorClass = ANRangedWeaponActor::StaticClass();
         break;
     case ENItemSlotId::Melee:
-        NewWeaponActor = OwnerCharacter->GetMesh()->GetWorld()->SpawnActor<ANMeleeWeaponActor>();
+        WeaponActorClass = ANMeleeWeaponActor::StaticClass();
         break;
     default:
         if (DebugCombatComponent)
@@ -370,24 +370,33 @@ bool FNWeaponSlot::SetItemData(UNItem* InItemData)
         return false;
     }
 
-    if (!NewWeaponActor)
+    UNCombatComponent* CombatComponent = OwnerCharacter->FindComponentByClass<UNCombatComponent>();
+    if (!CombatComponent)
     {
-        Print(OwnerCharacter, FString::Printf(TEXT("%s Failed: Could not spawn the new weapon actor. This should never happen."), *FString(__FUNCTION__)), EPrintType::Failure);
+        Print(OwnerCharacter, FString::Printf(TEXT("%s Failed: OwnerCharacter has no CombatComponent."), *FString(__FUNCTION__)), EPrintType::Failure);
         return false;
     }
 
-    NewWeaponActor->Initialize(OwnerCharacter, WeaponItem);
+    const bool bEmptySlot = WeaponActor == nullptr;
 
-    bool bEmptySlot = true;
+    // Rebind the slotted weapon actor to the new data in place, else take one from the owner's pool
+    if (WeaponActor && WeaponActor->GetClass() == WeaponActorClass)
+    {
+        WeaponActor->Release();
+    }
+    else
+    {
+        CombatComponent->ReleaseWeaponActor(WeaponActor);
+        WeaponActor = CombatComponent->AcquireWeaponActor(WeaponActorClass);
+    }
 
-    // Remove the old weapon actor if weapon was already slotted
-    if (WeaponActor)
+    if (!WeaponActor)
     {
-        WeaponActor->Destroy();
-        bEmptySlot = false;
+        Print(OwnerCharacter, FString::Printf(TEXT("%s Failed: Could not spawn the new weapon actor. This should never happen."), *FString(__FUNCTION__)), EPrintType::Failure);
+        return false;
     }
 
-    WeaponActor = NewWeaponActor;
+    WeaponActor->Initialize(OwnerCharacter, WeaponItem);
 
     // Play holster animation the slot was empty
     if (bEmptySlot)
@@ -413,7 +422,15 @@ void FNWeaponSlot::ClearSlot()
 {
     if (WeaponActor)
     {
-        WeaponActor->Destroy();
+        if (UNCombatComponent* CombatComponent = OwnerCharacter->FindComponentByClass<UNCombatComponent>())
+        {
+            CombatComponent->ReleaseWeaponActor(WeaponActor);
+        }
+        else
+        {
+            WeaponActor->Destroy();
+        }
+        
         WeaponActor = nullptr;
     }
     
@@ -3,11 +3,24 @@
 
 #include "Components/NCharacterMovementComponent.h"
 #include "Characters/NCharacterBase.h"
+#include "Components/NMovementSystemComponent.h"
+#include "AbilitySystem/NAttributeSetBase.h"
+#include "AbilitySystemComponent.h"
 
 UNCharacterMovementComponent::UNCharacterMovementComponent()
 {
     SprintSpeedMultiplier = 1.4f;
     AimSpeedMultiplier = 0.8f;
+    SprintCostInterval = 0.05f;
+
+    AckedStamina = 0.f;
+    AckedStaminaTimeStamp = -1.f;
+    ReplayStamina = 0.f;
+    bReplayingMoves = false;
+    LastSentStamina = -1.f;
+
+    // Cache tags
+    MaxStaminaTag = FGameplayTag::RequestGameplayTag(FName("State.Stats.MaxStamina"));
 }
 
 
@@ -46,9 +59,13 @@ void UNCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
     // The Flags parameter contains the compressed input flags that are stored in the save move.
     // UpdateFromCompressed flags simply copies the flags from the saved move into the movement component.
     // It basically just resets the movement component to the state when the move was made so it can simulate from there.
-    RequestToStartSprinting = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+    // Stamina gates the flag on both sides, so the server won't sprint a client that has run out.
+    RequestToStartSprinting = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0 && GetPredictedStamina() > 0.f;
 
     RequestToStartAiming = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+
+    // The only part of the movement state the simulation reads, so it travels with each move and replays with it
+    bOrientRotationToMovement = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
 }
 
 
@@ -69,12 +86,129 @@ FNetworkPredictionData_Client* UNCharacterMovementComponent::GetPredictionData_C
 }
 
 
+void UNCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+    Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+    const float SprintCost = GetSprintCostForMove(DeltaSeconds);
+    if (SprintCost <= 0.f)
+    {
+        return;
+    }
+
+    ANCharacterBase* Owner = Cast<ANCharacterBase>(GetOwner());
+    float RemainingStamina = 0.f;
+    
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        // Server owns the attribute, apply the drain directly instead of through a cost GE
+        if (UAbilitySystemComponent* ASC = Owner->GetAbilitySystemComponent())
+        {
+            ASC->ApplyModToAttributeUnsafe(UNAttributeSetBase::GetStaminaAttribute(), EGameplayModOp::Additive, -FMath::Min(SprintCost, Owner->GetStamina()));
+            ASC->SetLooseGameplayTagCount(MaxStaminaTag, 0);
+        }
+        
+        RemainingStamina = Owner->GetStamina();
+    }
+    else if (bReplayingMoves)
+    {
+        // Only the moves replayed so far count towards the next one
+        ReplayStamina = FMath::Max(ReplayStamina - SprintCost, 0.f);
+        RemainingStamina = ReplayStamina;
+    }
+    else
+    {
+        // This move isn't saved yet, so it is not included in the predicted stamina
+        RemainingStamina = GetPredictedStamina() - SprintCost;
+    }
+
+    // Replayed moves are re-gated in UpdateFromCompressedFlags, only stop on newly simulated moves
+    if (RemainingStamina <= 0.f && !CharacterOwner->bClientUpdating)
+    {
+        StopSprinting();
+        OnSprintStaminaDepleted.Broadcast();
+    }
+}
+
+
+bool UNCharacterMovementComponent::ClientUpdatePositionAfterServerUpdate()
+{
+    // Replayed moves apply their own flags, restore the current input once they are done
+    const bool bRealRequestToStartSprinting = RequestToStartSprinting;
+    const bool bRealRequestToStartAiming = RequestToStartAiming;
+    const bool bRealOrientRotationToMovement = bOrientRotationToMovement;
+
+    // Replays from the server's Stamina after the corrected move. It is sent just ahead of the correction, if it got
+    // lost the first replayed move's own record is the best left.
+    const FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
+    if (ClientData->LastAckedMove.IsValid() && ClientData->LastAckedMove->TimeStamp == AckedStaminaTimeStamp)
+    {
+        ReplayStamina = AckedStamina;
+    }
+    else
+    {
+        ReplayStamina = ClientData->SavedMoves.Num() > 0 ? static_cast<const FNSavedMove*>(ClientData->SavedMoves[0].Get())->SavedStartStamina : GetPredictedStamina();
+    }
+
+    bReplayingMoves = true;
+    const bool bResult = Super::ClientUpdatePositionAfterServerUpdate();
+    bReplayingMoves = false;
+
+    RequestToStartSprinting = bRealRequestToStartSprinting;
+    RequestToStartAiming = bRealRequestToStartAiming;
+    bOrientRotationToMovement = bRealOrientRotationToMovement;
+
+    return bResult;
+}
+
+
+void UNCharacterMovementComponent::SendClientAdjustment()
+{
+    FNetworkPredictionData_Server_Character* ServerData = HasPredictionData_Server() ? GetPredictionData_Server_Character() : nullptr;
+    const ANCharacterBase* Owner = Cast<ANCharacterBase>(GetOwner());
+    if (ServerData && Owner && ServerData->PendingAdjustment.TimeStamp > 0.f)
+    {
+        // A correction always carries it, the client replays from it. A good move only when it changed, so nothing
+        // extra is sent while not sprinting or regenerating.
+        const float Stamina = Owner->GetStamina();
+        if (!ServerData->PendingAdjustment.bAckGoodMove || Stamina != LastSentStamina)
+        {
+            ClientAckStamina(ServerData->PendingAdjustment.TimeStamp, Stamina);
+            LastSentStamina = Stamina;
+        }
+    }
+
+    Super::SendClientAdjustment();
+}
+
+
+void UNCharacterMovementComponent::CallServerMove(const FSavedMove_Character* NewMove, const FSavedMove_Character* OldMove)
+{
+    // Gait, stance and combat type don't change how a move simulates, rotation mode goes in the move's flags. So the rest
+    // of the state only has to reach the server, not line up with a move. Sent first so the server applies it before it
+    // simulates the move. Both are unreliable, so a changed state is repeated with every move until the server
+    // replicates it back.
+    UNMovementSystemComponent* MovementSystemComponent = GetMovementSystemComponent();
+    const uint8 MovementState = static_cast<const FNSavedMove*>(NewMove)->SavedMovementState;
+    if (MovementSystemComponent && MovementState != MovementSystemComponent->GetReplicatedMovementState())
+    {
+        ServerSetMovementState(NewMove->TimeStamp, MovementState);
+    }
+
+    Super::CallServerMove(NewMove, OldMove);
+}
+
+
 void UNCharacterMovementComponent::FNSavedMove::Clear()
 {
     Super::Clear();
 
     SavedRequestToStartSprinting = false;
     SavedRequestToStartAiming = false;
+    SavedOrientRotationToMovement = false;
+    SavedMovementState = 0;
+    SavedSprintCost = 0.f;
+    SavedStartStamina = 0.f;
 }
 
 
@@ -92,20 +226,30 @@ uint8 UNCharacterMovementComponent::FNSavedMove::GetCompressedFlags() const
         Result |= FLAG_Custom_1;
     }
 
+    if (SavedOrientRotationToMovement)
+    {
+        Result |= FLAG_Custom_2;
+    }
+
     return Result;
 }
 
 
 bool UNCharacterMovementComponent::FNSavedMove::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
 {
-    // if (SavedRequestToStartSprinting != (Cast<FNSavedMove>(&NewMove))->SavedRequestToStartSprinting)
-    if (SavedRequestToStartSprinting != ((FNSavedMove*)&NewMove)->SavedRequestToStartSprinting)
+    const FNSavedMove* NewNMove = static_cast<const FNSavedMove*>(NewMove.Get());
+    
+    if (SavedRequestToStartSprinting != NewNMove->SavedRequestToStartSprinting)
+    {
+        return false;
+    }
+
+    if (SavedRequestToStartAiming != NewNMove->SavedRequestToStartAiming)
     {
         return false;
     }
 
-    // if (SavedRequestToStartAiming != (Cast<FNSavedMove>(&NewMove))->SavedRequestToStartAiming)
-    if (SavedRequestToStartAiming != ((FNSavedMove*)&NewMove)->SavedRequestToStartAiming)
+    if (SavedMovementState != NewNMove->SavedMovementState)
     {
         return false;
     }
@@ -122,18 +266,42 @@ void UNCharacterMovementComponent::FNSavedMove::SetMoveFor(ACharacter* C, float
     {
         SavedRequestToStartSprinting = CharacterMovement->RequestToStartSprinting;
         SavedRequestToStartAiming = CharacterMovement->RequestToStartAiming;
+        SavedOrientRotationToMovement = CharacterMovement->bOrientRotationToMovement;
+
+        UNMovementSystemComponent* MovementSystemComponent = CharacterMovement->GetMovementSystemComponent();
+        SavedMovementState = MovementSystemComponent ? MovementSystemComponent->GetPackedMovementState() : 0;
+
+        // Not saved yet, so not counted in the predicted stamina
+        SavedStartStamina = CharacterMovement->GetPredictedStamina();
+    }
+}
+
+
+void UNCharacterMovementComponent::FNSavedMove::PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode)
+{
+    Super::PostUpdate(C, PostUpdateMode);
+
+    // Recorded after the move is performed, and again when replayed after a correction
+    UNCharacterMovementComponent* CharacterMovement = Cast<UNCharacterMovementComponent>(C->GetCharacterMovement());
+    if (CharacterMovement)
+    {
+        SavedSprintCost = CharacterMovement->GetSprintCostForMove(DeltaTime);
+    }
+}
+
+
+void UNCharacterMovementComponent::FNSavedMove::PrepMoveFor(ACharacter* C)
+{
+    Super::PrepMoveFor(C);
+
+    // Replayed moves start where the previous replayed move left off, so the next correction starts from here too
+    UNCharacterMovementComponent* CharacterMovement = Cast<UNCharacterMovementComponent>(C->GetCharacterMovement());
+    if (CharacterMovement && CharacterMovement->bReplayingMoves)
+    {
+        SavedStartStamina = CharacterMovement->ReplayStamina;
     }
 }
 
-// void UNCharacterMovementComponent::FNSavedMove::PrepMoveFor(ACharacter* C)
-// {
-//     Super::PrepMoveFor(C);
-//
-//     UNCharacterMovementComponent* CharacterMovement = Cast<UNCharacterMovementComponent>(C->GetMovementComponent());
-//     if (CharacterMovement)
-//     {
-//     }
-// }
 
 UNCharacterMovementComponent::FNNetworkPredictionData_Client::FNNetworkPredictionData_Client(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement)
 {
@@ -170,3 +338,97 @@ void UNCharacterMovementComponent::StopAiming()
     RequestToStartAiming = false;
 }
 
+
+float UNCharacterMovementComponent::GetPredictedStamina() const
+{
+    ANCharacterBase* Owner = Cast<ANCharacterBase>(GetOwner());
+    if (!Owner)
+    {
+        return 0.f;
+    }
+
+    if (GetOwnerRole() != ROLE_AutonomousProxy || !ClientPredictionData)
+    {
+        return Owner->GetStamina();
+    }
+
+    // Moves after the one being replayed haven't happened yet as far as the replay is concerned
+    if (bReplayingMoves)
+    {
+        return ReplayStamina;
+    }
+
+    // Subtracts the drain of the moves after the server's Stamina, which are the moves it hasn't processed yet. Until
+    // the first ack arrives, starts from the replicated attribute and counts every unacknowledged move.
+    const bool bHasAckedStamina = AckedStaminaTimeStamp >= 0.f;
+    float Stamina = bHasAckedStamina ? AckedStamina : Owner->GetStamina();
+
+    for (const FSavedMovePtr& Move : ClientPredictionData->SavedMoves)
+    {
+        if (!bHasAckedStamina || Move->TimeStamp > AckedStaminaTimeStamp)
+        {
+            Stamina -= static_cast<const FNSavedMove*>(Move.Get())->SavedSprintCost;
+        }
+    }
+
+    if (ClientPredictionData->PendingMove.IsValid())
+    {
+        Stamina -= static_cast<const FNSavedMove*>(ClientPredictionData->PendingMove.Get())->SavedSprintCost;
+    }
+
+    return FMath::Max(Stamina, 0.f);
+}
+
+
+UNMovementSystemComponent* UNCharacterMovementComponent::GetMovementSystemComponent() const
+{
+    ANCharacterBase* Owner = Cast<ANCharacterBase>(GetOwner());
+    return Owner ? Owner->GetMovementSystemComponent() : nullptr;
+}
+
+
+float UNCharacterMovementComponent::GetSprintCostForMove(float DeltaSeconds) const
+{
+    if (!RequestToStartSprinting || IsFalling() || GetCurrentAcceleration().IsZero() || SprintCostInterval <= 0.f)
+    {
+        return 0.f;
+    }
+
+    ANCharacterBase* Owner = Cast<ANCharacterBase>(GetOwner());
+    if (!Owner || !Owner->GetAttributeSet())
+    {
+        return 0.f;
+    }
+
+    return Owner->GetAttributeSet()->GetSprintCost() * DeltaSeconds / SprintCostInterval;
+}
+
+
+void UNCharacterMovementComponent::ServerSetMovementState_Implementation(float TimeStamp, uint8 InMovementState)
+{
+    // Drop states that arrive after a newer move was processed, the state of that move has already been applied
+    FNetworkPredictionData_Server_Character* ServerData = GetPredictionData_Server_Character();
+    bool bTimeStampResetDetected = false;
+    if (!ServerData || !IsClientTimeStampValid(TimeStamp, *ServerData, bTimeStampResetDetected))
+    {
+        return;
+    }
+
+    if (UNMovementSystemComponent* MovementSystemComponent = GetMovementSystemComponent())
+    {
+        MovementSystemComponent->SetPackedMovementState(InMovementState);
+    }
+}
+
+
+bool UNCharacterMovementComponent::ServerSetMovementState_Validate(float TimeStamp, uint8 InMovementState)
+{
+    return UNMovementSystemComponent::IsValidMovementState(InMovementState);
+}
+
+
+void UNCharacterMovementComponent::ClientAckStamina_Implementation(float TimeStamp, float Stamina)
+{
+    AckedStamina = Stamina;
+    AckedStaminaTimeStamp = TimeStamp;
+}
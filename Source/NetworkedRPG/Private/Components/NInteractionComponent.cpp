@@ -3,12 +3,20 @@
 
 #include "Components/NInteractionComponent.h"
 #include "Interface/NInteractableInterface.h"
+#include "Components/SphereComponent.h"
 #include "Components/WidgetComponent.h"
 #include "DrawDebugHelpers.h"
 #include "TimerManager.h"
 #include "Components/TimelineComponent.h"
 #include "GameFramework/Character.h"
 
+DECLARE_CYCLE_STAT(TEXT("Interaction Select"), STAT_NInteractionSelect, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Interaction Candidates"), STAT_NInteractionCandidates, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interaction Occlusion Traces"), STAT_NInteractionOcclusionTraces, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interact Requests Accepted"), STAT_NInteractRequestsAccepted, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interact Requests Rejected"), STAT_NInteractRequestsRejected, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interact Requests Coalesced"), STAT_NInteractRequestsCoalesced, STATGROUP_NRPG);
+
 
 FAutoConsoleVariableRef CVarDebugInteractionComponent(
     TEXT("NRPG.Debug.InteractionComponent"),
@@ -25,8 +33,16 @@ UNInteractionComponent::UNInteractionComponent()
 	PrimaryComponentTick.SetTickFunctionEnable(false); // Will toggle
 
 	// Set defaults
-	LineTraceTickRate = 0.3;
-	LineTraceDistance = 300.f;
+	CandidateUpdateRate = 0.1f;
+	InteractionRadius = 300.f;
+	MaxInteractionAngle = 70.f;
+	InteractRequestInterval = 0.2f;
+	ValidationTolerance = 100.f;
+
+	LocalInteractSequence = 0;
+	LastInteractSequence = 0;
+	bHasInteractSequence = false;
+	LastInteractTime = 0.f;
 	
 	InteractableIndicatorWidgetComponent = CreateDefaultSubobject<UWidgetComponent>(TEXT("IndicatorWidget"));
 	InteractableIndicatorWidgetComponent->SetWidgetSpace(EWidgetSpace::Screen);
@@ -55,7 +71,13 @@ void UNInteractionComponent::Interact()
 	// Only execute on the server
 	if (GetOwnerRole() != ROLE_Authority)
 	{
-		ServerInteract();
+		// Send what is selected, unless it was just requested
+		if (IsValid(CurrentInteractable) && !IsRecentlyInteracted(CurrentInteractable))
+		{
+			LastInteracted = CurrentInteractable;
+			LastInteractTime = GetWorld()->GetTimeSeconds();
+			ServerInteract(CurrentInteractable, ++LocalInteractSequence);
+		}
 		return;
 	}
 
@@ -64,13 +86,11 @@ void UNInteractionComponent::Interact()
 		Print(GetWorld(), FString::Printf(TEXT("%s"), *FString(__FUNCTION__)), EPrintType::Log);
 	}
 
-	// Call Interact if trace hits an Interactable
-	if (TScriptInterface<INInteractableInterface> Interactable = TraceForInteractable())
+	// Call Interact on the best Interactable in reach
+	AActor* Interactable = SelectInteractable();
+	if (Interactable && !IsRecentlyInteracted(Interactable))
 	{
-		if (Interactable && GetOwner())
-		{
-			Interactable->Interact(GetOwner());
-		}
+		ExecuteInteract(Interactable);
 	}
 }
 
@@ -120,37 +140,213 @@ void UNInteractionComponent::Initialize()
 		Print(GetWorld(), FString::Printf(TEXT("%s Indicator animation not set up - missing variables in Blueprint."), *FString(__FUNCTION__)), EPrintType::Failure);
 	}
 
-	// Start the Line Trace 'Tick' 
-	GetWorld()->GetTimerManager().SetTimer(InteractableTraceTickTimerHandle, this, &UNInteractionComponent::InteractableTraceTick, LineTraceTickRate, true, 2.f);
+	// Candidates are kept from overlaps with the reach sphere, which only overlaps components responding to ECC_Interaction
+	ReachSphere = NewObject<USphereComponent>(this);
+	ReachSphere->RegisterComponent();
+	ReachSphere->AttachToComponent(GetOwner()->GetRootComponent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+	ReachSphere->SetSphereRadius(InteractionRadius);
+	ReachSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	ReachSphere->SetCollisionResponseToAllChannels(ECR_Overlap);
+	ReachSphere->SetCollisionObjectType(ECC_Interaction);
+	ReachSphere->SetGenerateOverlapEvents(true);
+	ReachSphere->OnComponentBeginOverlap.AddDynamic(this, &UNInteractionComponent::OnReachBeginOverlap);
+	ReachSphere->OnComponentEndOverlap.AddDynamic(this, &UNInteractionComponent::OnReachEndOverlap);
+	ReachSphere->UpdateOverlaps();
 
-	
+	if (DebugInteractionComponent)
+	{
+		ReachSphere->SetVisibility(true);
+		ReachSphere->ShapeColor = FColor::Green;
+		ReachSphere->bHiddenInGame = false;
+	}
+}
+
+
+void UNInteractionComponent::OnReachBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (!OtherActor || OtherActor == GetOwner() || !OtherActor->Implements<UNInteractableInterface>() || Candidates.Contains(OtherActor))
+	{
+		return;
+	}
+
+	Candidates.Add(OtherActor);
+	INC_DWORD_STAT(STAT_NInteractionCandidates);
+
+	// Start ranking once something is in reach, and select right away instead of waiting for the timer
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(CandidateUpdateTimerHandle))
+	{
+		TimerManager.SetTimer(CandidateUpdateTimerHandle, this, &UNInteractionComponent::UpdateCurrentInteractable, CandidateUpdateRate, true);
+	}
+	UpdateCurrentInteractable();
 }
 
 
-void UNInteractionComponent::InteractableTraceTick()
+void UNInteractionComponent::OnReachEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
-	AActor* Hit = TraceForInteractable();
-	if (CurrentInteractable != Hit)
+	// The actor may have other components still overlapping
+	if (!OtherActor || ReachSphere->IsOverlappingActor(OtherActor) || Candidates.Remove(OtherActor) == 0)
+	{
+		return;
+	}
+
+	DEC_DWORD_STAT(STAT_NInteractionCandidates);
+
+	// Nothing in reach, so nothing runs until the next overlap
+	if (Candidates.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(CandidateUpdateTimerHandle);
+	}
+	UpdateCurrentInteractable();
+}
+
+
+void UNInteractionComponent::UpdateCurrentInteractable()
+{
+	AActor* Selected = SelectInteractable();
+	if (CurrentInteractable != Selected)
 	{
 		if (DebugInteractionComponent)
 		{
-			Print(GetWorld(), FString::Printf(TEXT("%s Trace %s."), *FString(__FUNCTION__), *FString(Hit ? "hit new actor" : "none")), EPrintType::Log);
+			Print(GetWorld(), FString::Printf(TEXT("%s Selected %s."), *FString(__FUNCTION__), *FString(Selected ? "new actor" : "none")), EPrintType::Log);
 		}
 		
-		SetCurrentInteractable(Hit);
+		SetCurrentInteractable(Selected);
 	}	
 }
 
 
-AActor* UNInteractionComponent::TraceForInteractable() const
+AActor* UNInteractionComponent::SelectInteractable() const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NInteractionSelect);
+
+	TArray<AActor*> InReach;
+	GatherCandidates(InReach);
+	if (InReach.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const FVector Location = GetOwner()->GetActorLocation();
+	const FVector Forward = GetOwner()->GetActorForwardVector();
+	const float MinDot = FMath::Cos(FMath::DegreesToRadians(MaxInteractionAngle));
+
+	// Rank by alignment with the facing direction, closer breaks near ties
+	TArray<TPair<float, AActor*>> Ranked;
+	Ranked.Reserve(InReach.Num());
+	for (AActor* Candidate : InReach)
+	{
+		const FVector ToCandidate = Candidate->GetActorLocation() - Location;
+		const float Distance = ToCandidate.Size();
+		const float Dot = Distance > KINDA_SMALL_NUMBER ? FVector::DotProduct(Forward, ToCandidate / Distance) : 1.f;
+		if (Dot < MinDot)
+		{
+			continue;
+		}
+
+		const float Score = Dot - 0.5f * Distance / InteractionRadius;
+		Ranked.Emplace(Score, Candidate);
+	}
+
+	Ranked.Sort([](const TPair<float, AActor*>& A, const TPair<float, AActor*>& B){ return A.Key > B.Key; });
+
+	// Only trace until the first visible candidate, usually the best ranked
+	for (const TPair<float, AActor*>& Entry : Ranked)
+	{
+		if (!IsOccluded(Entry.Value))
+		{
+			return Entry.Value;
+		}
+	}
+
+	return nullptr;
+}
+
+
+void UNInteractionComponent::GatherCandidates(TArray<AActor*>& OutCandidates) const
+{
+	if (ReachSphere)
+	{
+		for (AActor* Candidate : Candidates)
+		{
+			if (IsValid(Candidate))
+			{
+				OutCandidates.Add(Candidate);
+			}
+		}
+		return;
+	}
+
+	// No reach sphere off the owning client, so query the same volume once
+	TArray<FOverlapResult> Overlaps;
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(NInteractionGather), false, GetOwner());
+	GetWorld()->OverlapMultiByChannel(Overlaps, GetOwner()->GetActorLocation(), FQuat::Identity, ECC_Interaction, FCollisionShape::MakeSphere(InteractionRadius), Params);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Candidate = Overlap.GetActor();
+		if (Candidate && Candidate->Implements<UNInteractableInterface>())
+		{
+			OutCandidates.AddUnique(Candidate);
+		}
+	}
+}
+
+
+bool UNInteractionComponent::IsOccluded(const AActor* Interactable) const
 {
+	INC_DWORD_STAT(STAT_NInteractionOcclusionTraces);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(NInteractionOcclusion), false, GetOwner());
+	Params.AddIgnoredActor(Interactable);
+
 	const FVector TraceStart = GetOwner()->GetActorLocation();
-	const FVector TraceEnd = TraceStart + GetOwner()->GetActorForwardVector() * LineTraceDistance;
+	const FVector TraceEnd = Interactable->GetActorLocation();
 
 	FHitResult OutHit;
-	GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Interactable);
+	const bool bHit = GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, Params);
+
+	if (DebugInteractionComponent > 1)
+	{
+		DrawDebugLine(GetWorld(), TraceStart, TraceEnd, bHit ? FColor::Red : FColor::Green, false, CandidateUpdateRate);
+	}
+
+	return bHit;
+}
+
+
+bool UNInteractionComponent::ValidateInteractable(AActor* Interactable) const
+{
+	if (!IsValid(Interactable) || !Interactable->Implements<UNInteractableInterface>())
+	{
+		return false;
+	}
+
+	const FVector OwnerLocation = GetOwner()->GetActorLocation();
+	if (FVector::DistSquared(OwnerLocation, Interactable->GetActorLocation()) > FMath::Square(InteractionRadius + ValidationTolerance))
+	{
+		return false;
+	}
 
-	return OutHit.GetActor();
+	return !IsOccluded(Interactable);
+}
+
+
+bool UNInteractionComponent::IsRecentlyInteracted(const AActor* Interactable) const
+{
+	return Interactable && LastInteracted.Get() == Interactable && GetWorld()->GetTimeSeconds() - LastInteractTime < InteractRequestInterval;
+}
+
+
+void UNInteractionComponent::ExecuteInteract(AActor* Interactable)
+{
+	LastInteracted = Interactable;
+	LastInteractTime = GetWorld()->GetTimeSeconds();
+
+	if (INInteractableInterface* InteractableInterface = Cast<INInteractableInterface>(Interactable))
+	{
+		InteractableInterface->Interact(GetOwner());
+	}
 }
 
 
@@ -196,13 +392,41 @@ void UNInteractionComponent::OnTimelineFinish()
 }
 
 
-void UNInteractionComponent::ServerInteract_Implementation()
+void UNInteractionComponent::ServerInteract_Implementation(AActor* Interactable, uint8 Sequence)
 {
-	Interact();
+	// Duplicated or older than the last request
+	if (bHasInteractSequence && static_cast<int8>(Sequence - LastInteractSequence) <= 0)
+	{
+		INC_DWORD_STAT(STAT_NInteractRequestsCoalesced);
+		return;
+	}
+	bHasInteractSequence = true;
+	LastInteractSequence = Sequence;
+
+	// Still being processed from the last press
+	if (IsRecentlyInteracted(Interactable))
+	{
+		INC_DWORD_STAT(STAT_NInteractRequestsCoalesced);
+		return;
+	}
+
+	if (!ValidateInteractable(Interactable))
+	{
+		if (DebugInteractionComponent)
+		{
+			Print(GetWorld(), FString::Printf(TEXT("%s Rejected %s."), *FString(__FUNCTION__), *GetNameSafe(Interactable)), EPrintType::Warning);
+		}
+		
+		INC_DWORD_STAT(STAT_NInteractRequestsRejected);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_NInteractRequestsAccepted);
+	ExecuteInteract(Interactable);
 }
 
 
-bool UNInteractionComponent::ServerInteract_Validate()
+bool UNInteractionComponent::ServerInteract_Validate(AActor* Interactable, uint8 Sequence)
 {
 	return true;
 }
\ No newline at end of file
@@ -5,8 +5,10 @@
 #include "Components/Combat/NCombatComponent.h"
 #include "Components/NSpringArmComponent.h"
 #include "Characters/NCharacter.h"
+#include "NPushModel.h"
 
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Curves/CurveFloat.h"
 #include "DrawDebugHelpers.h"
 #include "Net/UnrealNetwork.h"
 
@@ -23,6 +25,35 @@ FAutoConsoleVariableRef CVarDebugMovementSystemComponent(
     ECVF_Cheat
     );
 
+static int32 DebugAimInterpolation = 0;
+FAutoConsoleVariableRef CVarDebugAimInterpolation(
+    TEXT("NRPG.Debug.AimInterpolation"),
+    DebugAimInterpolation,
+    TEXT("Show remote aim interpolation buffer depth, delay and error above simulated characters."),
+    ECVF_Cheat
+    );
+
+/** Max number of buffered remote aim samples */
+static constexpr int32 MaxAimSamples = 16;
+
+/** Bit layout of the packed movement state */
+namespace NMovementState
+{
+	static constexpr uint8 GaitShift = 0;
+	static constexpr uint8 GaitMask = 0x3;
+	static constexpr uint8 RotationModeShift = 2;
+	static constexpr uint8 RotationModeMask = 0x1;
+	static constexpr uint8 StanceShift = 3;
+	static constexpr uint8 StanceMask = 0x7;
+	static constexpr uint8 CombatTypeShift = 6;
+	static constexpr uint8 CombatTypeMask = 0x3;
+
+	static_assert(static_cast<uint8>(ENMovementGait::Sprinting) <= GaitMask, "ENMovementGait no longer fits the packed movement state.");
+	static_assert(static_cast<uint8>(ENRotationMode::LookingDirection) <= RotationModeMask, "ENRotationMode no longer fits the packed movement state.");
+	static_assert(static_cast<uint8>(ENStance::TwoHanded) <= StanceMask, "ENStance no longer fits the packed movement state.");
+	static_assert(static_cast<uint8>(ENCombatType::Ranged) <= CombatTypeMask, "ENCombatType no longer fits the packed movement state.");
+}
+
 
 
 // Sets default values for this component's properties
@@ -32,7 +63,18 @@ UNMovementSystemComponent::UNMovementSystemComponent()
 	PrimaryComponentTick.SetTickFunctionEnable(false); // Will turn on after initialization
 	
 	CameraSocketOffsetInterpSpeed = 4.f;
-	AimOffsetNetUpdatesPerSecond = 3.f;
+
+	AimInterpMinDelay = 0.05f;
+	AimInterpMaxDelay = 0.3f;
+	AimInterpJitterMultiplier = 2.f;
+	AimMaxExtrapolationTime = 0.1f;
+	AimInterpCurve = nullptr;
+
+	AimArrivalInterval = 0.1f;
+	AimArrivalJitter = 0.f;
+	AimInterpDelay = AimArrivalInterval;
+	SmoothedCameraRotator = FRotator::ZeroRotator;
+	bAimExtrapolating = false;
 
 	DefaultCameraModeSettings = FCameraModeSettings(FCameraMode({0.f, 0.f, 80.f}, 4.f, 20.f, 200.f));
 
@@ -62,6 +104,19 @@ void UNMovementSystemComponent::TickComponent(float DeltaTime, ELevelTick TickTy
 			SetComponentTickEnabled(false);
 		}
 	}
+	else if (!OwnerHasAuthority())
+	{
+		// Interpolate replicated aim, stop ticking once it has settled
+		if (!UpdateRemoteAim() && !DebugMovementSystemComponent && !DebugAimInterpolation)
+		{
+			SetComponentTickEnabled(false);
+		}
+
+		if (DebugAimInterpolation)
+		{
+			DrawAimInterpolationDebug();
+		}
+	}
 
 	if (DebugMovementSystemComponent)
 	{
@@ -77,36 +132,60 @@ void UNMovementSystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimePrope
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	// Replicated so we use them to figure out the aim offset for remote players
-	DOREPLIFETIME_CONDITION(UNMovementSystemComponent, QuantizedCameraRotationVector2D, COND_SkipOwner);
-
-    // TODO CombatComponent may not need to be replicated here, should test
-    DOREPLIFETIME_CONDITION(UNMovementSystemComponent, CombatComponent, COND_SkipOwner);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
 
-	// Replicated as this is used in anim blueprint for character stance
-	DOREPLIFETIME_CONDITION(UNMovementSystemComponent, Stance, COND_SkipOwner);
+	// Replicated as this is used in anim blueprint for character stance. Also sent to the owner, which resends its
+	// predicted state with each move until this matches.
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNMovementSystemComponent, MovementState, Params);
 
     // TODO CameraSpringArmComponent may not need to be replicated here, should test
-	DOREPLIFETIME(UNMovementSystemComponent, CameraSpringArmComponent);
-}
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNMovementSystemComponent, CameraSpringArmComponent, Params);
 
+	Params.Condition = COND_SkipOwner;
 
-void UNMovementSystemComponent::BeginPlay()
-{
-	Super::BeginPlay();
+	// Replicated so we use them to figure out the aim offset for remote players
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNMovementSystemComponent, QuantizedCameraRotationVector2D, Params);
 
-	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UNMovementSystemComponent::Initialize);
+    // TODO CombatComponent may not need to be replicated here, should test
+    DOREPLIFETIME_WITH_PARAMS_FAST(UNMovementSystemComponent, CombatComponent, Params);
 }
 
 
-void UNMovementSystemComponent::BeginDestroy()
+void UNMovementSystemComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
 {
-	if (CombatComponent && Owner->IsLocallyControlled())
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// The owning client's view rotation arrives with every ServerMove, so the aim offset updates at the movement rate
+	// without a separate RPC. Only changes are replicated.
+	if (Owner && OwnerHasAuthority())
 	{
-		CombatComponent->OnTargetUpdated.RemoveAll(this);
+		// Compared as sent, so changes smaller than a step don't dirty the property. The stored value is already quantized.
+		const FRotator ControlRotator = Owner->GetControlRotation().GetNormalized();
+		const FVector2D NewCameraRotation = FVector2D_NetQuantizeAngles::FQuantizer::Quantize(FVector2D(ControlRotator.Pitch, ControlRotator.Yaw));
+		if (NewCameraRotation != FVector2D_NetQuantizeAngles::FQuantizer::Quantize(QuantizedCameraRotationVector2D))
+		{
+			QuantizedCameraRotationVector2D = FVector2D_NetQuantizeAngles(NewCameraRotation.X, NewCameraRotation.Y);
+			NMARK_PROPERTY_DIRTY(UNMovementSystemComponent, QuantizedCameraRotationVector2D, this);
+		}
+
+		const uint8 NewMovementState = GetPackedMovementState();
+		if (NewMovementState != MovementState)
+		{
+			MovementState = NewMovementState;
+			NMARK_PROPERTY_DIRTY(UNMovementSystemComponent, MovementState, this);
+		}
 	}
 
-	Super::BeginDestroy();
+	NPushModel::ValidateProperties(this);
+}
+
+
+void UNMovementSystemComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UNMovementSystemComponent::Initialize);
 }
 
 
@@ -126,6 +205,7 @@ void UNMovementSystemComponent::Initialize()
     if (Owner->IsLocallyControlled())
     {
         CameraSpringArmComponent = Owner->FindComponentByClass<UNSpringArmComponent>();
+        NMARK_PROPERTY_DIRTY(UNMovementSystemComponent, CameraSpringArmComponent, this);
         SetCombatComponent(Owner->FindComponentByClass<UNCombatComponent>());
         SetRotationMode(ENRotationMode::VelocityDirection);
         SetCameraModeToDefault();
@@ -135,6 +215,16 @@ void UNMovementSystemComponent::Initialize()
             Print(GetWorld(), FString::Printf(TEXT("%s Owner does not have UNSpringArmComponent."), *FString(__FUNCTION__)), EPrintType::Error);
         }
     }
+    else if (OwnerHasAuthority())
+    {
+        // Server finds its own reference to replicate, rather than being sent it by the owner
+        SetCombatComponent(Owner->FindComponentByClass<UNCombatComponent>());
+    }
+    else
+    {
+        // State may have replicated before Owner was set
+        SetPackedMovementState(MovementState);
+    }
 }
 
 
@@ -149,18 +239,8 @@ void UNMovementSystemComponent::SetCombatComponent(UNCombatComponent* InCombatCo
         return;
     }
 
-    if (!OwnerHasAuthority())
-    {
-        ServerSetCombatComponent(InCombatComponent);
-    }
-
     CombatComponent = InCombatComponent;
-
-    if (Owner->IsLocallyControlled())
-    {
-        CombatComponent->OnTargetUpdated.AddDynamic(this, &UNMovementSystemComponent::OnTargetUpdated);
-        OnTargetUpdated(nullptr);
-    }
+    NMARK_PROPERTY_DIRTY(UNMovementSystemComponent, CombatComponent, this);
 }
 
 
@@ -244,11 +324,6 @@ void UNMovementSystemComponent::SetStance(ENStance InStance, bool bBroadcast)
 {
 	if (Stance != InStance)
 	{
-		if (!OwnerHasAuthority())
-		{
-			ServerSetStance(InStance, bBroadcast);
-		}
-		
 		Stance = InStance;
 		
 		if (bBroadcast)
@@ -280,6 +355,39 @@ void UNMovementSystemComponent::BroadcastSystemState() const
 }
 
 
+uint8 UNMovementSystemComponent::GetPackedMovementState() const
+{
+	return static_cast<uint8>(MovementGait) << NMovementState::GaitShift
+		| static_cast<uint8>(RotationMode) << NMovementState::RotationModeShift
+		| static_cast<uint8>(Stance) << NMovementState::StanceShift
+		| static_cast<uint8>(CombatType) << NMovementState::CombatTypeShift;
+}
+
+
+void UNMovementSystemComponent::SetPackedMovementState(uint8 InMovementState)
+{
+	if (!Owner || InMovementState == GetPackedMovementState() || !IsValidMovementState(InMovementState))
+	{
+		return;
+	}
+
+	SetMovementGait(static_cast<ENMovementGait>(InMovementState >> NMovementState::GaitShift & NMovementState::GaitMask), false);
+	SetRotationMode(static_cast<ENRotationMode>(InMovementState >> NMovementState::RotationModeShift & NMovementState::RotationModeMask), false);
+	SetStance(static_cast<ENStance>(InMovementState >> NMovementState::StanceShift & NMovementState::StanceMask), false);
+	SetCombatType(static_cast<ENCombatType>(InMovementState >> NMovementState::CombatTypeShift & NMovementState::CombatTypeMask), false);
+
+	BroadcastSystemState();
+}
+
+
+bool UNMovementSystemComponent::IsValidMovementState(uint8 InMovementState)
+{
+	return (InMovementState >> NMovementState::GaitShift & NMovementState::GaitMask) <= static_cast<uint8>(ENMovementGait::Sprinting)
+		&& (InMovementState >> NMovementState::StanceShift & NMovementState::StanceMask) <= static_cast<uint8>(ENStance::TwoHanded)
+		&& (InMovementState >> NMovementState::CombatTypeShift & NMovementState::CombatTypeMask) <= static_cast<uint8>(ENCombatType::Ranged);
+}
+
+
 void UNMovementSystemComponent::SetCameraMode(FCameraModeSettings NewCameraState)
 {
 	CameraModeSettings = NewCameraState;
@@ -320,35 +428,149 @@ FVector UNMovementSystemComponent::GetEyesLocation() const
 }
 
 
-void UNMovementSystemComponent::OnTargetUpdated(UPrimitiveComponent* InTarget)
+void UNMovementSystemComponent::SetOrientRotationToMovement(bool Value)
+{
+	Owner->GetCharacterMovement()->bOrientRotationToMovement = Value;
+}
+
+
+void UNMovementSystemComponent::OnRep_MovementState()
+{
+	// The owner predicts its own state
+	if (Owner && !Owner->IsLocallyControlled())
+	{
+		SetPackedMovementState(MovementState);
+	}
+}
+
+
+void UNMovementSystemComponent::OnRep_QuantizedCameraRotationVector2D()
 {
-	// Start NetUpdateTick if we are not targeting (need to replicate camera offset)
-	if (!InTarget && Owner->IsLocallyControlled())
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float Pitch = QuantizedCameraRotationVector2D.X;
+	float Yaw = QuantizedCameraRotationVector2D.Y;
+
+	if (AimSamples.Num() > 0)
 	{
-		GetWorld()->GetTimerManager().SetTimer(NetTickTimerHandle, this, &UNMovementSystemComponent::NetUpdateTick, 1 / AimOffsetNetUpdatesPerSecond, true);
+		const FAimSample Last = AimSamples.Last();
+		const float Interval = Now - Last.Time;
+		
+		if (Interval > AimInterpMaxDelay)
+		{
+			// Aim only replicates when it changes, so a long gap means it was still. Restart the stream from the held value
+			// one interval ago instead of slowly blending across the whole gap.
+			AimSamples.Reset();
+			AimSamples.Add({ Now - AimArrivalInterval, Last.Pitch, Last.Yaw });
+		}
+		else
+		{
+			// Running averages of interval and jitter, jitter as in RFC 3550
+			AimArrivalJitter += (FMath::Abs(Interval - AimArrivalInterval) - AimArrivalJitter) / 16.f;
+			AimArrivalInterval += (Interval - AimArrivalInterval) / 8.f;
+		}
+
+		Yaw = Last.Yaw + FMath::FindDeltaAngleDegrees(Last.Yaw, Yaw);
 	}
 	else
 	{
-		GetWorld()->GetTimerManager().ClearTimer(NetTickTimerHandle);
+		SmoothedCameraRotator = FRotator(Pitch, Yaw, 0.f);
 	}
+
+	AimInterpDelay = FMath::Clamp(AimArrivalInterval + AimInterpJitterMultiplier * AimArrivalJitter, AimInterpMinDelay, AimInterpMaxDelay);
+
+	AimSamples.Add({ Now, Pitch, Yaw });
+	if (AimSamples.Num() > MaxAimSamples)
+	{
+		AimSamples.RemoveAt(0, 1, false);
+	}
+
+	SetComponentTickEnabled(true);
 }
 
 
-void UNMovementSystemComponent::SetOrientRotationToMovement(bool Value)
+bool UNMovementSystemComponent::UpdateRemoteAim()
 {
-	if (!OwnerHasAuthority())
+	if (AimSamples.Num() == 0)
+	{
+		return false;
+	}
+
+	const float RenderTime = GetWorld()->GetTimeSeconds() - AimInterpDelay;
+
+	// First sample newer than the render time
+	int32 Next = 0;
+	while (Next < AimSamples.Num() && AimSamples[Next].Time <= RenderTime)
 	{
-		ServerSetOrientRotationToMovement(Value);
+		++Next;
 	}
+
+	// Render time is before every sample, hold the oldest
+	if (Next == 0)
+	{
+		const FAimSample& Oldest = AimSamples[0];
+		SmoothedCameraRotator = FRotator(Oldest.Pitch, Oldest.Yaw, 0.f).GetNormalized();
+		bAimExtrapolating = false;
+		return true;
+	}
+
+	// Render time is past the newest sample, extrapolate along the last segment for a limited time then hold
+	if (Next == AimSamples.Num())
+	{
+		bAimExtrapolating = true;
+
+		// Keep the last segment for its velocity
+		if (AimSamples.Num() > 2)
+		{
+			AimSamples.RemoveAt(0, AimSamples.Num() - 2, false);
+		}
+
+		const FAimSample& Newest = AimSamples.Last();
+		const float ExtrapolationTime = RenderTime - Newest.Time;
+		if (AimSamples.Num() < 2 || ExtrapolationTime > AimMaxExtrapolationTime)
+		{
+			SmoothedCameraRotator = FRotator(Newest.Pitch, Newest.Yaw, 0.f).GetNormalized();
+			return ExtrapolationTime <= AimMaxExtrapolationTime;
+		}
+
+		const FAimSample& Older = AimSamples[0];
+		const float SegmentTime = FMath::Max(Newest.Time - Older.Time, KINDA_SMALL_NUMBER);
+		const float Alpha = ExtrapolationTime / SegmentTime;
+		SmoothedCameraRotator = FRotator(Newest.Pitch + (Newest.Pitch - Older.Pitch) * Alpha, Newest.Yaw + (Newest.Yaw - Older.Yaw) * Alpha, 0.f).GetNormalized();
+		return true;
+	}
+
+	// Samples before the bracketing pair are no longer needed
+	if (Next > 1)
+	{
+		AimSamples.RemoveAt(0, Next - 1, false);
+		Next = 1;
+	}
+
+	const FAimSample& Prev = AimSamples[Next - 1];
+	const FAimSample& NextSample = AimSamples[Next];
+	const float SegmentTime = NextSample.Time - Prev.Time;
+	float Alpha = SegmentTime > KINDA_SMALL_NUMBER ? (RenderTime - Prev.Time) / SegmentTime : 1.f;
 	
-	Owner->GetCharacterMovement()->bOrientRotationToMovement = Value;
+	if (AimInterpCurve)
+	{
+		Alpha = AimInterpCurve->GetFloatValue(Alpha);
+	}
+
+	SmoothedCameraRotator = FRotator(FMath::Lerp(Prev.Pitch, NextSample.Pitch, Alpha), FMath::Lerp(Prev.Yaw, NextSample.Yaw, Alpha), 0.f).GetNormalized();
+	bAimExtrapolating = false;
+	return true;
 }
 
 
-void UNMovementSystemComponent::NetUpdateTick()
+void UNMovementSystemComponent::DrawAimInterpolationDebug() const
 {
-	const FRotator CameraRotator = GetCameraForwardRotator();
-	ServerUpdateCameraRotation(FVector_NetQuantize2D(CameraRotator.Pitch, CameraRotator.Yaw));
+	const FRotator Received = FRotator(QuantizedCameraRotationVector2D.X, QuantizedCameraRotationVector2D.Y, 0.f);
+	const FRotator Error = (Received - SmoothedCameraRotator).GetNormalized();
+	
+	const FString Text = FString::Printf(TEXT("Aim Samples: %d  Delay: %.0fms  Jitter: %.0fms  Error: %.1f, %.1f%s"),
+		AimSamples.Num(), AimInterpDelay * 1000.f, AimArrivalJitter * 1000.f, Error.Pitch, Error.Yaw, bAimExtrapolating ? TEXT("  Extrapolating") : TEXT(""));
+	
+	DrawDebugString(GetWorld(), FVector(0.f, 0.f, 120.f), Text, Owner, bAimExtrapolating ? FColor::Orange : FColor::White, 0.f);
 }
 
 
@@ -406,7 +628,13 @@ FRotator UNMovementSystemComponent::GetCameraForwardRotator() const
 		return (GetActorForwardRotator() + CameraSpringArmComponent->GetRelativeSocketRotation().Rotator()).GetNormalized();
 	}
 
-	// Returns the replicated value this actor is not the local player - replicated in NetworkUpdateTick
+	// Remote players use the interpolated replicated value
+	if (AimSamples.Num() > 0)
+	{
+		return SmoothedCameraRotator;
+	}
+
+	// Returns the replicated value this actor is not the local player - sampled in PreReplication
 	return FRotator(QuantizedCameraRotationVector2D.X, QuantizedCameraRotationVector2D.Y, 0.f);
 }
 
@@ -441,49 +669,3 @@ void UNMovementSystemComponent::DrawLocomotionDebugArrow(FRotator Rotator, FColo
 	const FVector Location = GetOwner()->GetActorLocation();
 	DrawDebugDirectionalArrow(GetWorld(), Location + FVector(0.f,0.f, ZOffset), Location + Rotator.Vector() * 200.f  + FVector(0.f,0.f, ZOffset), 10, Color, false, -1, 0, 8);
 }
-
-
-void UNMovementSystemComponent::ServerUpdateCameraRotation_Implementation(FVector_NetQuantize2D InVector)
-{
-	QuantizedCameraRotationVector2D = InVector;
-}
-
-bool UNMovementSystemComponent::ServerUpdateCameraRotation_Validate(FVector_NetQuantize2D InVector)
-{
-	return true;
-}
-
-
-void UNMovementSystemComponent::ServerSetCombatComponent_Implementation(UNCombatComponent* InCombatComponent)
-{
-	SetCombatComponent(InCombatComponent);
-}
-
-bool UNMovementSystemComponent::ServerSetCombatComponent_Validate(UNCombatComponent* InCombatComponent)
-{
-	return true;
-}
-
-
-void UNMovementSystemComponent::ServerSetOrientRotationToMovement_Implementation(bool Value)
-{
-	SetOrientRotationToMovement(Value);
-}
-
-bool UNMovementSystemComponent::ServerSetOrientRotationToMovement_Validate(bool Value)
-{
-	return true;
-}
-
-
-void UNMovementSystemComponent::ServerSetStance_Implementation(ENStance InStance, bool bBroadcast)
-{
-	SetStance(InStance, bBroadcast);
-}
-
-bool UNMovementSystemComponent::ServerSetStance_Validate(ENStance InStance, bool bBroadcast)
-{
-	return true;
-}
-
-
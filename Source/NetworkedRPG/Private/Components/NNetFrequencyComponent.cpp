@@ -0,0 +1,246 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/NNetFrequencyComponent.h"
+#include "AbilitySystem/GameplayAbilities/NGameplayAbility.h"
+#include "Components/Combat/NCombatComponent.h"
+#include "NReplicationGraph.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+
+DECLARE_CYCLE_STAT(TEXT("Net Frequency Evaluate"), STAT_NNetFrequencyEvaluate, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("Net PreReplication Idle"), STAT_NNetPreReplicationIdle, STATGROUP_NRPG);
+DECLARE_CYCLE_STAT(TEXT("Net PreReplication Combat"), STAT_NNetPreReplicationCombat, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Frequency Idle Actors"), STAT_NNetFrequencyIdleActors, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Frequency Combat Actors"), STAT_NNetFrequencyCombatActors, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Net Updates Idle"), STAT_NNetUpdatesIdle, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Net Updates Combat"), STAT_NNetUpdatesCombat, STATGROUP_NRPG);
+
+static int32 DebugNetFrequency = 0;
+FAutoConsoleVariableRef CVarDebugNetFrequency(
+    TEXT("NRPG.Debug.NetFrequency"),
+    DebugNetFrequency,
+    TEXT("Print net frequency state changes: 0 - Off, 1 - On"),
+    ECVF_Cheat
+    );
+
+
+// Sets default values for this component's properties
+UNNetFrequencyComponent::UNNetFrequencyComponent()
+{
+	// Only ticks on the server, enabled in BeginPlay()
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	IdleNetUpdateFrequency = 20.f;
+	CombatNetUpdateFrequency = 100.f;
+	CombatHoldTime = 5.f;
+	EvaluationInterval = 0.25f;
+
+	State = ENNetFrequencyState::Idle;
+	LastCombatTime = -1.f;
+	FrequencyScale = 1.f;
+	bActive = false;
+}
+
+
+void UNNetFrequencyComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!OwnerHasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	bActive = true;
+	INC_DWORD_STAT(STAT_NNetFrequencyIdleActors);
+	ApplyFrequency();
+
+	SetComponentTickInterval(EvaluationInterval);
+	SetComponentTickEnabled(true);
+}
+
+
+void UNNetFrequencyComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bActive)
+	{
+		bActive = false;
+		if (State == ENNetFrequencyState::Combat)
+		{
+			DEC_DWORD_STAT(STAT_NNetFrequencyCombatActors);
+		}
+		else
+		{
+			DEC_DWORD_STAT(STAT_NNetFrequencyIdleActors);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void UNNetFrequencyComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_NNetFrequencyEvaluate);
+
+	const float Time = GetWorld()->GetTimeSeconds();
+	if (HasCombatSignal())
+	{
+		LastCombatTime = Time;
+	}
+
+	const bool bInCombat = LastCombatTime >= 0.f && Time - LastCombatTime < CombatHoldTime;
+	SetState(bInCombat ? ENNetFrequencyState::Combat : ENNetFrequencyState::Idle);
+}
+
+
+void UNNetFrequencyComponent::NotifyCombat()
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	LastCombatTime = GetWorld()->GetTimeSeconds();
+	SetState(ENNetFrequencyState::Combat);
+}
+
+
+void UNNetFrequencyComponent::NotifyActorCombat(AActor* Actor)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	if (UNNetFrequencyComponent* Component = Actor->FindComponentByClass<UNNetFrequencyComponent>())
+	{
+		Component->NotifyCombat();
+	}
+
+	const APawn* Pawn = Cast<APawn>(Actor);
+	if (APlayerState* PlayerState = Pawn ? Pawn->GetPlayerState() : nullptr)
+	{
+		if (UNNetFrequencyComponent* Component = PlayerState->FindComponentByClass<UNNetFrequencyComponent>())
+		{
+			Component->NotifyCombat();
+		}
+	}
+}
+
+
+void UNNetFrequencyComponent::SetFrequencyScale(float Scale)
+{
+	FrequencyScale = Scale;
+
+	if (bActive)
+	{
+		ApplyFrequency();
+	}
+}
+
+
+TStatId UNNetFrequencyComponent::NotifyPreReplication() const
+{
+	if (State == ENNetFrequencyState::Combat)
+	{
+		INC_DWORD_STAT(STAT_NNetUpdatesCombat);
+		return GET_STATID(STAT_NNetPreReplicationCombat);
+	}
+
+	INC_DWORD_STAT(STAT_NNetUpdatesIdle);
+	return GET_STATID(STAT_NNetPreReplicationIdle);
+}
+
+
+bool UNNetFrequencyComponent::HasCombatSignal() const
+{
+	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(GetOwner());
+
+	// The ASC of a player lives on the PlayerState, the signals come from the character it is driving
+	const AActor* Avatar = GetOwner();
+	if (ASC && ASC->AbilityActorInfo.IsValid() && ASC->AbilityActorInfo->AvatarActor.IsValid())
+	{
+		Avatar = ASC->AbilityActorInfo->AvatarActor.Get();
+	}
+
+	if (const UNCombatComponent* CombatComponent = Avatar->FindComponentByClass<UNCombatComponent>())
+	{
+		if (CombatComponent->IsLocked())
+		{
+			return true;
+		}
+	}
+
+	if (ASC)
+	{
+		for (const FGameplayAbilitySpec& Spec : ASC->GetActivatableAbilities())
+		{
+			const UNGameplayAbility* Ability = Cast<UNGameplayAbility>(Spec.Ability);
+			if (Spec.IsActive() && Ability && Ability->bIsCombatAbility)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+void UNNetFrequencyComponent::SetState(ENNetFrequencyState NewState)
+{
+	if (State == NewState)
+	{
+		return;
+	}
+
+	if (DebugNetFrequency)
+	{
+		Print(GetWorld(), FString::Printf(TEXT("%s %s -> %s"), *FString(__FUNCTION__), *GetOwner()->GetName(), NewState == ENNetFrequencyState::Combat ? TEXT("Combat") : TEXT("Idle")));
+	}
+
+	if (NewState == ENNetFrequencyState::Combat)
+	{
+		DEC_DWORD_STAT(STAT_NNetFrequencyIdleActors);
+		INC_DWORD_STAT(STAT_NNetFrequencyCombatActors);
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_NNetFrequencyCombatActors);
+		INC_DWORD_STAT(STAT_NNetFrequencyIdleActors);
+	}
+
+	State = NewState;
+	ApplyFrequency();
+
+	// Don't wait out the rest of an idle update period for the first combat update
+	if (State == ENNetFrequencyState::Combat)
+	{
+		GetOwner()->ForceNetUpdate();
+	}
+}
+
+
+void UNNetFrequencyComponent::ApplyFrequency() const
+{
+	AActor* Owner = GetOwner();
+
+	const float StateFrequency = State == ENNetFrequencyState::Combat ? CombatNetUpdateFrequency : IdleNetUpdateFrequency;
+	const float Frequency = FMath::Max(StateFrequency * FrequencyScale, 1.f);
+	if (FMath::IsNearlyEqual(Owner->NetUpdateFrequency, Frequency))
+	{
+		return;
+	}
+
+	Owner->NetUpdateFrequency = Frequency;
+	UNReplicationGraph::UpdateActorNetUpdateFrequency(Owner);
+}
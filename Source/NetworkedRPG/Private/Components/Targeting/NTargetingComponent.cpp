@@ -5,6 +5,7 @@
 #include "Components/NMovementSystemComponent.h"
 #include "Components/NSpringArmComponent.h"
 #include "Characters/NCharacter.h"
+#include "NPushModel.h"
 
 #include "Components/SphereComponent.h"
 #include "Components/TextRenderComponent.h"
@@ -79,7 +80,18 @@ void UNTargetingComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME_CONDITION(UNTargetingComponent, Target, COND_SkipOwner);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UNTargetingComponent, Target, Params);
+}
+
+
+void UNTargetingComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	NPushModel::ValidateProperties(this);
 }
 
 
@@ -206,6 +218,7 @@ void UNTargetingComponent::SetTarget(UPrimitiveComponent* InTarget)
 	if (Target != InTarget)
 	{
 		Target = InTarget;
+		NMARK_PROPERTY_DIRTY(UNTargetingComponent, Target, this);
 		OnTargetUpdated.Broadcast(InTarget);
 	}
 }
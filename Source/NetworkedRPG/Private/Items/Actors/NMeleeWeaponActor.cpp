@@ -19,7 +19,8 @@ void ANMeleeWeaponActor::Initialize(FWeaponActorData InData)
 
         if (CombatComponent)
         {
-            Mesh->OnComponentBeginOverlap.AddDynamic(CombatComponent, &UNCombatComponent::OnWeaponCollision);
+            // Unique, a pooled actor is initialized again for each weapon it holds
+            Mesh->OnComponentBeginOverlap.AddUniqueDynamic(CombatComponent, &UNCombatComponent::OnWeaponCollision);
         }        
     }  
 }
@@ -33,3 +34,17 @@ void ANMeleeWeaponActor::BeginDestroy()
 
     Super::BeginDestroy();
 }
+
+
+void ANMeleeWeaponActor::Release()
+{
+    if (CombatComponent)
+    {
+        Mesh->OnComponentBeginOverlap.RemoveDynamic(CombatComponent, &UNCombatComponent::OnWeaponCollision);
+    }
+
+    Mesh->SetGenerateOverlapEvents(false);
+    Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+    Super::Release();
+}
@@ -3,13 +3,20 @@
 
 #include "Items/Actors/NPickupActor.h"
 #include "Items/Data/NItem.h"
+#include "Items/NPickupAnimationSubsystem.h"
+#include "Items/NPickupDropSubsystem.h"
 #include "Components/Inventory/NInventoryComponent.h"
+#include "NPushModel.h"
+#include "NSignificanceManager.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/SphereComponent.h"
-#include "Components/TimelineComponent.h"
 #include "Components/WidgetComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickups Simulating"), STAT_NPickupsSimulating, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickups Settled"), STAT_NPickupsSettled, STATGROUP_NRPG);
 
 static int32 DebugPickupActor = 0;
 FAutoConsoleVariableRef CVarDebugPickupActor(
@@ -22,7 +29,8 @@ FAutoConsoleVariableRef CVarDebugPickupActor(
 // Sets default values
 ANPickupActor::ANPickupActor()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Idle animation runs in UNPickupAnimationSubsystem
+	PrimaryActorTick.bCanEverTick = false;
 
 	CollisionCapsule = CreateDefaultSubobject<UCapsuleComponent>("CollisionCapsule");
 	CollisionCapsule->SetSimulatePhysics(true);
@@ -32,6 +40,7 @@ ANPickupActor::ANPickupActor()
 	CollisionCapsule->SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
 	CollisionCapsule->SetCollisionResponseToChannel(ECC_WorldDynamic, ECR_Block);
 	CollisionCapsule->SetCollisionObjectType(ECC_WorldDynamic);
+	CollisionCapsule->BodyInstance.bGenerateWakeEvents = true;
 	RootComponent = CollisionCapsule;
 	
 	PickupCapsuleComponent = CreateDefaultSubobject<UCapsuleComponent>("PickupSphere");
@@ -39,6 +48,7 @@ ANPickupActor::ANPickupActor()
 	PickupCapsuleComponent->SetCapsuleSize(60.f, 80.f);
 	PickupCapsuleComponent->SetCollisionResponseToAllChannels(ECR_Ignore);
 	PickupCapsuleComponent->SetCollisionResponseToChannel(ECC_Interactable, ECR_Block);
+	PickupCapsuleComponent->SetCollisionResponseToChannel(ECC_Interaction, ECR_Overlap);
 	PickupCapsuleComponent->SetCollisionObjectType(ECC_WorldDynamic);
 	PickupCapsuleComponent->SetupAttachment(RootComponent);
 
@@ -53,23 +63,15 @@ ANPickupActor::ANPickupActor()
 
 	ItemLevel = 1;
 	ItemCount = 1;
+	MaxSimulateTime = 5.f;
 
+	// Only ItemData replicates, and it only changes through SetItem(). Placed pickups don't open a channel until then,
+	// spawned pickups replicate once and go dormant.
 	SetReplicates(true);
+	NetDormancy = DORM_Initial;
 }
 
 
-// Called every frame if rotation speed or BobbingCurve set
-void ANPickupActor::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	if (AnimationRoot)
-	{
-		AnimationRoot->SetRelativeRotation(AnimationRoot->GetRelativeRotation() + RotationSpeed * DeltaTime);
-		BobbingTimeline.TickTimeline(DeltaTime);
-	}
-}
-
 void ANPickupActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
@@ -84,7 +86,17 @@ void ANPickupActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLif
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ANPickupActor, ItemData);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ANPickupActor, ItemData, Params);
+}
+
+
+void ANPickupActor::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	NPushModel::ValidateProperties(this);
 }
 
 
@@ -150,29 +162,84 @@ void ANPickupActor::BeginPlay()
 		}
 	}
 
-	InitialOffset = AnimationRoot->GetRelativeLocation();
+	if (HasAnimation())
+	{
+		if (UNPickupAnimationSubsystem* AnimationSubsystem = UNPickupAnimationSubsystem::Get(GetWorld()))
+		{
+			AnimationSubsystem->RegisterAnimation(this, AnimationRoot, BobbingCurve, BobbingHeight, RotationSpeed);
+		}
+	}
+
+	if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->RegisterActor(this, UNSignificanceManager::PickupTag);
+	}
+
+	// Simulates on the server and clients separately until it settles
+	if (CollisionCapsule->IsSimulatingPhysics())
+	{
+		INC_DWORD_STAT(STAT_NPickupsSimulating);
+		CollisionCapsule->OnComponentSleep.AddDynamic(this, &ANPickupActor::OnCollisionCapsuleSleep);
+		GetWorldTimerManager().SetTimer(SettleTimerHandle, this, &ANPickupActor::Settle, FMath::Max(MaxSimulateTime, 0.01f));
+	}
+}
+
+
+void ANPickupActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNSignificanceManager* SignificanceManager = UNSignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterActor(this);
+	}
+
+	if (UNPickupDropSubsystem* DropSubsystem = UNPickupDropSubsystem::Get(GetWorld()))
+	{
+		DropSubsystem->UnregisterDrop(this);
+	}
+
+	if (CollisionCapsule->IsSimulatingPhysics())
+	{
+		DEC_DWORD_STAT(STAT_NPickupsSimulating);
+	}
+	GetWorldTimerManager().ClearTimer(SettleTimerHandle);
+
+	if (UNPickupAnimationSubsystem* AnimationSubsystem = UNPickupAnimationSubsystem::Get(GetWorld()))
+	{
+		AnimationSubsystem->UnregisterAnimation(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
-	if (BobbingCurve && BobbingHeight > 0.f)
-	{	
-		FOnTimelineFloat ProgressFunction;
-		ProgressFunction.BindDynamic(this, &ANPickupActor::HandleTimelineAnimation);
 
-		BobbingTimeline.AddInterpFloat(BobbingCurve, ProgressFunction);
-		BobbingTimeline.SetLooping(true);
-		BobbingTimeline.PlayFromStart();
-	} 
-	else if (RotationSpeed == FRotator::ZeroRotator)
+void ANPickupActor::SetSignificance(ENSignificance Significance, const FNSignificanceSettings& Settings)
+{
+	// The animation is cosmetic, the subsystem doesn't exist on a dedicated server
+	if (UNPickupAnimationSubsystem* AnimationSubsystem = UNPickupAnimationSubsystem::Get(GetWorld()))
 	{
-		// No animations set so don't need tick
-		SetActorTickEnabled(false);
+		AnimationSubsystem->SetAnimationSignificance(this, Significance != ENSignificance::Culled, Settings.TickInterval);
 	}
+
+	UNSignificanceManager::SetCosmeticsActive(this, Settings.bCosmetics);
+}
+
+
+bool ANPickupActor::HasAnimation() const
+{
+	return (BobbingCurve && BobbingHeight > 0.f) || RotationSpeed != FRotator::ZeroRotator;
 }
 
 
 void ANPickupActor::SetItem(UNItem* InItem, int32 InCount)
 {
+	if (HasAuthority() && ItemData != InItem)
+	{
+		FlushNetDormancy();
+	}
+	
 	ItemData = InItem;
 	ItemCount = InCount;
+	NMARK_PROPERTY_DIRTY(ANPickupActor, ItemData, this);
 	UpdateItemMesh();
 }
 
@@ -186,10 +253,36 @@ void ANPickupActor::UpdateItemMesh() const
 }
 
 
-void ANPickupActor::HandleTimelineAnimation(float Value)
+void ANPickupActor::Settle()
+{
+	if (!CollisionCapsule->IsSimulatingPhysics())
+	{
+		return;
+	}
+
+	GetWorldTimerManager().ClearTimer(SettleTimerHandle);
+	CollisionCapsule->SetSimulatePhysics(false);
+	DEC_DWORD_STAT(STAT_NPickupsSimulating);
+	INC_DWORD_STAT(STAT_NPickupsSettled);
+
+	if (DebugPickupActor)
+	{
+		Print(GetWorld(), FString::Printf(TEXT("%s %s settled."), *FString(__FUNCTION__), *GetName()));
+	}
+
+	if (HasAuthority())
+	{
+		if (UNPickupDropSubsystem* DropSubsystem = UNPickupDropSubsystem::Get(GetWorld()))
+		{
+			DropSubsystem->OnDropSettled(this);
+		}
+	}
+}
+
+
+void ANPickupActor::OnCollisionCapsuleSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
 {
-	const FVector NewLocation = FMath::Lerp(InitialOffset, InitialOffset + FVector(0.f,0.f, BobbingHeight), Value);
-	AnimationRoot->SetRelativeLocation(NewLocation);
+	Settle();
 }
 
 
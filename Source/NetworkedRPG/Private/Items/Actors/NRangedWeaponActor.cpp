@@ -27,6 +27,16 @@ void ANRangedWeaponActor::PreReplication(IRepChangedPropertyTracker& ChangedProp
 }
 
 
+void ANRangedWeaponActor::Release()
+{
+    const ANRangedWeaponActor* Defaults = GetDefault<ANRangedWeaponActor>(GetClass());
+    SetClipAmmo(Defaults->ClipAmmo);
+    SetMaxClipAmmo(Defaults->MaxClipAmmo);
+
+    Super::Release();
+}
+
+
 void ANRangedWeaponActor::SetClipAmmo(int32 NewClipAmmo)
 {
     int32 OldClipAmmo = ClipAmmo;
@@ -9,44 +9,21 @@
 #include "AbilitySystemInterface.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Items/Data/NWeaponItem.h"
+#include "Items/NAttachTransitionSubsystem.h"
 
 
 ANWeaponActor::ANWeaponActor()
 {
-    PrimaryActorTick.bCanEverTick = true;
-    PrimaryActorTick.SetTickFunctionEnable(false);
+    // Attach transitions run in UNAttachTransitionSubsystem
+    PrimaryActorTick.bCanEverTick = false;
 
     // Mesh = CreateDefaultSubobject<UMeshComponent>(TEXT("MeshComponent"));
     // SetRootComponent(Mesh);
 
     SetReplicates(false);
-}
-
 
-void ANWeaponActor::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
-{
-    Super::TickActor(DeltaTime,TickType, ThisTickFunction);
-
-    bool Updated = false;
-    
-    if (RelativeLocation != TargetRelativeLocation)
-    {
-        RelativeLocation = FMath::VInterpTo(RelativeLocation, TargetRelativeLocation, DeltaTime, 10.f);
-        Mesh->SetRelativeLocation(RelativeLocation);
-        Updated = true;
-    }
-    
-    if (RelativeRotation != TargetRelativeRotation)
-    {
-        RelativeRotation = FMath::RInterpTo(RelativeRotation, TargetRelativeRotation, DeltaTime, 10.f);
-        Mesh->SetRelativeRotation(RelativeRotation);
-        Updated = true;
-    }
-
-    if (!Updated)
-    {
-        SetActorTickEnabled(false);
-    }
+    // State only changes on equip, holster and SetProperties(), which flush it. Has no effect while not replicated.
+    NetDormancy = DORM_DormantAll;
 }
 
 
@@ -130,6 +107,8 @@ bool ANWeaponActor::Equip(bool bAnimate)
     }
 
 
+    FlushReplicatedState();
+
     if (bAnimate)
     {
         // Make sure we begin equip animation with weapon in correct holstered location
@@ -172,6 +151,8 @@ bool ANWeaponActor::Holster(bool bAnimate)
         return false;
     }
 
+    FlushReplicatedState();
+
     if (bAnimate)
     {
         // Make sure we begin holster animation with weapon in correct equipped location
@@ -196,7 +177,10 @@ bool ANWeaponActor::Holster(bool bAnimate)
 
 void ANWeaponActor::SetProperties(FWeaponActorData InData)
 {
+    FlushReplicatedState();
+
     SetOwner(InData.OwningCharacter);
+    SetActorHiddenInGame(false);
     Mesh->SetSkeletalMesh(InData.WeaponData->ItemMesh);
     AttachToComponent(InData.OwningCharacter->GetMesh(), FAttachmentTransformRules::SnapToTargetIncludingScale);
     EquippedGameplayTag = InData.WeaponData->EquippedGameplayTag;
@@ -210,26 +194,42 @@ void ANWeaponActor::SetProperties(FWeaponActorData InData)
 }
 
 
-void ANWeaponActor::AttachWeaponToSocket(FName& SocketName, FAttachmentOffset& Offset, bool bSmoothAttach)
+void ANWeaponActor::Release()
 {
-    TargetRelativeLocation = Offset.RelativeLocationOffset;;
-    TargetRelativeRotation = Offset.RelativeRotationOffset;
+    // The owner would otherwise wait for a notify that never comes
+    if (bActiveWeaponSwap && Data)
+    {
+        Data.OwningCharacter->GetMesh()->GetAnimInstance()->OnPlayMontageNotifyBegin.RemoveAll(this);
+        CombatComponent->OnWeaponSwapping.Broadcast(false);
+    }
+
+    FlushReplicatedState();
+
+    bActiveWeaponSwap = false;
+    bIsEquipped = false;
+    Data = FWeaponActorData();
 
+    UNAttachTransitionSubsystem::CancelTransitionFor(Mesh);
+    SetActorHiddenInGame(true);
+    DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+}
+
+
+void ANWeaponActor::AttachWeaponToSocket(FName& SocketName, FAttachmentOffset& Offset, bool bSmoothAttach)
+{
     Mesh->AttachToComponent(Data.OwningCharacter->GetMesh(), FAttachmentTransformRules::KeepWorldTransform, SocketName);
 
     if (bSmoothAttach)
     {
-        // Handle interpolation of location/rotation in tick
-        RelativeLocation = Mesh->GetRelativeLocation();
-        RelativeRotation = Mesh->GetRelativeRotation();
+        // Transition from where the weapon was to the offset, snaps on a dedicated server
+        UNAttachTransitionSubsystem::StartOrSnap(Mesh, Offset.RelativeLocationOffset, Offset.RelativeRotationOffset);
     }
     else
     {
         // Snap to target location and rotation
-        Mesh->SetRelativeLocationAndRotation(TargetRelativeLocation, TargetRelativeRotation);   
+        UNAttachTransitionSubsystem::CancelTransitionFor(Mesh);
+        Mesh->SetRelativeLocationAndRotation(Offset.RelativeLocationOffset, Offset.RelativeRotationOffset);   
     }
-    
-    SetActorTickEnabled(bSmoothAttach);
 }
 
 
@@ -254,6 +254,16 @@ void ANWeaponActor::OnWeaponSwapAnimNotify(FName NotifyName, const FBranchingPoi
     Data.OwningCharacter->GetMesh()->GetAnimInstance()->OnPlayMontageNotifyBegin.RemoveAll(this);
 }
 
+void ANWeaponActor::FlushReplicatedState()
+{
+    // Non replicated weapons are spawned on each machine and have authority on clients too
+    if (GetIsReplicated() && HasAuthority())
+    {
+        FlushNetDormancy();
+    }
+}
+
+
 void ANWeaponActor::OnRep_Data()
 {
     if (Data)
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/NAttachTransitionSubsystem.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Attach Transition Update"), STAT_NAttachTransitionUpdate, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Attach Transitions"), STAT_NAttachTransitions, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attach Transitions Updated"), STAT_NAttachTransitionsUpdated, STATGROUP_NRPG);
+
+static float AttachTransitionDuration = 0.3f;
+FAutoConsoleVariableRef CVarAttachTransitionDuration(
+	TEXT("NRPG.AttachTransition.Duration"),
+	AttachTransitionDuration,
+	TEXT("Seconds for an attached component to reach its target relative transform. 0 snaps."),
+	ECVF_Default
+	);
+
+namespace NAttachTransition
+{
+	/** Cubic ease out, fast at first and settling into the target like the interpolation it replaces */
+	static float Ease(float Alpha)
+	{
+		const float Remaining = 1.f - Alpha;
+		return 1.f - Remaining * Remaining * Remaining;
+	}
+}
+
+
+void UNAttachTransitionSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_NAttachTransitions, Transitions.Num());
+	Transitions.Empty();
+
+	Super::Deinitialize();
+}
+
+
+void UNAttachTransitionSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NAttachTransitionUpdate);
+
+	const float Time = GetWorld()->GetTimeSeconds();
+
+	// Finished and orphaned transitions are removed in place, iterating from the end keeps the one swapped in from
+	// being skipped
+	for (int32 Index = Transitions.Num() - 1; Index >= 0; --Index)
+	{
+		const FNAttachTransition& Transition = Transitions[Index];
+		USceneComponent* Component = Transition.Component.Get();
+		if (!Component)
+		{
+			Transitions.RemoveAtSwap(Index);
+			DEC_DWORD_STAT(STAT_NAttachTransitions);
+			continue;
+		}
+
+		const float Alpha = Transition.Duration > 0.f ? FMath::Clamp((Time - Transition.StartTime) / Transition.Duration, 0.f, 1.f) : 1.f;
+		const bool bFinished = Alpha >= 1.f;
+
+		// Nobody sees the way there, only where it ends
+		const AActor* Owner = Component->GetOwner();
+		if (!bFinished && Owner && !Owner->WasRecentlyRendered(VisibleRenderTime))
+		{
+			continue;
+		}
+
+		if (bFinished)
+		{
+			Component->SetRelativeLocationAndRotation(Transition.TargetLocation, Transition.TargetRotation);
+		}
+		else
+		{
+			const float Eased = NAttachTransition::Ease(Alpha);
+			Component->SetRelativeLocationAndRotation(
+				FMath::Lerp(Transition.StartLocation, Transition.TargetLocation, Eased),
+				FQuat::Slerp(Transition.StartRotation, Transition.TargetRotation, Eased));
+		}
+		INC_DWORD_STAT(STAT_NAttachTransitionsUpdated);
+
+		if (bFinished)
+		{
+			Transitions.RemoveAtSwap(Index);
+			DEC_DWORD_STAT(STAT_NAttachTransitions);
+		}
+	}
+}
+
+
+TStatId UNAttachTransitionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNAttachTransitionSubsystem, STATGROUP_Tickables);
+}
+
+
+UNAttachTransitionSubsystem* UNAttachTransitionSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UNAttachTransitionSubsystem>() : nullptr;
+}
+
+
+void UNAttachTransitionSubsystem::StartTransition(USceneComponent* Component, const FVector& TargetLocation, const FRotator& TargetRotation)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	// Weapons of a dedicated server started from the editor still have to end up in the right socket for its traces
+	if (IsDedicatedServerWorld() || AttachTransitionDuration <= 0.f)
+	{
+		CancelTransition(Component);
+		Component->SetRelativeLocationAndRotation(TargetLocation, TargetRotation);
+		return;
+	}
+
+	int32 Index = FindTransition(Component);
+	if (Index == INDEX_NONE)
+	{
+		Index = Transitions.AddDefaulted();
+		INC_DWORD_STAT(STAT_NAttachTransitions);
+	}
+
+	FNAttachTransition& Transition = Transitions[Index];
+	Transition.Component = Component;
+	Transition.StartLocation = Component->GetRelativeLocation();
+	Transition.TargetLocation = TargetLocation;
+	Transition.StartRotation = Component->GetRelativeRotation().Quaternion();
+	Transition.TargetRotation = TargetRotation.Quaternion();
+	Transition.StartTime = GetWorld()->GetTimeSeconds();
+	Transition.Duration = AttachTransitionDuration;
+}
+
+
+void UNAttachTransitionSubsystem::StartOrSnap(USceneComponent* Component, const FVector& TargetLocation, const FRotator& TargetRotation)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	if (UNAttachTransitionSubsystem* Subsystem = Get(Component->GetWorld()))
+	{
+		Subsystem->StartTransition(Component, TargetLocation, TargetRotation);
+	}
+	else
+	{
+		Component->SetRelativeLocationAndRotation(TargetLocation, TargetRotation);
+	}
+}
+
+
+void UNAttachTransitionSubsystem::CancelTransition(const USceneComponent* Component)
+{
+	const int32 Index = FindTransition(Component);
+	if (Index != INDEX_NONE)
+	{
+		Transitions.RemoveAtSwap(Index);
+		DEC_DWORD_STAT(STAT_NAttachTransitions);
+	}
+}
+
+
+void UNAttachTransitionSubsystem::CancelTransitionFor(const USceneComponent* Component)
+{
+	if (UNAttachTransitionSubsystem* Subsystem = Component ? Get(Component->GetWorld()) : nullptr)
+	{
+		Subsystem->CancelTransition(Component);
+	}
+}
+
+
+int32 UNAttachTransitionSubsystem::FindTransition(const USceneComponent* Component) const
+{
+	// Only the few weapons swapping at the moment are in here
+	return Transitions.IndexOfByPredicate([Component](const FNAttachTransition& Transition)
+	{
+		return Transition.Component.Get() == Component;
+	});
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/NClientTickableSubsystem.h"
+#include "Engine/World.h"
+
+
+bool UNClientTickableSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+}
+
+
+bool UNClientTickableSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return !HasAnyFlags(RF_ClassDefaultObject) && World && World->IsGameWorld() && HasWork();
+}
+
+
+bool UNClientTickableSubsystem::IsDedicatedServerWorld() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->GetNetMode() == NM_DedicatedServer;
+}
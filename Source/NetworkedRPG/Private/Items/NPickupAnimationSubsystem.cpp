@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/NPickupAnimationSubsystem.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Animation Update"), STAT_NPickupAnimationUpdate, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickup Animations"), STAT_NPickupAnimations, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Animations Updated"), STAT_NPickupAnimationsUpdated, STATGROUP_NRPG);
+
+static float PickupAnimationCullDistance = 3000.f;
+FAutoConsoleVariableRef CVarPickupAnimationCullDistance(
+	TEXT("NRPG.PickupAnimation.CullDistance"),
+	PickupAnimationCullDistance,
+	TEXT("Pickups further than this from every local viewer are not animated."),
+	ECVF_Default
+	);
+
+namespace NPickupAnimation
+{
+	/** Seconds the start of a pickup without a bobbing curve is randomly offset by */
+	static constexpr float RotationPhaseRange = 10.f;
+}
+
+
+void UNPickupAnimationSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_NPickupAnimations, Animations.Num());
+	Animations.Empty();
+	AnimationIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+
+void UNPickupAnimationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NPickupAnimationUpdate);
+
+	GatherViewLocations();
+
+	const float Time = GetWorld()->GetTimeSeconds();
+	const float CullDistanceSquared = FMath::Square(PickupAnimationCullDistance);
+
+	// Pickups destroyed without EndPlay are dropped here. Iterating from the end, RemoveAnimationAt() swaps the last
+	// animation into Index, and that one has already been updated this frame.
+	for (int32 Index = Animations.Num() - 1; Index >= 0; --Index)
+	{
+		FNPickupAnimation& Animation = Animations[Index];
+		if (!Animation.Owner.IsValid() || !Animation.AnimationRoot.IsValid())
+		{
+			RemoveAnimationAt(Index);
+			continue;
+		}
+
+		if (!Animation.bEnabled || Time < Animation.NextUpdateTime || !IsVisible(Animation.Owner.Get(), CullDistanceSquared))
+		{
+			continue;
+		}
+
+		Animation.NextUpdateTime = Time + Animation.UpdateInterval;
+		Evaluate(Animation, Time);
+		INC_DWORD_STAT(STAT_NPickupAnimationsUpdated);
+	}
+}
+
+
+TStatId UNPickupAnimationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNPickupAnimationSubsystem, STATGROUP_Tickables);
+}
+
+
+UNPickupAnimationSubsystem* UNPickupAnimationSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UNPickupAnimationSubsystem>() : nullptr;
+}
+
+
+void UNPickupAnimationSubsystem::RegisterAnimation(AActor* Owner, USceneComponent* AnimationRoot, const UCurveFloat* BobbingCurve, float BobbingHeight, const FRotator& RotationSpeed)
+{
+	// Nobody watches the pickups of a dedicated server started from the editor
+	if (!Owner || !AnimationRoot || IsDedicatedServerWorld() || AnimationIndices.Contains(Owner))
+	{
+		return;
+	}
+
+	FNPickupAnimation Animation;
+	Animation.Owner = Owner;
+	Animation.AnimationRoot = AnimationRoot;
+	Animation.BobbingCurve = BobbingHeight > 0.f ? BobbingCurve : nullptr;
+	Animation.BobbingCurveLength = 0.f;
+	Animation.BobbingHeight = BobbingHeight;
+	Animation.RotationSpeed = RotationSpeed;
+	Animation.InitialOffset = AnimationRoot->GetRelativeLocation();
+	Animation.InitialRotation = AnimationRoot->GetRelativeRotation();
+	Animation.UpdateInterval = 0.f;
+	Animation.NextUpdateTime = 0.f;
+	Animation.bEnabled = true;
+
+	if (Animation.BobbingCurve)
+	{
+		float MinTime;
+		Animation.BobbingCurve->GetTimeRange(MinTime, Animation.BobbingCurveLength);
+	}
+
+	// Starts at a random point of its cycle, pickups dropped together would otherwise bob and turn in step
+	const float PhaseRange = Animation.BobbingCurveLength > 0.f ? Animation.BobbingCurveLength : NPickupAnimation::RotationPhaseRange;
+	Animation.Phase = FMath::FRand() * PhaseRange - GetWorld()->GetTimeSeconds();
+
+	AnimationIndices.Add(Owner, Animations.Add(Animation));
+	INC_DWORD_STAT(STAT_NPickupAnimations);
+}
+
+
+void UNPickupAnimationSubsystem::UnregisterAnimation(AActor* Owner)
+{
+	if (const int32* Index = AnimationIndices.Find(Owner))
+	{
+		RemoveAnimationAt(*Index);
+	}
+}
+
+
+void UNPickupAnimationSubsystem::SetAnimationSignificance(AActor* Owner, bool bEnabled, float UpdateInterval)
+{
+	if (const int32* Index = AnimationIndices.Find(Owner))
+	{
+		FNPickupAnimation& Animation = Animations[*Index];
+		Animation.bEnabled = bEnabled;
+		Animation.UpdateInterval = UpdateInterval;
+		Animation.NextUpdateTime = 0.f;
+	}
+}
+
+
+void UNPickupAnimationSubsystem::GatherViewLocations()
+{
+	ViewLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			ViewLocations.Add(Location);
+		}
+	}
+}
+
+
+bool UNPickupAnimationSubsystem::IsVisible(const AActor* Owner, float CullDistanceSquared) const
+{
+	if (!Owner->WasRecentlyRendered(VisibleRenderTime))
+	{
+		return false;
+	}
+
+	const FVector Location = Owner->GetActorLocation();
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		if (FVector::DistSquared(Location, ViewLocation) < CullDistanceSquared)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void UNPickupAnimationSubsystem::Evaluate(const FNPickupAnimation& Animation, float Time)
+{
+	const float AnimationTime = Time + Animation.Phase;
+
+	FVector Location = Animation.InitialOffset;
+	if (Animation.BobbingCurve && Animation.BobbingCurveLength > 0.f)
+	{
+		const float Value = Animation.BobbingCurve->GetFloatValue(FMath::Fmod(AnimationTime, Animation.BobbingCurveLength));
+		Location.Z += Value * Animation.BobbingHeight;
+	}
+
+	const FRotator Rotation = Animation.InitialRotation + (Animation.RotationSpeed * AnimationTime).GetNormalized();
+
+	Animation.AnimationRoot->SetRelativeLocationAndRotation(Location, Rotation);
+}
+
+
+void UNPickupAnimationSubsystem::RemoveAnimationAt(int32 Index)
+{
+	AnimationIndices.Remove(Animations[Index].Owner);
+	Animations.RemoveAtSwap(Index);
+
+	// Fix the index of the animation swapped in
+	if (Index < Animations.Num())
+	{
+		AnimationIndices.Add(Animations[Index].Owner, Index);
+	}
+
+	DEC_DWORD_STAT(STAT_NPickupAnimations);
+}
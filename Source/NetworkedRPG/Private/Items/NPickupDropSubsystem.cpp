@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/NPickupDropSubsystem.h"
+#include "Items/Actors/NPickupActor.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickup Drops"), STAT_NPickupDrops, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Drops Merged"), STAT_NPickupDropsMerged, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Drops Evicted"), STAT_NPickupDropsEvicted, STATGROUP_NRPG);
+
+static float PickupAreaSize = 1000.f;
+FAutoConsoleVariableRef CVarPickupAreaSize(
+	TEXT("NRPG.Pickup.AreaSize"),
+	PickupAreaSize,
+	TEXT("Size of the areas dropped pickups are capped in. Takes effect for drops registered after the change."),
+	ECVF_Default
+	);
+
+static float PickupMergeDistance = 150.f;
+FAutoConsoleVariableRef CVarPickupMergeDistance(
+	TEXT("NRPG.Pickup.MergeDistance"),
+	PickupMergeDistance,
+	TEXT("Drops of the same item closer than this merge into one. Limited to NRPG.Pickup.AreaSize."),
+	ECVF_Default
+	);
+
+static int32 PickupMaxPerArea = 24;
+FAutoConsoleVariableRef CVarPickupMaxPerArea(
+	TEXT("NRPG.Pickup.MaxPerArea"),
+	PickupMaxPerArea,
+	TEXT("Max dropped pickups in an area, the oldest over the cap are merged or destroyed. 0 for no limit."),
+	ECVF_Default
+	);
+
+static int32 DebugPickupDropSubsystem = 0;
+FAutoConsoleVariableRef CVarDebugPickupDropSubsystem(
+	TEXT("NRPG.Debug.PickupDropSubsystem"),
+	DebugPickupDropSubsystem,
+	TEXT("Print pickup merges and evictions: 0 - Off, 1 - On"),
+	ECVF_Cheat
+	);
+
+
+void UNPickupDropSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_NPickupDrops, DropAreas.Num());
+	AreaDrops.Empty();
+	DropAreas.Empty();
+
+	Super::Deinitialize();
+}
+
+
+UNPickupDropSubsystem* UNPickupDropSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UNPickupDropSubsystem>() : nullptr;
+}
+
+
+bool UNPickupDropSubsystem::MergeDrop(UNItem* ItemData, int32 ItemLevel, int32 Count, const FVector& Location)
+{
+	ANPickupActor* Target = FindMergeTarget(ItemData, ItemLevel, Location, nullptr);
+	if (!Target)
+	{
+		return false;
+	}
+
+	if (DebugPickupDropSubsystem)
+	{
+		Print(GetWorld(), FString::Printf(TEXT("%s %d merged into %s."), *FString(__FUNCTION__), Count, *Target->GetName()));
+	}
+
+	Target->AddItemCount(Count);
+	INC_DWORD_STAT(STAT_NPickupDropsMerged);
+	return true;
+}
+
+
+void UNPickupDropSubsystem::RegisterDrop(ANPickupActor* Pickup)
+{
+	if (!Pickup || !Pickup->HasAuthority() || DropAreas.Contains(Pickup))
+	{
+		return;
+	}
+
+	const FIntPoint Area = GetArea(Pickup->GetActorLocation());
+	AddToArea(Pickup, Area);
+	INC_DWORD_STAT(STAT_NPickupDrops);
+
+	EnforceAreaCap(Area);
+}
+
+
+void UNPickupDropSubsystem::UnregisterDrop(ANPickupActor* Pickup)
+{
+	if (DropAreas.Contains(Pickup))
+	{
+		RemoveFromArea(Pickup);
+		DEC_DWORD_STAT(STAT_NPickupDrops);
+	}
+}
+
+
+void UNPickupDropSubsystem::OnDropSettled(ANPickupActor* Pickup)
+{
+	if (!DropAreas.Contains(Pickup))
+	{
+		return;
+	}
+
+	// A drop that rolled into another area counts as the newest there
+	const FIntPoint Area = GetArea(Pickup->GetActorLocation());
+	if (DropAreas[Pickup] != Area)
+	{
+		RemoveFromArea(Pickup);
+		AddToArea(Pickup, Area);
+	}
+
+	if (ANPickupActor* Target = FindMergeTarget(Pickup->GetItemData(), Pickup->GetItemLevel(), Pickup->GetActorLocation(), Pickup))
+	{
+		if (DebugPickupDropSubsystem)
+		{
+			Print(GetWorld(), FString::Printf(TEXT("%s %s merged into %s."), *FString(__FUNCTION__), *Pickup->GetName(), *Target->GetName()));
+		}
+
+		Target->AddItemCount(Pickup->GetItemCount());
+		INC_DWORD_STAT(STAT_NPickupDropsMerged);
+		Pickup->Destroy();
+		return;
+	}
+
+	EnforceAreaCap(Area);
+}
+
+
+ANPickupActor* UNPickupDropSubsystem::FindMergeTarget(const UNItem* ItemData, int32 ItemLevel, const FVector& Location, const ANPickupActor* Ignore) const
+{
+	if (!ItemData)
+	{
+		return nullptr;
+	}
+
+	// Within an area size, so only the neighbouring areas can hold a target
+	const float MergeDistance = FMath::Min(PickupMergeDistance, PickupAreaSize);
+	float NearestDistanceSquared = FMath::Square(MergeDistance);
+	ANPickupActor* Nearest = nullptr;
+
+	const FIntPoint Center = GetArea(Location);
+	for (int32 X = Center.X - 1; X <= Center.X + 1; ++X)
+	{
+		for (int32 Y = Center.Y - 1; Y <= Center.Y + 1; ++Y)
+		{
+			const TArray<TWeakObjectPtr<ANPickupActor>>* Drops = AreaDrops.Find(FIntPoint(X, Y));
+			if (!Drops)
+			{
+				continue;
+			}
+
+			for (const TWeakObjectPtr<ANPickupActor>& Drop : *Drops)
+			{
+				ANPickupActor* Pickup = Drop.Get();
+				if (!Pickup || Pickup == Ignore || Pickup->GetItemData() != ItemData || Pickup->GetItemLevel() != ItemLevel)
+				{
+					continue;
+				}
+
+				const float DistanceSquared = FVector::DistSquared(Location, Pickup->GetActorLocation());
+				if (DistanceSquared < NearestDistanceSquared)
+				{
+					NearestDistanceSquared = DistanceSquared;
+					Nearest = Pickup;
+				}
+			}
+		}
+	}
+
+	return Nearest;
+}
+
+
+void UNPickupDropSubsystem::EnforceAreaCap(const FIntPoint& Area)
+{
+	if (PickupMaxPerArea <= 0)
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<ANPickupActor>>* Drops = AreaDrops.Find(Area);
+	while (Drops && Drops->Num() > PickupMaxPerArea)
+	{
+		ANPickupActor* Oldest = (*Drops)[0].Get();
+		if (!Oldest)
+		{
+			DropAreas.Remove((*Drops)[0]);
+			Drops->RemoveAt(0);
+			DEC_DWORD_STAT(STAT_NPickupDrops);
+			continue;
+		}
+
+		// Prefer keeping the items, in the newest drop of the same kind in the area
+		ANPickupActor* Target = nullptr;
+		for (int32 Index = Drops->Num() - 1; Index > 0; --Index)
+		{
+			ANPickupActor* Pickup = (*Drops)[Index].Get();
+			if (Pickup && Pickup->GetItemData() && Pickup->GetItemData() == Oldest->GetItemData() && Pickup->GetItemLevel() == Oldest->GetItemLevel())
+			{
+				Target = Pickup;
+				break;
+			}
+		}
+
+		if (DebugPickupDropSubsystem)
+		{
+			Print(GetWorld(), FString::Printf(TEXT("%s %s %s."), *FString(__FUNCTION__), *Oldest->GetName(), Target ? TEXT("merged") : TEXT("evicted")));
+		}
+
+		if (Target)
+		{
+			Target->AddItemCount(Oldest->GetItemCount());
+			INC_DWORD_STAT(STAT_NPickupDropsMerged);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_NPickupDropsEvicted);
+		}
+
+		// Removed here rather than from its EndPlay, Drops may be reallocated by then
+		UnregisterDrop(Oldest);
+		Oldest->Destroy();
+		Drops = AreaDrops.Find(Area);
+	}
+}
+
+
+FIntPoint UNPickupDropSubsystem::GetArea(const FVector& Location)
+{
+	const float AreaSize = FMath::Max(PickupAreaSize, 1.f);
+	return FIntPoint(FMath::FloorToInt(Location.X / AreaSize), FMath::FloorToInt(Location.Y / AreaSize));
+}
+
+
+void UNPickupDropSubsystem::AddToArea(ANPickupActor* Pickup, const FIntPoint& Area)
+{
+	AreaDrops.FindOrAdd(Area).Add(Pickup);
+	DropAreas.Add(Pickup, Area);
+}
+
+
+void UNPickupDropSubsystem::RemoveFromArea(ANPickupActor* Pickup)
+{
+	FIntPoint Area;
+	if (!DropAreas.RemoveAndCopyValue(Pickup, Area))
+	{
+		return;
+	}
+
+	if (TArray<TWeakObjectPtr<ANPickupActor>>* Drops = AreaDrops.Find(Area))
+	{
+		// Stable, the order is the age
+		Drops->RemoveSingle(Pickup);
+		if (Drops->Num() == 0)
+		{
+			AreaDrops.Remove(Area);
+		}
+	}
+}
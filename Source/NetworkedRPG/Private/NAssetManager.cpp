@@ -4,6 +4,7 @@
 #include "NAssetManager.h"
 #include "Items/Data/NItem.h"
 #include "AbilitySystemGlobals.h"
+#include "Animation/AnimMontage.h"
 
 const FPrimaryAssetType UNAssetManager::WeaponItemType = TEXT("WeaponItem");
 const FPrimaryAssetType UNAssetManager::ArmourItemType = TEXT("ArmourItem");
@@ -14,6 +15,8 @@ void UNAssetManager::StartInitialLoading()
     Super::StartInitialLoading();
 
     UAbilitySystemGlobals::Get().InitGlobalData();
+
+    LoadReplicatedMontages();
 }
 
 UNAssetManager& UNAssetManager::Get()
@@ -42,3 +45,35 @@ UNItem* UNAssetManager::ForceLoadItem(const FPrimaryAssetId& PrimaryAssetId, boo
 
     return LoadedItem;
 }
+
+void UNAssetManager::LoadReplicatedMontages()
+{
+    LoadedReplicatedMontages.Reset(ReplicatedMontages.Num());
+    MontageRepIds.Reset();
+
+    for (const TSoftObjectPtr<UAnimMontage>& MontagePtr : ReplicatedMontages)
+    {
+        UAnimMontage* Montage = MontagePtr.LoadSynchronous();
+        if (Montage == nullptr)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to load replicated montage %s!"), *MontagePtr.ToString());
+        }
+        else
+        {
+            MontageRepIds.Add(Montage, LoadedReplicatedMontages.Num());
+        }
+
+        LoadedReplicatedMontages.Add(Montage);
+    }
+}
+
+int32 UNAssetManager::GetMontageRepId(const UAnimMontage* Montage) const
+{
+    const int32* MontageRepId = MontageRepIds.Find(Montage);
+    return MontageRepId ? *MontageRepId : INDEX_NONE;
+}
+
+UAnimMontage* UNAssetManager::GetMontageFromRepId(int32 MontageRepId) const
+{
+    return LoadedReplicatedMontages.IsValidIndex(MontageRepId) ? LoadedReplicatedMontages[MontageRepId] : nullptr;
+}
@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NPushModel.h"
+#include "UObject/UnrealType.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+#if !UE_BUILD_SHIPPING
+
+static int32 DebugPushModel = 0;
+FAutoConsoleVariableRef CVarDebugPushModel(
+    TEXT("NRPG.Debug.PushModel"),
+    DebugPushModel,
+    TEXT("Ensure when a replicated property changes without being marked dirty: 0 - Off, 1 - On"),
+    ECVF_Cheat
+    );
+
+namespace NPushModel
+{
+    /** Replicated values of an object at its last validation, and the properties marked dirty since. */
+    struct FShadow
+    {
+        TMap<const FProperty*, uint8*> Values;
+        TSet<FName> MarkedProperties;
+
+        ~FShadow()
+        {
+            for (const auto& Pair : Values)
+            {
+                Pair.Key->DestroyValue(Pair.Value);
+                FMemory::Free(Pair.Value);
+            }
+        }
+    };
+
+    static TMap<TWeakObjectPtr<const UObject>, TUniquePtr<FShadow>> Shadows;
+
+    /** Validations between removing shadows of destroyed objects */
+    static constexpr int32 PruneInterval = 1024;
+    static int32 ValidationsSincePrune = 0;
+
+    static const FName ModulePackageName(TEXT("/Script/NetworkedRPG"));
+
+    /** Only check properties declared in this module, engine and plugin properties are not push based here */
+    static bool IsModuleProperty(const FProperty* Property)
+    {
+        return Property->HasAnyPropertyFlags(CPF_Net) && Property->GetOwnerClass() && Property->GetOwnerClass()->GetOutermost()->GetFName() == ModulePackageName;
+    }
+
+    static bool IsIdentical(const FProperty* Property, const void* A, const void* B);
+
+    /** Compares only what replicates, NotReplicated struct members (generated meshes, owners) can change freely */
+    static bool IsElementIdentical(const FProperty* Property, const void* A, const void* B)
+    {
+        if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+        {
+            for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+            {
+                if (!It->HasAnyPropertyFlags(CPF_RepSkip) && !IsIdentical(*It, It->ContainerPtrToValuePtr<void>(A), It->ContainerPtrToValuePtr<void>(B)))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+        {
+            FScriptArrayHelper HelperA(ArrayProperty, A);
+            FScriptArrayHelper HelperB(ArrayProperty, B);
+            if (HelperA.Num() != HelperB.Num())
+            {
+                return false;
+            }
+
+            for (int32 i = 0; i < HelperA.Num(); ++i)
+            {
+                if (!IsIdentical(ArrayProperty->Inner, HelperA.GetRawPtr(i), HelperB.GetRawPtr(i)))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        return Property->Identical(A, B);
+    }
+
+    static bool IsIdentical(const FProperty* Property, const void* A, const void* B)
+    {
+        for (int32 i = 0; i < Property->ArrayDim; ++i)
+        {
+            const int32 Offset = i * Property->ElementSize;
+            if (!IsElementIdentical(Property, static_cast<const uint8*>(A) + Offset, static_cast<const uint8*>(B) + Offset))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+void NPushModel::NotifyMarkedDirty(const UObject* Object, FName PropertyName)
+{
+    if (!DebugPushModel)
+    {
+        return;
+    }
+
+    // Only recorded for objects already being validated, clients mark too when predicting
+    if (TUniquePtr<FShadow>* Shadow = Shadows.Find(Object))
+    {
+        (*Shadow)->MarkedProperties.Add(PropertyName);
+    }
+}
+
+
+void NPushModel::ValidateProperties(const UObject* Object)
+{
+    if (!DebugPushModel)
+    {
+        if (Shadows.Num() > 0)
+        {
+            Shadows.Empty();
+        }
+
+        return;
+    }
+
+    if (!Object)
+    {
+        return;
+    }
+
+    if (++ValidationsSincePrune >= PruneInterval)
+    {
+        ValidationsSincePrune = 0;
+        for (auto It = Shadows.CreateIterator(); It; ++It)
+        {
+            if (!It.Key().IsValid())
+            {
+                It.RemoveCurrent();
+            }
+        }
+    }
+
+    TUniquePtr<FShadow>& Shadow = Shadows.FindOrAdd(Object);
+    if (!Shadow)
+    {
+        Shadow = MakeUnique<FShadow>();
+    }
+
+    for (TFieldIterator<FProperty> It(Object->GetClass()); It; ++It)
+    {
+        const FProperty* Property = *It;
+        if (!IsModuleProperty(Property))
+        {
+            continue;
+        }
+
+        const void* Current = Property->ContainerPtrToValuePtr<void>(Object);
+
+        uint8*& Value = Shadow->Values.FindOrAdd(Property);
+        if (!Value)
+        {
+            // First time seen, nothing to compare against yet
+            Value = static_cast<uint8*>(FMemory::Malloc(Property->GetSize(), Property->GetMinAlignment()));
+            Property->InitializeValue(Value);
+            Property->CopyCompleteValue(Value, Current);
+            continue;
+        }
+
+        if (IsIdentical(Property, Value, Current))
+        {
+            continue;
+        }
+
+        ensureAlwaysMsgf(Shadow->MarkedProperties.Contains(Property->GetFName()), TEXT("%s %s::%s changed without being marked dirty, add NMARK_PROPERTY_DIRTY where it is set."), *FString(__FUNCTION__), *Object->GetName(), *Property->GetName());
+
+        Property->CopyCompleteValue(Value, Current);
+    }
+
+    Shadow->MarkedProperties.Reset();
+}
+
+#endif
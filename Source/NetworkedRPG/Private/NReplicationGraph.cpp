@@ -0,0 +1,403 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NReplicationGraph.h"
+#include "Characters/NCharacterBase.h"
+#include "Items/Actors/NEquipmentActor.h"
+#include "Items/Actors/NPickupActor.h"
+#include "Items/Actors/NProjectile.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("RepGraph Route Actor"), STAT_NRepGraphRouteActor, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("RepGraph Spatialized Actors"), STAT_NRepGraphSpatializedActors, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("RepGraph Dependent Actors"), STAT_NRepGraphDependentActors, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("RepGraph Owner Only Actors"), STAT_NRepGraphOwnerOnlyActors, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("RepGraph Dormant Actors (Skipped Per Tick)"), STAT_NRepGraphDormantActors, STATGROUP_NRPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RepGraph Dormancy Flushes"), STAT_NRepGraphDormancyFlushes, STATGROUP_NRPG);
+
+static int32 DebugReplicationGraph = 0;
+FAutoConsoleVariableRef CVarDebugReplicationGraph(
+    TEXT("NRPG.Debug.ReplicationGraph"),
+    DebugReplicationGraph,
+    TEXT("Print replication graph routing: 0 - Off, 1 - Actors that could not be routed, 2 - Every routed actor"),
+    ECVF_Cheat
+    );
+
+namespace NRepGraph
+{
+    /** NetUpdateFrequency as a number of replication frames between updates. A frequency of 0, which blueprints can set,
+      * gives the longest period rather than dividing by zero. */
+    static uint32 GetReplicationPeriodFrame(float NetServerMaxTickRate, float NetUpdateFrequency)
+    {
+        const float Frames = NetServerMaxTickRate / FMath::Max(NetUpdateFrequency, KINDA_SMALL_NUMBER);
+        return static_cast<uint32>(FMath::Clamp<float>(FMath::RoundToFloat(Frames), 1.f, MAX_uint16));
+    }
+}
+
+
+UNReplicationGraph::UNReplicationGraph()
+{
+    SpatialGridCellSize = 10000.f;
+    SpatialBiasX = -150000.f;
+    SpatialBiasY = -200000.f;
+    CharacterCullDistance = 15000.f;
+    ProjectileCullDistance = 10000.f;
+    PickupCullDistance = 5000.f;
+    PlayerStatesPerFrame = 10;
+}
+
+
+void UNReplicationGraph::InitGlobalActorClassSettings()
+{
+    Super::InitGlobalActorClassSettings();
+
+    // Explicit routing, applies to subclasses and takes priority over relevancy flags. Characters are bAlwaysRelevant
+    // for the default net driver, here they are culled by the grid instead.
+    ClassRepNodePolicies.Set(ANCharacterBase::StaticClass(), ENClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(ANProjectile::StaticClass(), ENClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(ANPickupActor::StaticClass(), ENClassRepNodeMapping::Spatialize_Dormancy);
+    ClassRepNodePolicies.Set(ANEquipmentActor::StaticClass(), ENClassRepNodeMapping::Dependent);
+    ClassRepNodePolicies.Set(APlayerState::StaticClass(), ENClassRepNodeMapping::NotRouted);
+    ClassRepNodePolicies.Set(APlayerController::StaticClass(), ENClassRepNodeMapping::NotRouted);
+    ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), ENClassRepNodeMapping::NotRouted);
+
+    TArray<UClass*> ReplicatedClasses;
+    for (TObjectIterator<UClass> It; It; ++It)
+    {
+        UClass* Class = *It;
+        const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+        if (!ActorCDO || !ActorCDO->GetIsReplicated())
+        {
+            continue;
+        }
+
+        // Skip blueprint skeleton and reinstanced classes
+        if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+        {
+            continue;
+        }
+
+        ReplicatedClasses.Add(Class);
+
+        if (!ClassRepNodePolicies.Get(Class))
+        {
+            ClassRepNodePolicies.Set(Class, GetDefaultMappingPolicy(ActorCDO));
+        }
+    }
+
+    for (UClass* Class : ReplicatedClasses)
+    {
+        const ENClassRepNodeMapping Mapping = GetMappingPolicy(Class);
+        const bool bSpatialize = Mapping == ENClassRepNodeMapping::Spatialize_Dynamic || Mapping == ENClassRepNodeMapping::Spatialize_Dormancy;
+
+        float CullDistance = FMath::Sqrt(Class->GetDefaultObject<AActor>()->NetCullDistanceSquared);
+        if (Class->IsChildOf(ANCharacterBase::StaticClass()))
+        {
+            CullDistance = CharacterCullDistance;
+        }
+        else if (Class->IsChildOf(ANProjectile::StaticClass()))
+        {
+            CullDistance = ProjectileCullDistance;
+        }
+        else if (Class->IsChildOf(ANPickupActor::StaticClass()))
+        {
+            CullDistance = PickupCullDistance;
+        }
+
+        FClassReplicationInfo ClassInfo;
+        InitClassReplicationInfo(ClassInfo, Class, bSpatialize, CullDistance);
+        GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+    }
+
+    DestructInfoMaxDistanceSquared = FMath::Square(FMath::Max3(CharacterCullDistance, ProjectileCullDistance, PickupCullDistance));
+}
+
+
+void UNReplicationGraph::InitGlobalGraphNodes()
+{
+    GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+    GridNode->CellSize = SpatialGridCellSize;
+    GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+    AddGlobalGraphNode(GridNode);
+
+    AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+    AddGlobalGraphNode(AlwaysRelevantNode);
+
+    // Gathers every PlayerState itself, so PlayerStates are not routed
+    PlayerStateNode = CreateNewNode<UReplicationGraphNode_PlayerStateFrequencyLimiter>();
+    PlayerStateNode->TargetActorsPerFrame = PlayerStatesPerFrame;
+    AddGlobalGraphNode(PlayerStateNode);
+}
+
+
+void UNReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+    Super::InitConnectionGraphNodes(RepGraphConnection);
+
+    UNReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = CreateNewNode<UNReplicationGraphNode_AlwaysRelevant_ForConnection>();
+    AddConnectionGraphNode(OwnerNode, RepGraphConnection);
+    OwnerNodes.Add(RepGraphConnection->NetConnection, OwnerNode);
+}
+
+
+void UNReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+    OwnerNodes.Remove(NetConnection);
+
+    Super::RemoveClientConnection(NetConnection);
+}
+
+
+void UNReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRepGraphRouteActor);
+
+    AActor* Actor = ActorInfo.Actor;
+    const ENClassRepNodeMapping Mapping = GetMappingPolicy(Actor->GetClass());
+
+    if (Actor->NetDormancy > DORM_Awake)
+    {
+        INC_DWORD_STAT(STAT_NRepGraphDormantActors);
+    }
+
+    switch (Mapping)
+    {
+    case ENClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+        break;
+
+    case ENClassRepNodeMapping::RelevantOwnerOnly:
+        if (UNReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = GetOwnerNode(Actor))
+        {
+            OwnerNode->AddOwnerOnlyActor(Actor);
+            INC_DWORD_STAT(STAT_NRepGraphOwnerOnlyActors);
+        }
+        else if (DebugReplicationGraph)
+        {
+            Print(GetWorld(), FString::Printf(TEXT("%s %s has no owning connection, it will not replicate."), *FString(__FUNCTION__), *Actor->GetName()), EPrintType::Warning);
+        }
+        break;
+
+    case ENClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+        INC_DWORD_STAT(STAT_NRepGraphSpatializedActors);
+        break;
+
+    case ENClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+        INC_DWORD_STAT(STAT_NRepGraphSpatializedActors);
+        break;
+
+    case ENClassRepNodeMapping::Dependent:
+        // Must be spawned with its owner set, it is replicated whenever the owner is
+        if (AActor* Parent = Actor->GetOwner())
+        {
+            FGlobalActorReplicationInfo& ParentInfo = GlobalActorReplicationInfoMap.Get(Parent);
+            ParentInfo.DependentActorList.PrepareForWrite();
+            ParentInfo.DependentActorList.ConditionalAdd(Actor);
+            INC_DWORD_STAT(STAT_NRepGraphDependentActors);
+        }
+        else if (DebugReplicationGraph)
+        {
+            Print(GetWorld(), FString::Printf(TEXT("%s %s was spawned without an owner, it will not replicate."), *FString(__FUNCTION__), *Actor->GetName()), EPrintType::Warning);
+        }
+        break;
+
+    default: ;
+    }
+
+    if (DebugReplicationGraph > 1)
+    {
+        Print(GetWorld(), FString::Printf(TEXT("%s %s routed with policy %d."), *FString(__FUNCTION__), *Actor->GetName(), static_cast<int32>(Mapping)), EPrintType::Log);
+    }
+}
+
+
+void UNReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NRepGraphRouteActor);
+
+    AActor* Actor = ActorInfo.Actor;
+
+    if (Actor->NetDormancy > DORM_Awake)
+    {
+        DEC_DWORD_STAT(STAT_NRepGraphDormantActors);
+    }
+
+    switch (GetMappingPolicy(Actor->GetClass()))
+    {
+    case ENClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+        break;
+
+    case ENClassRepNodeMapping::RelevantOwnerOnly:
+        // The connection may already be gone, so check every node
+        for (const TPair<UNetConnection*, UNReplicationGraphNode_AlwaysRelevant_ForConnection*>& Pair : OwnerNodes)
+        {
+            if (Pair.Value->RemoveOwnerOnlyActor(Actor))
+            {
+                DEC_DWORD_STAT(STAT_NRepGraphOwnerOnlyActors);
+                break;
+            }
+        }
+        break;
+
+    case ENClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->RemoveActor_Dynamic(ActorInfo);
+        DEC_DWORD_STAT(STAT_NRepGraphSpatializedActors);
+        break;
+
+    case ENClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->RemoveActor_Dormancy(ActorInfo);
+        DEC_DWORD_STAT(STAT_NRepGraphSpatializedActors);
+        break;
+
+    case ENClassRepNodeMapping::Dependent:
+        if (AActor* Parent = Actor->GetOwner())
+        {
+            if (FGlobalActorReplicationInfo* ParentInfo = GlobalActorReplicationInfoMap.Find(Parent))
+            {
+                if (ParentInfo->DependentActorList.IsValid() && ParentInfo->DependentActorList.RemoveFast(Actor))
+                {
+                    DEC_DWORD_STAT(STAT_NRepGraphDependentActors);
+                }
+            }
+        }
+        break;
+
+    default: ;
+    }
+}
+
+
+void UNReplicationGraph::NotifyActorDormancyChange(AActor* Actor, ENetDormancy OldDormancyState)
+{
+    Super::NotifyActorDormancyChange(Actor, OldDormancyState);
+
+    const bool bWasDormant = OldDormancyState > DORM_Awake;
+    const bool bIsDormant = Actor->NetDormancy > DORM_Awake;
+    if (bIsDormant && !bWasDormant)
+    {
+        INC_DWORD_STAT(STAT_NRepGraphDormantActors);
+    }
+    else if (bWasDormant && !bIsDormant)
+    {
+        DEC_DWORD_STAT(STAT_NRepGraphDormantActors);
+    }
+}
+
+
+void UNReplicationGraph::FlushNetDormancy(AActor* Actor, bool bWasDormInitial)
+{
+    Super::FlushNetDormancy(Actor, bWasDormInitial);
+
+    INC_DWORD_STAT(STAT_NRepGraphDormancyFlushes);
+}
+
+
+void UNReplicationGraph::UpdateActorNetUpdateFrequency(AActor* Actor)
+{
+    UNetDriver* Driver = Actor ? Actor->GetNetDriver() : nullptr;
+    UNReplicationGraph* Graph = Driver ? Driver->GetReplicationDriver<UNReplicationGraph>() : nullptr;
+    if (!Graph)
+    {
+        return;
+    }
+
+    // Only actors already added to the graph, replicated actors are added when they begin play
+    if (FGlobalActorReplicationInfo* GlobalInfo = Graph->GlobalActorReplicationInfoMap.Find(Actor))
+    {
+        GlobalInfo->Settings.ReplicationPeriodFrame = NRepGraph::GetReplicationPeriodFrame(Driver->NetServerMaxTickRate, Actor->NetUpdateFrequency);
+    }
+}
+
+
+ENClassRepNodeMapping UNReplicationGraph::GetMappingPolicy(const UClass* Class) const
+{
+    const ENClassRepNodeMapping* Mapping = ClassRepNodePolicies.Get(Class);
+    return Mapping ? *Mapping : ENClassRepNodeMapping::NotRouted;
+}
+
+
+ENClassRepNodeMapping UNReplicationGraph::GetDefaultMappingPolicy(const AActor* ActorCDO)
+{
+    if (ActorCDO->bOnlyRelevantToOwner)
+    {
+        return ENClassRepNodeMapping::RelevantOwnerOnly;
+    }
+
+    if (ActorCDO->bAlwaysRelevant)
+    {
+        return ENClassRepNodeMapping::RelevantAllConnections;
+    }
+
+    if (ActorCDO->bNetUseOwnerRelevancy)
+    {
+        return ENClassRepNodeMapping::Dependent;
+    }
+
+    return ENClassRepNodeMapping::Spatialize_Dynamic;
+}
+
+
+void UNReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize, float CullDistance) const
+{
+    const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+
+    if (bSpatialize)
+    {
+        Info.SetCullDistanceSquared(FMath::Square(CullDistance));
+    }
+
+    // Keep the class's NetUpdateFrequency, as a number of replication frames between updates
+    Info.ReplicationPeriodFrame = NRepGraph::GetReplicationPeriodFrame(NetDriver->NetServerMaxTickRate, ActorCDO->NetUpdateFrequency);
+}
+
+
+UNReplicationGraphNode_AlwaysRelevant_ForConnection* UNReplicationGraph::GetOwnerNode(const AActor* Actor) const
+{
+    UNetConnection* NetConnection = Actor->GetNetConnection();
+    UNReplicationGraphNode_AlwaysRelevant_ForConnection* const* OwnerNode = NetConnection ? OwnerNodes.Find(NetConnection) : nullptr;
+    return OwnerNode ? *OwnerNode : nullptr;
+}
+
+
+void UNReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+    // Adds the viewers and their view targets
+    Super::GatherActorListsForConnection(Params);
+
+    PlayerStateList.Reset();
+    for (const FNetViewer& Viewer : Params.Viewers)
+    {
+        const APlayerController* PlayerController = Cast<APlayerController>(Viewer.InViewer);
+        if (PlayerController && PlayerController->PlayerState)
+        {
+            PlayerStateList.ConditionalAdd(PlayerController->PlayerState);
+        }
+    }
+
+    Params.OutGatheredReplicationLists.AddReplicationActorList(PlayerStateList);
+
+    if (OwnerOnlyActors.IsValid() && OwnerOnlyActors.Num() > 0)
+    {
+        Params.OutGatheredReplicationLists.AddReplicationActorList(OwnerOnlyActors);
+    }
+}
+
+
+void UNReplicationGraphNode_AlwaysRelevant_ForConnection::AddOwnerOnlyActor(AActor* Actor)
+{
+    OwnerOnlyActors.PrepareForWrite();
+    OwnerOnlyActors.ConditionalAdd(Actor);
+}
+
+
+bool UNReplicationGraphNode_AlwaysRelevant_ForConnection::RemoveOwnerOnlyActor(AActor* Actor)
+{
+    return OwnerOnlyActors.IsValid() && OwnerOnlyActors.RemoveFast(Actor);
+}
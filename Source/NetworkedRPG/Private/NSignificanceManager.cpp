@@ -0,0 +1,346 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NSignificanceManager.h"
+#include "Interface/NSignificanceInterface.h"
+#include "AI/NAICharacter.h"
+#include "Components/AudioComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "DrawDebugHelpers.h"
+#include "EngineUtils.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_NSignificanceUpdate, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Critical"), STAT_NSignificanceCritical, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance High"), STAT_NSignificanceHigh, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Medium"), STAT_NSignificanceMedium, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Low"), STAT_NSignificanceLow, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Culled"), STAT_NSignificanceCulled, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Over Budget"), STAT_NSignificanceOverBudget, STATGROUP_NRPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Changes Per Update"), STAT_NSignificanceChanges, STATGROUP_NRPG);
+
+static int32 DebugSignificance = 0;
+FAutoConsoleVariableRef CVarDebugSignificance(
+    TEXT("NRPG.Debug.Significance"),
+    DebugSignificance,
+    TEXT("Show significance buckets: 0 - Off, 1 - Print bucket changes, 2 - Also draw each actor's bucket"),
+    ECVF_Cheat
+    );
+
+namespace NSignificance
+{
+    static constexpr int32 NumBuckets = static_cast<int32>(ENSignificance::Culled) + 1;
+
+    static const TCHAR* BucketNames[NumBuckets] = { TEXT("Critical"), TEXT("High"), TEXT("Medium"), TEXT("Low"), TEXT("Culled") };
+
+    static const FColor BucketColors[NumBuckets] = { FColor::Red, FColor::Orange, FColor::Yellow, FColor::Green, FColor::Blue };
+
+    /** Added to cosmetic components deactivated by SetCosmeticsActive(), so only those are activated again */
+    static const FName SuspendedTag(TEXT("NRPG.SignificanceSuspended"));
+
+    static bool IsCosmetic(const UActorComponent* Component)
+    {
+        return Component->IsA<UParticleSystemComponent>() || Component->IsA<UAudioComponent>() || Component->IsA<UWidgetComponent>();
+    }
+
+    /** Spawns copies of the first AI character in a square grid around it, to profile a crowd with 'stat NRPG' */
+    static void SpawnCrowd(const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World || World->GetNetMode() == NM_Client)
+        {
+            Print(World, FString::Printf(TEXT("%s Only run on the server."), *FString(__FUNCTION__)), EPrintType::Warning);
+            return;
+        }
+
+        const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+        const float Spacing = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 300.f;
+
+        TActorIterator<ANAICharacter> It(World);
+        if (!It)
+        {
+            Print(World, FString::Printf(TEXT("%s No ANAICharacter in the level to copy."), *FString(__FUNCTION__)), EPrintType::Error);
+            return;
+        }
+
+        const ANAICharacter* Template = *It;
+        const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+
+        FActorSpawnParameters SpawnParameters;
+        SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+        int32 Spawned = 0;
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const FVector Offset((i % Side + 1) * Spacing, (i / Side + 1) * Spacing, 0.f);
+            APawn* Pawn = World->SpawnActor<APawn>(Template->GetClass(), Template->GetActorLocation() + Offset, Template->GetActorRotation(), SpawnParameters);
+            if (Pawn)
+            {
+                if (!Pawn->GetController())
+                {
+                    Pawn->SpawnDefaultController();
+                }
+
+                ++Spawned;
+            }
+        }
+
+        Print(World, FString::Printf(TEXT("%s Spawned %d %s."), *FString(__FUNCTION__), Spawned, *Template->GetClass()->GetName()), EPrintType::Success);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdSpawnSignificanceCrowd(
+    TEXT("NRPG.Significance.SpawnCrowd"),
+    TEXT("Spawns copies of the first AI character in a grid around it, for profiling with 'stat NRPG'. Args: <Count=100> <Spacing=300>"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&NSignificance::SpawnCrowd)
+    );
+
+const FName UNSignificanceManager::CharacterTag(TEXT("Character"));
+const FName UNSignificanceManager::PickupTag(TEXT("Pickup"));
+
+
+UNSignificanceManager::UNSignificanceManager()
+{
+    // MaxDistance, Budget, TickInterval, AnimTickInterval, NetUpdateFrequencyScale, bTickPoseWhenNotRendered, bCosmetics, bTickMesh, bSimplifiedMovement
+    BucketSettings.Emplace(1500.f, 16, 0.f, 0.f, 1.f, true, true, true, false);
+    BucketSettings.Emplace(4000.f, 32, 0.f, 0.033f, 1.f, true, true, true, false);
+    BucketSettings.Emplace(8000.f, 64, 0.1f, 0.066f, 0.5f, false, true, true, false);
+    BucketSettings.Emplace(15000.f, 0, 0.25f, 0.2f, 0.25f, false, false, true, true);
+    BucketSettings.Emplace(MAX_flt, 0, 1.f, 1.f, 0.1f, false, false, false, true);
+
+    UpdateInterval = 0.25f;
+    ViewConeHalfAngle = 60.f;
+    OutOfViewDistanceScale = 2.f;
+    NearDistance = 1000.f;
+
+    TimeSinceUpdate = 0.f;
+    ViewConeCos = 0.5f;
+}
+
+
+UNSignificanceManager* UNSignificanceManager::Get(const UWorld* World)
+{
+    return Cast<UNSignificanceManager>(USignificanceManager::Get(World));
+}
+
+
+void UNSignificanceManager::PostInitProperties()
+{
+    Super::PostInitProperties();
+
+    ViewConeCos = FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle));
+
+    // Config may have fewer entries, buckets past them keep running every frame
+    if (BucketSettings.Num() < NSignificance::NumBuckets)
+    {
+        BucketSettings.SetNum(NSignificance::NumBuckets);
+    }
+}
+
+
+void UNSignificanceManager::Tick(float DeltaTime)
+{
+    TimeSinceUpdate += DeltaTime;
+    if (TimeSinceUpdate < UpdateInterval)
+    {
+        return;
+    }
+
+    TimeSinceUpdate = 0.f;
+
+    GatherViewpoints();
+    Update(GatheredViewpoints);
+}
+
+
+bool UNSignificanceManager::IsTickable() const
+{
+    const UWorld* World = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && World && World->IsGameWorld();
+}
+
+
+TStatId UNSignificanceManager::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNSignificanceManager, STATGROUP_Tickables);
+}
+
+
+void UNSignificanceManager::Update(TArrayView<const FTransform> InViewpoints)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NSignificanceUpdate);
+
+    // Scores every object against the viewpoints, keeping the most significant
+    Super::Update(InViewpoints);
+
+    TArray<const FManagedObjectInfo*> ManagedObjects;
+    GetManagedObjects(ManagedObjects, true);
+
+    int32 CharacterCounts[NSignificance::NumBuckets] = {};
+    int32 PickupCounts[NSignificance::NumBuckets] = {};
+    int32 OverBudget = 0;
+    int32 Changes = 0;
+
+    // Most significant first, so the least significant are the ones over budget
+    for (const FManagedObjectInfo* Info : ManagedObjects)
+    {
+        AActor* Actor = Cast<AActor>(Info->GetObject());
+        INSignificanceInterface* Interface = Cast<INSignificanceInterface>(Actor);
+        if (!Interface)
+        {
+            continue;
+        }
+
+        int32* Counts = Info->GetTag() == CharacterTag ? CharacterCounts : PickupCounts;
+
+        int32 Bucket = static_cast<int32>(GetBucket(Info->GetSignificance()));
+        const int32 UnbudgetedBucket = Bucket;
+        while (Bucket < NSignificance::NumBuckets - 1 && BucketSettings[Bucket].Budget > 0 && Counts[Bucket] >= BucketSettings[Bucket].Budget)
+        {
+            ++Bucket;
+        }
+
+        OverBudget += Bucket != UnbudgetedBucket;
+        ++Counts[Bucket];
+
+        const ENSignificance Significance = static_cast<ENSignificance>(Bucket);
+        ENSignificance& Applied = AppliedSignificance.FindOrAdd(Actor);
+        if (Applied != Significance)
+        {
+            if (DebugSignificance)
+            {
+                Print(GetWorld(), FString::Printf(TEXT("%s %s %s -> %s"), *FString(__FUNCTION__), *Actor->GetName(), NSignificance::BucketNames[static_cast<int32>(Applied)], NSignificance::BucketNames[Bucket]), EPrintType::Log);
+            }
+
+            Applied = Significance;
+            Interface->SetSignificance(Significance, BucketSettings[Bucket]);
+            ++Changes;
+        }
+
+        if (DebugSignificance > 1)
+        {
+            DrawDebugString(GetWorld(), FVector(0.f, 0.f, 120.f), NSignificance::BucketNames[Bucket], Actor, NSignificance::BucketColors[Bucket], UpdateInterval);
+        }
+    }
+
+    SET_DWORD_STAT(STAT_NSignificanceCritical, CharacterCounts[0] + PickupCounts[0]);
+    SET_DWORD_STAT(STAT_NSignificanceHigh, CharacterCounts[1] + PickupCounts[1]);
+    SET_DWORD_STAT(STAT_NSignificanceMedium, CharacterCounts[2] + PickupCounts[2]);
+    SET_DWORD_STAT(STAT_NSignificanceLow, CharacterCounts[3] + PickupCounts[3]);
+    SET_DWORD_STAT(STAT_NSignificanceCulled, CharacterCounts[4] + PickupCounts[4]);
+    SET_DWORD_STAT(STAT_NSignificanceOverBudget, OverBudget);
+    SET_DWORD_STAT(STAT_NSignificanceChanges, Changes);
+}
+
+
+void UNSignificanceManager::RegisterActor(AActor* Actor, FName Tag)
+{
+    if (!Cast<INSignificanceInterface>(Actor))
+    {
+        Print(GetWorld(), FString::Printf(TEXT("%s %s does not implement INSignificanceInterface."), *FString(__FUNCTION__), *GetNameSafe(Actor)), EPrintType::Error);
+        return;
+    }
+
+    RegisterObject(Actor, Tag, [this](FManagedObjectInfo* Info, const FTransform& Viewpoint)
+    {
+        return CalculateSignificance(CastChecked<AActor>(Info->GetObject()), Viewpoint);
+    });
+
+    // Actors start at full rate, which is the Critical bucket
+    AppliedSignificance.Add(Actor, ENSignificance::Critical);
+}
+
+
+void UNSignificanceManager::UnregisterActor(AActor* Actor)
+{
+    if (AppliedSignificance.Remove(Actor) > 0)
+    {
+        UnregisterObject(Actor);
+    }
+}
+
+
+const FNSignificanceSettings& UNSignificanceManager::GetSettings(ENSignificance Significance) const
+{
+    return BucketSettings[static_cast<int32>(Significance)];
+}
+
+
+void UNSignificanceManager::SetCosmeticsActive(AActor* Actor, bool bActive)
+{
+    if (!Actor)
+    {
+        return;
+    }
+
+    TInlineComponentArray<UActorComponent*> Components(Actor);
+    for (UActorComponent* Component : Components)
+    {
+        if (!NSignificance::IsCosmetic(Component))
+        {
+            continue;
+        }
+
+        if (bActive)
+        {
+            if (Component->ComponentTags.Remove(NSignificance::SuspendedTag) > 0)
+            {
+                Component->Activate();
+            }
+        }
+        else if (Component->IsActive())
+        {
+            Component->Deactivate();
+            Component->ComponentTags.AddUnique(NSignificance::SuspendedTag);
+        }
+    }
+}
+
+
+float UNSignificanceManager::CalculateSignificance(const AActor* Actor, const FTransform& Viewpoint) const
+{
+    const FVector ToActor = Actor->GetActorLocation() - Viewpoint.GetLocation();
+    const float Distance = ToActor.Size();
+
+    // Never rendered on a dedicated server, so there only the view cone counts
+    const bool bInView = Distance <= NearDistance
+        || Actor->WasRecentlyRendered(UpdateInterval)
+        || FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToActor) >= ViewConeCos * Distance;
+
+    return -(bInView ? Distance : Distance * OutOfViewDistanceScale);
+}
+
+
+ENSignificance UNSignificanceManager::GetBucket(float Significance) const
+{
+    const float Distance = -Significance;
+    for (int32 Bucket = 0; Bucket < NSignificance::NumBuckets - 1; ++Bucket)
+    {
+        if (Distance <= BucketSettings[Bucket].MaxDistance)
+        {
+            return static_cast<ENSignificance>(Bucket);
+        }
+    }
+
+    return ENSignificance::Culled;
+}
+
+
+void UNSignificanceManager::GatherViewpoints()
+{
+    GatheredViewpoints.Reset();
+
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const APlayerController* PlayerController = It->Get())
+        {
+            FVector Location;
+            FRotator Rotation;
+            PlayerController->GetPlayerViewPoint(Location, Rotation);
+            GatheredViewpoints.Emplace(Rotation, Location);
+        }
+    }
+
+    GatheredViewpoints.Append(ExtraViewpoints);
+}
@@ -5,6 +5,7 @@
 #include "AbilitySystem/NAttributeSetBase.h"
 #include "Characters/NCharacter.h"
 #include "AbilitySystem/NAbilitySystemComponent.h"
+#include "Components/NNetFrequencyComponent.h"
 
 ANPlayerState::ANPlayerState()
 {
@@ -24,11 +25,24 @@ ANPlayerState::ANPlayerState()
     // Net update frequency is low by default for PlayerState Since we are holding the ability system and attributes here, we must set a high value.
     NetUpdateFrequency = 100.0f;
 
+    // Only needs the high value in combat, out of combat attributes change slowly through regen
+    NetFrequencyComponent = CreateDefaultSubobject<UNNetFrequencyComponent>(TEXT("NetFrequencyComponent"));
+    NetFrequencyComponent->IdleNetUpdateFrequency = 10.f;
+    NetFrequencyComponent->CombatNetUpdateFrequency = NetUpdateFrequency;
+
     // Cache tags
     DeadTag = FGameplayTag::RequestGameplayTag(FName("State.Dead"));
 }
 
 
+void ANPlayerState::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    FScopeCycleCounter CycleCounter(NetFrequencyComponent->NotifyPreReplication());
+
+    Super::PreReplication(ChangedPropertyTracker);
+}
+
+
 void ANPlayerState::BeginPlay()
 {
     Super::BeginPlay();
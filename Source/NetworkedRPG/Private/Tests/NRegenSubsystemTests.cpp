@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AbilitySystem/NRegenSubsystem.h"
+#include "AbilitySystem/NAttributeSetBase.h"
+#include "GameplayEffect.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Tests for which startup effects UNRegenSubsystem replaces. Run from the Session Frontend, or with
+ * 'Automation RunTests NetworkedRPG.Regen'.
+ */
+namespace NRegenSubsystemTests
+{
+	static constexpr uint32 TestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter;
+
+	/** A transient effect with a single modifier on Attribute, periodic if Period is above zero. */
+	static UGameplayEffect* MakeEffect(float Period, const FGameplayAttribute& Attribute, const FGameplayEffectModifierMagnitude& Magnitude)
+	{
+		UGameplayEffect* Effect = NewObject<UGameplayEffect>(GetTransientPackage());
+		Effect->DurationPolicy = EGameplayEffectDurationType::Infinite;
+		Effect->Period = FScalableFloat(Period);
+
+		FGameplayModifierInfo& Modifier = Effect->Modifiers.AddDefaulted_GetRef();
+		Modifier.Attribute = Attribute;
+		Modifier.ModifierOp = EGameplayModOp::Additive;
+		Modifier.ModifierMagnitude = Magnitude;
+
+		return Effect;
+	}
+
+	/** A magnitude of the target's RegenRate attribute. */
+	static FGameplayEffectModifierMagnitude RegenRateMagnitude(const FGameplayAttribute& RegenRate)
+	{
+		FAttributeBasedFloat AttributeBased;
+		AttributeBased.BackingAttribute = FGameplayEffectAttributeCaptureDefinition(RegenRate, EGameplayEffectAttributeCaptureSource::Target, false);
+		return FGameplayEffectModifierMagnitude(AttributeBased);
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNRegenIsRegenEffectTest, "NetworkedRPG.Regen.IsRegenEffect", NRegenSubsystemTests::TestFlags)
+
+bool FNRegenIsRegenEffectTest::RunTest(const FString& Parameters)
+{
+	using namespace NRegenSubsystemTests;
+
+	TestTrue(TEXT("Periodic health regen"), UNRegenSubsystem::IsRegenEffect(MakeEffect(1.f, UNAttributeSetBase::GetHealthAttribute(), RegenRateMagnitude(UNAttributeSetBase::GetHealthRegenRateAttribute()))));
+	TestTrue(TEXT("Periodic stamina regen"), UNRegenSubsystem::IsRegenEffect(MakeEffect(0.1f, UNAttributeSetBase::GetStaminaAttribute(), RegenRateMagnitude(UNAttributeSetBase::GetStaminaRegenRateAttribute()))));
+
+	// Must still be applied by AddStartupEffects
+	TestFalse(TEXT("Periodic damage"), UNRegenSubsystem::IsRegenEffect(MakeEffect(1.f, UNAttributeSetBase::GetHealthAttribute(), FGameplayEffectModifierMagnitude(FScalableFloat(-5.f)))));
+	TestFalse(TEXT("Periodic mana buff"), UNRegenSubsystem::IsRegenEffect(MakeEffect(1.f, UNAttributeSetBase::GetManaAttribute(), FGameplayEffectModifierMagnitude(FScalableFloat(5.f)))));
+	TestFalse(TEXT("Periodic effect scaled by another pool's rate"), UNRegenSubsystem::IsRegenEffect(MakeEffect(1.f, UNAttributeSetBase::GetShieldAttribute(), RegenRateMagnitude(UNAttributeSetBase::GetHealthRegenRateAttribute()))));
+	TestFalse(TEXT("Instant regen rate heal"), UNRegenSubsystem::IsRegenEffect(MakeEffect(0.f, UNAttributeSetBase::GetHealthAttribute(), RegenRateMagnitude(UNAttributeSetBase::GetHealthRegenRateAttribute()))));
+	TestFalse(TEXT("Null effect"), UNRegenSubsystem::IsRegenEffect(nullptr));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
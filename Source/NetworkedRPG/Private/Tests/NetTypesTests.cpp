@@ -0,0 +1,378 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NetTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include <limits>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Round trip and bit count tests for the quantizers in NetTypes.h. Run from the Session Frontend, or with
+ * 'Automation RunTests NetworkedRPG.NetTypes'.
+ * Scalar quantizers are checked exhaustively over every packed value, vectors and rotators over a sweep of values.
+ */
+namespace NNetTypesTests
+{
+	static constexpr uint32 TestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter;
+
+	/** Writes Value with Serialize, reads it back into OutValue. Returns the number of bits written, or -1 on a read error. */
+	template<typename TSerialize, typename TValue>
+	static int64 RoundTrip(TSerialize Serialize, TValue Value, TValue& OutValue, bool* bOutSuccess = nullptr)
+	{
+		FBitWriter Writer(0, true);
+		const bool bSuccess = Serialize(Value, Writer);
+		if (bOutSuccess)
+		{
+			*bOutSuccess = bSuccess;
+		}
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		Serialize(OutValue, Reader);
+
+		return Reader.IsError() || !Reader.AtEnd() ? -1 : Writer.GetNumBits();
+	}
+
+	/**
+	 * Every packed value of a scalar quantizer unpacks to a value that packs back to it, serializes in exactly NumBitsUsed
+	 * and reads back unchanged. Values within range come back within half a step.
+	 */
+	template<typename TQuantizer>
+	static void TestScalar(FAutomationTestBase& Test, const TCHAR* Name, float MinValue, float MaxValue)
+	{
+		const uint32 NumCodes = 1u << TQuantizer::NumBitsUsed;
+
+		int32 NumFailed = 0;
+		for (uint32 Packed = 0; Packed < NumCodes && NumFailed < 8; ++Packed)
+		{
+			const float Value = TQuantizer::Unpack(Packed);
+
+			bool bClamped = true;
+			const uint32 Repacked = TQuantizer::Pack(Value, &bClamped);
+
+			float ReadValue = 0.f;
+			const int64 NumBits = RoundTrip(&TQuantizer::Serialize, Value, ReadValue);
+
+			if (Repacked != Packed || bClamped || NumBits != int64(TQuantizer::NumBitsUsed) || ReadValue != Value || TQuantizer::Quantize(Value) != Value)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: packed %u unpacked to %f, repacked to %u (clamped %d), %lld bits, read back %f."),
+					Name, Packed, Value, Repacked, bClamped, NumBits, ReadValue));
+				++NumFailed;
+			}
+		}
+
+		const int32 NumSamples = 10000;
+		for (int32 Sample = 0; Sample <= NumSamples && NumFailed < 8; ++Sample)
+		{
+			const float Value = FMath::Lerp(MinValue, MaxValue, float(Sample) / NumSamples);
+			const float Error = FMath::Abs(TQuantizer::Quantize(Value) - Value);
+			if (Error > TQuantizer::Step * 0.5f + KINDA_SMALL_NUMBER)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: %f quantized with error %f, over half a step (%f)."), Name, Value, Error, TQuantizer::Step * 0.5f));
+				++NumFailed;
+			}
+		}
+	}
+
+	/** Out of range values clamp to the nearest end and report it, NaN packs to a valid value. */
+	template<typename TQuantizer>
+	static void TestClamp(FAutomationTestBase& Test, const TCHAR* Name, float MinValue, float MaxValue)
+	{
+		bool bClamped = false;
+		Test.TestEqual(FString::Printf(TEXT("%s: above range"), Name), TQuantizer::Unpack(TQuantizer::Pack(MaxValue + 100.f, &bClamped)), TQuantizer::Quantize(MaxValue));
+		Test.TestTrue(FString::Printf(TEXT("%s: above range reports clamped"), Name), bClamped);
+
+		bClamped = false;
+		Test.TestEqual(FString::Printf(TEXT("%s: below range"), Name), TQuantizer::Unpack(TQuantizer::Pack(MinValue - 100.f, &bClamped)), TQuantizer::Quantize(MinValue));
+		Test.TestTrue(FString::Printf(TEXT("%s: below range reports clamped"), Name), bClamped);
+
+		float ReadValue = 0.f;
+		bool bSuccess = true;
+		RoundTrip(&TQuantizer::Serialize, MaxValue + 100.f, ReadValue, &bSuccess);
+		Test.TestFalse(FString::Printf(TEXT("%s: Serialize fails when clamping"), Name), bSuccess);
+
+		Test.TestTrue(FString::Printf(TEXT("%s: NaN packs in range"), Name), TQuantizer::Pack(std::numeric_limits<float>::quiet_NaN()) < (1u << TQuantizer::NumBitsUsed));
+	}
+
+	/** Angle between two unit vectors in degrees, through atan2 since acos loses precision for small angles */
+	static float AngleBetween(const FVector& A, const FVector& B)
+	{
+		return FMath::RadiansToDegrees(FMath::Atan2((A ^ B).Size(), A | B));
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesFixedTest, "NetworkedRPG.NetTypes.Fixed", NNetTypesTests::TestFlags)
+
+bool FNetTypesFixedTest::RunTest(const FString& Parameters)
+{
+	using FPlayRate = NNetQuantize::TFixed<1000, 16>;
+	TestEqual(TEXT("TFixed<1000, 16> MaxValue"), FPlayRate::MaxValue, 32.767f);
+	TestEqual(TEXT("TFixed<1000, 16> MinValue"), FPlayRate::MinValue, -32.768f);
+	TestEqual(TEXT("TFixed<1000, 16> represents 0 exactly"), FPlayRate::Quantize(0.f), 0.f);
+	TestEqual(TEXT("TFixed<1000, 16> represents 1 exactly"), FPlayRate::Quantize(1.f), 1.f);
+
+	NNetTypesTests::TestScalar<FPlayRate>(*this, TEXT("TFixed<1000, 16>"), FPlayRate::MinValue, FPlayRate::MaxValue);
+	NNetTypesTests::TestClamp<FPlayRate>(*this, TEXT("TFixed<1000, 16>"), FPlayRate::MinValue, FPlayRate::MaxValue);
+
+	using FSmall = NNetQuantize::TFixed<4, 2>;
+	NNetTypesTests::TestScalar<FSmall>(*this, TEXT("TFixed<4, 2>"), FSmall::MinValue, FSmall::MaxValue);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesUnsignedFixedTest, "NetworkedRPG.NetTypes.UnsignedFixed", NNetTypesTests::TestFlags)
+
+bool FNetTypesUnsignedFixedTest::RunTest(const FString& Parameters)
+{
+	using FPosition = NNetQuantize::TUnsignedFixed<100, 16>;
+	TestEqual(TEXT("TUnsignedFixed<100, 16> MaxValue"), FPosition::MaxValue, 655.35f);
+	NNetTypesTests::TestScalar<FPosition>(*this, TEXT("TUnsignedFixed<100, 16>"), 0.f, FPosition::MaxValue);
+	NNetTypesTests::TestClamp<FPosition>(*this, TEXT("TUnsignedFixed<100, 16>"), 0.f, FPosition::MaxValue);
+
+	using FBlendTime = NNetQuantize::TUnsignedFixed<1000, 16>;
+	NNetTypesTests::TestScalar<FBlendTime>(*this, TEXT("TUnsignedFixed<1000, 16>"), 0.f, FBlendTime::MaxValue);
+	NNetTypesTests::TestClamp<FBlendTime>(*this, TEXT("TUnsignedFixed<1000, 16>"), 0.f, FBlendTime::MaxValue);
+
+	using FBit = NNetQuantize::TUnsignedFixed<1, 1>;
+	NNetTypesTests::TestScalar<FBit>(*this, TEXT("TUnsignedFixed<1, 1>"), 0.f, FBit::MaxValue);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesRangeTest, "NetworkedRPG.NetTypes.Range", NNetTypesTests::TestFlags)
+
+bool FNetTypesRangeTest::RunTest(const FString& Parameters)
+{
+	using FComponent = NNetQuantize::TRange<-1, 1, 10>;
+	TestEqual(TEXT("TRange<-1, 1, 10> represents -1 exactly"), FComponent::Quantize(-1.f), -1.f);
+	TestEqual(TEXT("TRange<-1, 1, 10> represents 1 exactly"), FComponent::Quantize(1.f), 1.f);
+	NNetTypesTests::TestScalar<FComponent>(*this, TEXT("TRange<-1, 1, 10>"), -1.f, 1.f);
+	NNetTypesTests::TestClamp<FComponent>(*this, TEXT("TRange<-1, 1, 10>"), -1.f, 1.f);
+
+	using FPercent = NNetQuantize::TRange<0, 100, 7>;
+	NNetTypesTests::TestScalar<FPercent>(*this, TEXT("TRange<0, 100, 7>"), 0.f, 100.f);
+	NNetTypesTests::TestClamp<FPercent>(*this, TEXT("TRange<0, 100, 7>"), 0.f, 100.f);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesAngleTest, "NetworkedRPG.NetTypes.Angle", NNetTypesTests::TestFlags)
+
+bool FNetTypesAngleTest::RunTest(const FString& Parameters)
+{
+	using FAngle = NNetQuantize::TAngle<12>;
+	NNetTypesTests::TestScalar<FAngle>(*this, TEXT("TAngle<12>"), -180.f + FAngle::Step, 180.f);
+
+	// Wraps instead of clamping, compare the angle between rather than the values
+	for (float Angle = -720.f; Angle <= 720.f; Angle += 0.37f)
+	{
+		bool bClamped = true;
+		const float Quantized = FAngle::Unpack(FAngle::Pack(Angle, &bClamped));
+		const float Error = FMath::Abs(FMath::FindDeltaAngleDegrees(Angle, Quantized));
+		if (bClamped || Error > FAngle::Step * 0.5f + KINDA_SMALL_NUMBER || Quantized <= -180.f || Quantized > 180.f)
+		{
+			AddError(FString::Printf(TEXT("TAngle<12>: %f wrapped to %f, error %f, clamped %d."), Angle, Quantized, Error, bClamped));
+			break;
+		}
+	}
+
+	TestEqual(TEXT("TAngle<12> wraps 360 to 0"), FAngle::Quantize(360.f), 0.f);
+	TestEqual(TEXT("TAngle<12> wraps -180 to 180"), FAngle::Quantize(-180.f), 180.f);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesVectorTest, "NetworkedRPG.NetTypes.Vector", NNetTypesTests::TestFlags)
+
+bool FNetTypesVectorTest::RunTest(const FString& Parameters)
+{
+	using FVector2DQuantizer = NNetQuantize::TVector2D<NNetQuantize::TAngle<12>>;
+	using FVectorQuantizer = NNetQuantize::TVector<NNetQuantize::TFixed<10, 20>>;
+	TestTrue(TEXT("TVector2D<TAngle<12>> bits"), FVector2DQuantizer::NumBitsUsed == 24);
+	TestTrue(TEXT("TVector<TFixed<10, 20>> bits"), FVectorQuantizer::NumBitsUsed == 60);
+
+	for (int32 Sample = 0; Sample < 1000; ++Sample)
+	{
+		const float Alpha = Sample / 1000.f;
+		const FVector2D Value2D(FMath::Lerp(-180.f, 179.f, Alpha), FMath::Lerp(90.f, -90.f, Alpha));
+		const FVector Value(FMath::Lerp(-50000.f, 50000.f, Alpha), FMath::Lerp(1000.f, -1000.f, Alpha), Alpha * 0.05f);
+
+		FVector2D Read2D;
+		const int64 NumBits2D = NNetTypesTests::RoundTrip(&FVector2DQuantizer::Serialize, Value2D, Read2D);
+
+		FVector Read;
+		const int64 NumBits = NNetTypesTests::RoundTrip(&FVectorQuantizer::Serialize, Value, Read);
+
+		// Half a step, plus float spacing at 50000
+		if (NumBits2D != int64(FVector2DQuantizer::NumBitsUsed) || Read2D != FVector2DQuantizer::Quantize(Value2D)
+			|| NumBits != int64(FVectorQuantizer::NumBitsUsed) || Read != FVectorQuantizer::Quantize(Value)
+			|| !Read.Equals(Value, 0.06f))
+		{
+			AddError(FString::Printf(TEXT("Vector round trip: %s (%lld bits) read %s, %s (%lld bits) read %s."),
+				*Value2D.ToString(), NumBits2D, *Read2D.ToString(), *Value.ToString(), NumBits, *Read.ToString()));
+			break;
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesRotatorTest, "NetworkedRPG.NetTypes.Rotator", NNetTypesTests::TestFlags)
+
+bool FNetTypesRotatorTest::RunTest(const FString& Parameters)
+{
+	using FRotatorQuantizer = NNetQuantize::TRotator<16>;
+	using FNoRollQuantizer = NNetQuantize::TRotator<16, false>;
+	TestTrue(TEXT("TRotator<16> bits"), FRotatorQuantizer::NumBitsUsed == 48);
+	TestTrue(TEXT("TRotator<16, false> bits"), FNoRollQuantizer::NumBitsUsed == 32);
+
+	const float MaxError = NNetQuantize::TAngle<16>::Step * 0.5f + 0.001f;
+	for (int32 Sample = 0; Sample < 1000; ++Sample)
+	{
+		const float Alpha = Sample / 1000.f;
+		const FRotator Value(FMath::Lerp(-89.f, 89.f, Alpha), FMath::Lerp(-540.f, 540.f, Alpha), FMath::Lerp(180.f, -180.f, Alpha));
+
+		FRotator Read;
+		const int64 NumBits = NNetTypesTests::RoundTrip(&FRotatorQuantizer::Serialize, Value, Read);
+
+		FRotator ReadNoRoll(0.f, 0.f, 45.f);
+		const int64 NumBitsNoRoll = NNetTypesTests::RoundTrip(&FNoRollQuantizer::Serialize, Value, ReadNoRoll);
+
+		const FRotator Delta = (Read - Value).GetNormalized();
+		if (NumBits != int64(FRotatorQuantizer::NumBitsUsed) || Read != FRotatorQuantizer::Quantize(Value)
+			|| FMath::Abs(Delta.Pitch) > MaxError || FMath::Abs(Delta.Yaw) > MaxError || FMath::Abs(Delta.Roll) > MaxError
+			|| NumBitsNoRoll != int64(FNoRollQuantizer::NumBitsUsed) || ReadNoRoll != FNoRollQuantizer::Quantize(Value) || ReadNoRoll.Roll != 0.f)
+		{
+			AddError(FString::Printf(TEXT("Rotator round trip: %s read %s (%lld bits), without roll %s (%lld bits)."),
+				*Value.ToString(), *Read.ToString(), NumBits, *ReadNoRoll.ToString(), NumBitsNoRoll));
+			break;
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesUnitVectorTest, "NetworkedRPG.NetTypes.UnitVector", NNetTypesTests::TestFlags)
+
+bool FNetTypesUnitVectorTest::RunTest(const FString& Parameters)
+{
+	using FQuantizer = NNetQuantize::TUnitVector<10>;
+	TestTrue(TEXT("TUnitVector<10> bits"), FQuantizer::NumBitsUsed == 20);
+
+	// Worst case for 10 bits per octahedral component is about 0.23 degrees
+	const float MaxErrorDegrees = 0.25f;
+
+	// Axes and the diagonals with a zero component, the lower hemisphere ones fold through the sign of a zero component
+	const FVector Directions[] = {
+		FVector(1.f, 0.f, 0.f), FVector(-1.f, 0.f, 0.f), FVector(0.f, 1.f, 0.f), FVector(0.f, -1.f, 0.f),
+		FVector(0.f, 0.f, 1.f), FVector(0.f, 0.f, -1.f),
+		FVector(1.f, 0.f, -1.f), FVector(-1.f, 0.f, -1.f), FVector(0.f, 1.f, -1.f), FVector(0.f, -1.f, -1.f),
+		FVector(1.f, 0.f, 1.f), FVector(0.f, -1.f, 1.f), FVector(1.f, 1.f, 0.f), FVector(-1.f, -1.f, 0.f)
+	};
+
+	for (const FVector& Direction : Directions)
+	{
+		const FVector Value = Direction.GetSafeNormal();
+
+		FVector Read;
+		const int64 NumBits = NNetTypesTests::RoundTrip(&FQuantizer::Serialize, Value, Read);
+
+		const float Error = NNetTypesTests::AngleBetween(Value, Read);
+		if (NumBits != int64(FQuantizer::NumBitsUsed) || Read != FQuantizer::Quantize(Value) || Error > MaxErrorDegrees
+			|| !FQuantizer::Decode(FQuantizer::Encode(Value)).Equals(Value, KINDA_SMALL_NUMBER))
+		{
+			AddError(FString::Printf(TEXT("TUnitVector<10>: %s read %s (%lld bits), %f degrees off."), *Value.ToString(), *Read.ToString(), NumBits, Error));
+		}
+	}
+
+	// Whole sphere in 1 degree steps
+	float WorstError = 0.f;
+	for (int32 Polar = 0; Polar <= 180; ++Polar)
+	{
+		for (int32 Azimuth = 0; Azimuth < 360; ++Azimuth)
+		{
+			const FVector Value = FRotator(90.f - Polar, Azimuth, 0.f).Vector();
+
+			FVector Read;
+			const int64 NumBits = NNetTypesTests::RoundTrip(&FQuantizer::Serialize, Value, Read);
+
+			const float Error = NNetTypesTests::AngleBetween(Value, Read);
+			WorstError = FMath::Max(WorstError, Error);
+			if (NumBits != int64(FQuantizer::NumBitsUsed) || Read != FQuantizer::Quantize(Value) || !Read.IsNormalized() || Error > MaxErrorDegrees)
+			{
+				AddError(FString::Printf(TEXT("TUnitVector<10>: %s read %s (%lld bits), %f degrees off."), *Value.ToString(), *Read.ToString(), NumBits, Error));
+				return true;
+			}
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("TUnitVector<10> worst error %f degrees."), WorstError));
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetTypesStructsTest, "NetworkedRPG.NetTypes.Structs", NNetTypesTests::TestFlags)
+
+bool FNetTypesStructsTest::RunTest(const FString& Parameters)
+{
+	const auto NetSerialize = [](auto& Value, FArchive& Ar)
+	{
+		bool bSuccess = false;
+		Value.NetSerialize(Ar, nullptr, bSuccess);
+		return bSuccess;
+	};
+
+	{
+		const FVector2D_NetQuantizeAngles Value(-30.5f, 123.4f);
+		FVector2D_NetQuantizeAngles Read;
+		TestTrue(TEXT("FVector2D_NetQuantizeAngles bits"), NNetTypesTests::RoundTrip(NetSerialize, Value, Read) == int64(FVector2D_NetQuantizeAngles::FQuantizer::NumBitsUsed));
+		TestTrue(TEXT("FVector2D_NetQuantizeAngles value"), FVector2D(Read) == FVector2D_NetQuantizeAngles::FQuantizer::Quantize(Value));
+	}
+
+	{
+		const FVector_NetQuantizeUnitOct Value(FVector(0.f, 0.f, -1.f));
+		FVector_NetQuantizeUnitOct Read;
+		TestTrue(TEXT("FVector_NetQuantizeUnitOct bits"), NNetTypesTests::RoundTrip(NetSerialize, Value, Read) == int64(FVector_NetQuantizeUnitOct::FQuantizer::NumBitsUsed));
+		TestTrue(TEXT("FVector_NetQuantizeUnitOct value"), FVector(Read).Equals(Value, KINDA_SMALL_NUMBER));
+	}
+
+	{
+		const FRotator_NetQuantize Value(FRotator(10.f, -170.f, 5.f));
+		FRotator_NetQuantize Read;
+		TestTrue(TEXT("FRotator_NetQuantize bits"), NNetTypesTests::RoundTrip(NetSerialize, Value, Read) == int64(FRotator_NetQuantize::FQuantizer::NumBitsUsed));
+		TestTrue(TEXT("FRotator_NetQuantize value"), FRotator(Read) == FRotator_NetQuantize::FQuantizer::Quantize(Value));
+	}
+
+	// Variable length, integer components within 8 bits come back exactly
+	for (int32 X = -127; X <= 127; X += 7)
+	{
+		const FVector_NetQuantize2D Value(float(X), float(-X / 2));
+		FVector_NetQuantize2D Read;
+		if (NNetTypesTests::RoundTrip(NetSerialize, Value, Read) < 0 || Read != Value)
+		{
+			AddError(FString::Printf(TEXT("FVector_NetQuantize2D: %s read %s."), *Value.ToString(), *Read.ToString()));
+			break;
+		}
+	}
+
+	{
+		const auto SerializeFixed = [](FVector2D& Value, FArchive& Ar) { return SerializeFixedVector2D<1, 16>(Value, Ar); };
+		const FVector2D Value(0.25f, -0.75f);
+		FVector2D Read;
+		TestTrue(TEXT("SerializeFixedVector2D<1, 16> bits"), NNetTypesTests::RoundTrip(SerializeFixed, Value, Read) == 32);
+		TestTrue(TEXT("SerializeFixedVector2D<1, 16> value"), Read.Equals(Value, 1.f / (1 << 14)));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -6,8 +6,18 @@
 #include "Characters/NCharacterBase.h"
 #include "NAICharacter.generated.h"
 
+struct FOnAttributeChangeData;
+class UAnimMontage;
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
 /**
- * 
+ * AI character, possessed by an ANAIController when placed or spawned. Owns its ability system component and attribute
+ * set rather than sharing a player state's, so the AI can attack with the same gameplay abilities as players.
  */
 UCLASS()
 class NETWORKEDRPG_API ANAICharacter : public ANCharacterBase
@@ -16,12 +26,52 @@ class NETWORKEDRPG_API ANAICharacter : public ANCharacterBase
 
 
 public:
-	// ANAICharacter();
+	explicit ANAICharacter(const FObjectInitializer& ObjectInitializer);
 
 
-	explicit ANAICharacter(const FObjectInitializer& ObjectInitializer);
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	FDelegateHandle HealthChangedDelegateHandle;
 
+	/** bTickMesh of the applied significance bucket */
+	bool bSignificanceTickMesh;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** INSignificanceInterface. On the server also moves AI in buckets with bSimplifiedMovement on the navmesh, and
+	  * stops their mesh in buckets without bTickMesh while idle, see UpdateMeshTick(). Both return to full fidelity
+	  * when a bucket closer to a player is applied. */
+	virtual void SetSignificance(ENSignificance InSignificance, const FNSignificanceSettings& Settings) override;
 
 protected:
+	/** Initializes the ability system. On the server also gives attributes, effects and abilities. */
 	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** [server] Ticks the mesh if the significance bucket has bTickMesh, a montage is playing, or the controller has a
+	  * target. Montage notifies, such as the ones finishing a weapon swap, only fire on a ticking mesh. Called when
+	  * any of them changes. */
+	void UpdateMeshTick();
+
+private:
+	/** [server] Dies when health reaches 0, like ANPlayerState does for players */
+	void HealthChanged(const FOnAttributeChangeData& Data);
+
+	/** [server] Bound to the anim instance, to tick the mesh for the length of each montage */
+	UFUNCTION()
+	void MontageStarted(UAnimMontage* Montage);
+
+	UFUNCTION()
+	void MontageEnded(UAnimMontage* Montage, bool bInterrupted);
 };
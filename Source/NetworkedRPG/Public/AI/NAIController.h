@@ -4,14 +4,129 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "NetworkedRPG/NetworkedRPG.h"
 #include "NAIController.generated.h"
 
+class ANCharacterBase;
+class UPrimitiveComponent;
+struct FNAITarget;
+
+/** A character the controller has seen, kept for MemoryDuration after it was last seen */
+struct FNAIPerceivedCharacter
+{
+	TWeakObjectPtr<ANCharacterBase> Character;
+	TWeakObjectPtr<UPrimitiveComponent> TargetComponent;
+	FVector LastSeenLocation;
+	float LastSeenTime;
+	bool bVisible;
+};
+
+/** Sections
+*	1. Blueprint Settings
+*	2. State
+*	3. Overrides
+*	4. Interface and Methods
+*/
+
 /**
- * 
+ * [server] Controller for ANCharacterBase AI. Decides when UNAIManagerSubsystem gives it a turn, rather than ticking:
+ * picks the nearest hostile character in its perception memory, which UNAIPerceptionSubsystem updates, locks on to it
+ * through the pawn's UNCombatComponent, moves into AttackRange along a path shared through UNAINavigationSubsystem, and
+ * activates the pawn's ability bound to AttackAbilityInputID.
  */
 UCLASS()
 class NETWORKEDRPG_API ANAIController : public AAIController
 {
 	GENERATED_BODY()
-	
+
+public:
+	ANAIController();
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. Blueprint Settings
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+protected:
+	/** Hostile characters within this distance are noticed */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	float SightRadius;
+
+	/** The target is dropped once further than this */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	float LoseTargetRadius;
+
+	/** Seconds a character out of sight is remembered, and still chased */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	float MemoryDuration;
+
+	/** Attacks the target when within this distance, otherwise moves towards it */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	float AttackRange;
+
+	/** Closer to the target than this, finds its own path instead of following a shared one */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	float DirectMoveDistance;
+
+	/** The granted ability with this input id is activated to attack */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|AI")
+	ENAbilityInputID AttackAbilityInputID;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	TWeakObjectPtr<ANCharacterBase> TargetCharacter;
+
+	/** Characters seen within MemoryDuration */
+	TArray<FNAIPerceivedCharacter> PerceivedCharacters;
+
+	/** Shared navigation corridor to the target, the corridor's path last joined, and the agent's own path along it
+	  * being followed */
+	int32 CorridorId;
+	FNavPathSharedPtr SharedPath;
+	FNavPathSharedPtr FollowedPath;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+protected:
+	/** Registers with the AI manager and perception */
+	virtual void OnPossess(APawn* InPawn) override;
+
+	/** Unregisters from the AI manager and perception, and forgets the target */
+	virtual void OnUnPossess() override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 4. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** [server] Called by the AI manager on this controller's turn. Updates the target, then moves or attacks. */
+	void Decide();
+
+	/** [server] Called by AI perception with the characters visible this perception update */
+	void UpdatePerception(const TArray<const FNAITarget*>& VisibleTargets, float Time);
+
+	/** Returns the character being attacked, or nullptr */
+	ANCharacterBase* GetTargetCharacter() const { return TargetCharacter.Get(); }
+
+	float GetSightRadius() const { return SightRadius; }
+
+private:
+	/** Returns the remembered living character nearest to Location, preferring visible ones, or nullptr */
+	const FNAIPerceivedCharacter* FindNearestPerceived(const FVector& Location) const;
+
+	const FNAIPerceivedCharacter* FindPerceived(const ANCharacterBase* Character) const;
+
+	/** Follows the target's shared path from UNAINavigationSubsystem, or finds its own path when close, if sharing
+	  * is off, or if the shared path can't be reached */
+	void MoveToTarget(ANCharacterBase* Target, bool bNewTarget);
+
+	/** Sets the target and locks the pawn's UNCombatComponent on to it. Pass nullptr to stop. */
+	void SetTargetCharacter(ANCharacterBase* InTarget, UPrimitiveComponent* TargetComponent);
+
+	/** Activates the ability bound to AttackAbilityInputID if it isn't already active. Returns true if activated. */
+	bool TryAttack(ANCharacterBase* ControlledCharacter) const;
 };
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "NAIManagerSubsystem.generated.h"
+
+class ANAIController;
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [server] Runs the decisions of every ANAIController from one tick, in place of each controller thinking on its own.
+ *	- Decisions are time sliced round robin: at most NRPG.AI.DecisionsPerFrame agents decide per frame, and the frame
+ *	  stops early once NRPG.AI.DecisionBudgetMs is spent. The next frame continues with the agent after the last one.
+ *	- Agents decide from their perception memory, which UNAIPerceptionSubsystem fills for all of them at once.
+ * 'NRPG.AI.Benchmark' measures the server ms per frame for the agents currently registered, with fake viewpoints and
+ * opposing teams so a headless server does the work of one with players. View the counts with 'stat NRPG'.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNAIManagerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Controllers deciding, in round robin order */
+	TArray<TWeakObjectPtr<ANAIController>> Agents;
+
+	/** Index into Agents of the next agent to decide */
+	int32 NextAgent;
+
+	/** Frames left to measure, and the totals so far, for 'NRPG.AI.Benchmark'. Nothing is measured during the warm up,
+	  * while significance and targets settle. */
+	int32 BenchmarkWarmUpFramesRemaining;
+	int32 BenchmarkFramesRemaining;
+	int32 BenchmarkFrames;
+	double BenchmarkDecisionSeconds;
+	double BenchmarkFrameSeconds;
+
+	/** Perception and navigation tick totals when the measurement started */
+	double BenchmarkStartPerceptionSeconds;
+	double BenchmarkStartNavigationSeconds;
+
+	/** Time of the previous frame's tick, 0 for none */
+	double BenchmarkLastFrameTime;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem */
+	static UNAIManagerSubsystem* Get(const UWorld* World);
+
+	/** [server] Adds the controller to the decision round robin. Call on possession. */
+	void RegisterAgent(ANAIController* Agent);
+
+	/** [server] Removes the controller from the decision round robin */
+	void UnregisterAgent(ANAIController* Agent);
+
+	/** Measures the AI update, decisions, perception and navigation, and the server's game thread time per frame over
+	  * the next frames and prints the averages.
+	  * NumViewpoints significance viewpoints are placed among the agents until the end, as if that many players were
+	  * there. With bOpposingTeams every other agent is moved to the other team, so all of them find targets. */
+	void StartBenchmark(int32 Frames, int32 NumViewpoints, bool bOpposingTeams);
+
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+private:
+	/** Runs the decisions of the next agents in the round robin within the frame budget */
+	void RunDecisions();
+
+	/** Adds a frame to the benchmark, FrameStartTime is this frame's tick time. Prints the results after the last one. */
+	void UpdateBenchmark(double FrameStartTime, double DecisionSeconds);
+
+	/** Returns the total seconds the perception and navigation subsystems have ticked for */
+	double GetPerceptionSeconds() const;
+	double GetNavigationSeconds() const;
+};
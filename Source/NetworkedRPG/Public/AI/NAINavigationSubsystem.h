@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationData.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "NAINavigationSubsystem.generated.h"
+
+class ANAIController;
+
+/** One path to a goal, shared by the agents starting near it */
+struct FNAINavCorridor
+{
+	TWeakObjectPtr<AActor> Goal;
+	TWeakObjectPtr<ANavigationData> NavData;
+
+	/** Cell of the agent that opened the corridor */
+	FIntPoint Cell;
+
+	/** Null until the first path is found */
+	FNavPathSharedPtr Path;
+
+	/** Goal location the path leads to */
+	FVector PathGoalLocation;
+
+	/** World time a path was last looked for, found or not */
+	float PathTime;
+
+	/** True if the last search found no path. The corridor waits NRPG.AI.NavRepathInterval before searching again. */
+	bool bPathFailed;
+
+	/** Sum and count of the locations of the agents asking since the last path, the next path starts at their average */
+	FVector RequestLocationSum;
+	int32 NumRequests;
+
+	/** Location of the first agent asking since the last path. The path starts here instead if the average can't be
+	  * reached from it on the navmesh. */
+	FVector FirstRequestLocation;
+
+	/** World time of the last request, the corridor closes when nobody asks for a while */
+	float LastRequestTime;
+};
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [server] Finds AI paths per goal instead of per agent. Agents chasing the same goal from the same NRPG.AI.NavGroupCellSize
+ * cell, or from within NRPG.AI.NavJoinDistance of a path already leading there, share one corridor, so pathfinding
+ * scales with goals and groups rather than agents.
+ *	- Each agent follows its own copy of the corridor's path from the segment nearest to it, see JoinPath(). The way
+ *	  to that segment is checked on the navmesh.
+ *	- A corridor's path is found again once it is NRPG.AI.NavRepathInterval old and the goal moved further than
+ *	  NRPG.AI.NavRepathDistance, starting from where its agents were on average.
+ *	- At most NRPG.AI.NavPathsPerFrame paths are found per frame, the rest wait in order of age. A corridor whose
+ *	  search failed waits NRPG.AI.NavRepathInterval too, so it can't take the budget from the others every frame.
+ * Agents keep apart with RVO avoidance, see ANAICharacter. View the counts with 'stat NRPG'.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNAINavigationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Open corridors by id */
+	TMap<int32, FNAINavCorridor> Corridors;
+
+	int32 NextCorridorId;
+
+	/** Scratch buffer of the corridors waiting for a path */
+	TArray<int32> PathQueue;
+
+	/** Total seconds spent in Tick, for 'NRPG.AI.Benchmark' */
+	double TickSeconds;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem, or nullptr if NRPG.AI.SharedNavigation is off */
+	static UNAINavigationSubsystem* Get(const UWorld* World);
+
+	/** Returns the total seconds spent in Tick since the subsystem was created */
+	double GetTickSeconds() const { return TickSeconds; }
+
+	/** [server] Returns the shared path for the agent to follow to Goal, or null while the corridor waits for its first
+	  * path. InOutCorridorId is the agent's corridor from the last call, INDEX_NONE for none, and is kept if it still
+	  * fits. */
+	FNavPathSharedPtr RequestPath(const ANAIController* Agent, AActor* Goal, int32& InOutCorridorId);
+
+	/** [server] Returns the agent's own path along the corridor's path: from the agent to the nearest point of the
+	  * shared path, then the rest of it. Null if the agent can't reach the shared path on the navmesh. Call when
+	  * RequestPath() returns a new path. */
+	FNavPathSharedPtr JoinPath(const ANAIController* Agent, int32 CorridorId) const;
+
+private:
+	/** Returns the id of a corridor to Goal the location can share, or INDEX_NONE */
+	int32 FindCorridor(const AActor* Goal, const FVector& Location, const FIntPoint& Cell) const;
+
+	/** Returns true if the location is within the join distance of the corridor's path */
+	static bool IsNearPath(const FNAINavCorridor& Corridor, const FVector& Location);
+
+	/** Closes unused corridors and finds the paths due, within the per frame budget */
+	void UpdateCorridors(float Time);
+
+	/** Finds the corridor's path from its agents' average location, or from its first agent's if the average is off
+	  * the navmesh or behind a wall. Returns false if there was no path. */
+	bool FindPath(FNAINavCorridor& Corridor, float Time);
+
+	static FIntPoint GetCell(const FVector& Location);
+};
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetworkedRPG/NetworkedRPG.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "NAIPerceptionSubsystem.generated.h"
+
+class ANAIController;
+class ANCharacterBase;
+class UPrimitiveComponent;
+
+/** A character AI can perceive, as of the last perception update */
+struct FNAITarget
+{
+	TWeakObjectPtr<ANCharacterBase> Character;
+
+	/** The component UNCombatComponent locks on to */
+	TWeakObjectPtr<UPrimitiveComponent> TargetComponent;
+
+	FVector Location;
+	ENTeam Team;
+	bool bAlive;
+};
+
+/** Last line of sight result between an observer and a target */
+struct FNAISightResult
+{
+	/** World time of the trace, or of the request while it is in flight */
+	float Time;
+	bool bVisible;
+};
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [server] Shared sight for every ANAIController, in place of a perception component per agent tracing each target itself.
+ * Every NRPG.AI.PerceptionInterval it:
+ *	- Puts every registered character in a grid of NRPG.AI.CellSize cells, and gathers the hostile characters within
+ *	  each listener's sight radius from the cells around it.
+ *	- Reuses the line of sight of pairs traced within NRPG.AI.SightCacheLifetime. The rest are traced asynchronously in
+ *	  one batch, capped at NRPG.AI.SightTracesPerUpdate and NRPG.AI.SightTracesPerAgent. Pairs over the budget keep
+ *	  their last result and are traced on a later update, starting from a different listener each update.
+ *	- Publishes the visible characters to each listener's memory, see ANAIController::UpdatePerception().
+ * Trace results arrive the next frame and are published with the following update. View the counts with 'stat NRPG'.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNAIPerceptionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Controllers receiving perception */
+	TArray<TWeakObjectPtr<ANAIController>> Listeners;
+
+	/** Index into Listeners of the first to get trace budget next update */
+	int32 FirstListener;
+
+	/** Characters that can be perceived */
+	TArray<TWeakObjectPtr<ANCharacterBase>> Characters;
+
+	/** Spatial index of Characters, and the indices into IndexedTargets in each cell */
+	TArray<FNAITarget> IndexedTargets;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Line of sight by observer and target, see GetPairKey() */
+	TMap<uint64, FNAISightResult> SightResults;
+
+	/** Pair keys of the traces in flight, indexed by the trace's UserData */
+	TArray<uint64> PendingTraces;
+
+	FTraceDelegate SightTraceDelegate;
+
+	/** World time of the last update, negative to update on the next tick */
+	float UpdateTime;
+
+	/** Scratch buffer of the targets visible to a listener */
+	TArray<const FNAITarget*> VisibleTargets;
+
+	/** Total seconds spent in Tick, for 'NRPG.AI.Benchmark' */
+	double TickSeconds;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem */
+	static UNAIPerceptionSubsystem* Get(const UWorld* World);
+
+	/** [server] Publishes perception to the controller every update. Call on possession. */
+	void RegisterListener(ANAIController* Listener);
+
+	/** [server] Stops publishing to the controller */
+	void UnregisterListener(ANAIController* Listener);
+
+	/** [server] Makes the character perceivable by listeners. Call from BeginPlay. */
+	void RegisterCharacter(ANCharacterBase* Character);
+
+	/** [server] Call from EndPlay of registered characters */
+	void UnregisterCharacter(ANCharacterBase* Character);
+
+	/** Returns the total seconds spent in Tick since the subsystem was created */
+	double GetTickSeconds() const { return TickSeconds; }
+
+private:
+	/** Rebuilds the spatial index from the registered characters */
+	void UpdateIndex();
+
+	/** Gathers the listener's candidates, requests the traces it has budget for, and publishes what it sees */
+	void UpdateListener(ANAIController* Listener, float Time, int32& TracesLeft);
+
+	/** Starts an async line of sight trace between the pair. Returns false if the trace couldn't be started. */
+	bool RequestSightTrace(uint64 PairKey, const FVector& Start, const FVector& End, const AActor* Observer, const AActor* Target);
+
+	/** Receives a batched sight trace the frame after it was requested */
+	void OnSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Forgets pairs not traced for a while, so the cache only holds pairs still in range */
+	void PruneSightResults(float Time);
+
+	static uint64 GetPairKey(const AActor* Observer, const AActor* Target);
+
+	static FIntPoint GetCell(const FVector& Location);
+
+	/** Returns the primitive UNCombatComponent should lock on to for the character */
+	static UPrimitiveComponent* FindTargetComponent(const ANCharacterBase* Character);
+};
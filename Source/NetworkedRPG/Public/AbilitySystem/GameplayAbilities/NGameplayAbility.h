@@ -59,6 +59,10 @@ public:
 
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Settings|Ability")
 	ENAbilityInputID AbilityID;
+
+	/** While active, the owner replicates at its combat rate. See UNNetFrequencyComponent. */
+	UPROPERTY(EditDefaultsOnly, Category = "Settings|Ability")
+	bool bIsCombatAbility;
 	
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Settings|Ability")
@@ -7,13 +7,17 @@
 #include "NGameplayAbility_Sprint.generated.h"
 
 /**
- * 
+ * Sprints until input is released, TagSprintEnd is added, or the movement component runs out of stamina.
+ * Stamina is drained by UNCharacterMovementComponent as part of its predicted moves.
  */
 UCLASS()
 class NETWORKEDRPG_API UNGameplayAbility_Sprint : public UNGameplayAbility
 {
 	GENERATED_BODY()
 
+public:
+	UNGameplayAbility_Sprint();
+
 protected:
 
 	UPROPERTY()
@@ -37,27 +41,13 @@ protected:
 	UPROPERTY()
 	class UAbilityTask_WaitInputRelease* WaitInputReleaseTask;
 	
-	UPROPERTY()
-	class UAbilityTask_WaitDelay* WaitDelayTask;
-	
-	UPROPERTY()
-	class UAbilityTask_NetworkSyncPoint* SyncPoint;
-	
 	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
 		const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
 
-	UFUNCTION()
-	void ProcessCost();
-
 	UFUNCTION()
 	void OnInputReleased(float TimeHeld);
 
-	UFUNCTION()
-	void OnWaitDelayFinish();
-
-	UFUNCTION()
-	void OnSync();
-
+	/** Called when TagSprintEnd is added or the movement component runs out of sprint stamina. */
 	UFUNCTION()
 	void OnSprintEnd();
 
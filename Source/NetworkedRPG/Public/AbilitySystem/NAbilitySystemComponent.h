@@ -4,9 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemComponent.h"
+#include "Engine/NetSerialization.h"
 #include "NAbilitySystemComponent.generated.h"
 
 class USkeletalMeshComponent;
+class UNAbilitySystemComponent;
+struct FNRepAnimMontageForMeshArray;
 
 USTRUCT()
 struct NETWORKEDRPG_API FGameplayAbilityLocalAnimMontageForMesh
@@ -31,11 +34,16 @@ struct NETWORKEDRPG_API FGameplayAbilityLocalAnimMontageForMesh
 
 	UPROPERTY()
 	FGameplayAbilityLocalAnimMontage LocalMontageInfo;
+
+	/** [client] Last replicated PositionRepId that was applied to the montage. */
+	uint8 PositionRepId = 0;
 };
 
 
+/** One element per mesh in FNRepAnimMontageForMeshArray. Only items marked dirty are re-serialized, and clients only
+  * process the meshes whose item was added or changed. */
 USTRUCT()
-struct NETWORKEDRPG_API FGameplayAbilityRepAnimMontageForMesh
+struct NETWORKEDRPG_API FGameplayAbilityRepAnimMontageForMesh : public FFastArraySerializerItem
 {
 	GENERATED_BODY();
 
@@ -52,6 +60,57 @@ struct NETWORKEDRPG_API FGameplayAbilityRepAnimMontageForMesh
 
 	UPROPERTY()
 	FGameplayAbilityRepAnimMontage RepMontageInfo;
+
+	/** Incremented each time the server writes a new Position, so clients only correct against a fresh one. */
+	uint8 PositionRepId = 0;
+
+	/** [server] World time Position was last written, negative forces the next update to send it. */
+	float PositionRepTime = -1.f;
+
+	/** FFastArraySerializer callbacks, forward to the owning ASC for this mesh only. */
+	void PostReplicatedAdd(const FNRepAnimMontageForMeshArray& InArraySerializer);
+	void PostReplicatedChange(const FNRepAnimMontageForMeshArray& InArraySerializer);
+
+	/** Compact encoding: montage by UNAssetManager registry id when it has one, fixed point PlayRate, Position and
+	  * BlendTime, and only the fields that matter for the playing or stopped state. */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameplayAbilityRepAnimMontageForMesh> : public TStructOpsTypeTraitsBase2<FGameplayAbilityRepAnimMontageForMesh>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+
+/** Fast array of replicated montage info, max one element per skeletal mesh on the AvatarActor. */
+USTRUCT()
+struct NETWORKEDRPG_API FNRepAnimMontageForMeshArray : public FFastArraySerializer
+{
+	GENERATED_BODY();
+
+	UPROPERTY()
+	TArray<FGameplayAbilityRepAnimMontageForMesh> Items;
+
+	/** The ASC that owns this array, set on construction. */
+	UNAbilitySystemComponent* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FGameplayAbilityRepAnimMontageForMesh, FNRepAnimMontageForMeshArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FNRepAnimMontageForMeshArray> : public TStructOpsTypeTraitsBase2<FNRepAnimMontageForMeshArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
 };
 
 /** Sections
@@ -69,6 +128,8 @@ class NETWORKEDRPG_API UNAbilitySystemComponent : public UAbilitySystemComponent
 {
 	GENERATED_BODY()
 
+	friend struct FGameplayAbilityRepAnimMontageForMesh;
+
 public:
 	UNAbilitySystemComponent();
 
@@ -81,19 +142,28 @@ public:
 	bool bStartupEffectsApplied = false;
 
 protected:
-	/** Set if montage rep happens while we don't have the animinstance associated with us yet */
-	UPROPERTY()
-	bool bPendingMontageRepForMesh;
-
 	/** Data structure for montages that were instigated locally (everything if server, predictive if client. replicated if simulated proxy)
-	  * Will be max one element per skeletal mesh on the AvatarActor. */
+	  * Keyed by skeletal mesh on the AvatarActor. */
 	UPROPERTY()
-	TArray<FGameplayAbilityLocalAnimMontageForMesh> LocalAnimMontageInfoForMeshes;
+	TMap<USkeletalMeshComponent*, FGameplayAbilityLocalAnimMontageForMesh> LocalAnimMontageInfoForMeshes;
 
 	/** **Replicated** Data structure for replicating montage info to simulated clients
 	  * Will be max one element per skeletal mesh on the AvatarActor. */
-	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedAnimMontageForMesh)
-	TArray<FGameplayAbilityRepAnimMontageForMesh> RepAnimMontageInfoForMeshes;
+	UPROPERTY(Replicated)
+	FNRepAnimMontageForMeshArray RepAnimMontageInfoForMeshes;
+
+	/** [server] Index into RepAnimMontageInfoForMeshes.Items for each mesh. Weak, the ASC outlives the avatars whose
+	  * meshes it animates. Rebuilt when items of a previous avatar are removed. */
+	TMap<TWeakObjectPtr<USkeletalMeshComponent>, int32> RepAnimMontageIndexForMeshes;
+
+	/** [server] Meshes with a replicated montage that is not stopped. Only these are updated in TickComponent, destroyed
+	  * ones are dropped there. */
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> ActiveMontageMeshes;
+
+	/** Ability class to (spec handle, source object) for every spec in ActivatableAbilities. Maintained in OnGiveAbility
+	  * and OnRemoveAbility so lookups by class don't scan every spec. The source object is only compared, never used.
+	  * Iteration order within a class is arbitrary, see FindAbilitySpecHandleForClass(). */
+	TMultiMap<UClass*, TPair<FGameplayAbilitySpecHandle, const UObject*>> AbilitySpecHandlesByClass;
 
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -103,11 +173,17 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool GetShouldTick() const override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	/** Also forgets the montage info of meshes that aren't part of the new avatar */
 	virtual void InitAbilityActorInfo(AActor* InOwnerActor, AActor* InAvatarActor) override;
 	virtual void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
 	
 	/** Turn on RPC batching in ASC. Off by default. */
 	virtual bool ShouldDoServerAbilityRPCBatch() const override { return true; }
+
+protected:
+	/** Keep AbilitySpecHandlesByClass in sync, called on server and clients. */
+	virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
 	
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -121,9 +197,16 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities", Meta = (DisplayName = "GetTagCount", ScriptName = "GetTagCount"))
 	int32 K2_GetTagCount(FGameplayTag TagToCheck) const;
 
+	/** Returns the handle of the spec of the class, and of the source object if given. With several matching specs, returns
+	  * the first in ActivatableAbilities. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
 	FGameplayAbilitySpecHandle FindAbilitySpecHandleForClass(TSubclassOf<UGameplayAbility> AbilityClass, UObject* OptionalSourceObject = nullptr);
 
+	/** Finds a handle for each class in AbilityClasses, in the same order. Handles are invalid for classes that were not found.
+	  * Use for items that grant several abilities at once. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
+	void FindAbilitySpecHandlesForClasses(const TArray<TSubclassOf<UGameplayAbility>>& AbilityClasses, TArray<FGameplayAbilitySpecHandle>& OutHandles, UObject* OptionalSourceObject = nullptr);
+
 	// Exposes AddLooseGameplayTag to Blueprint. This tag is *not* replicated.
 	UFUNCTION(BlueprintCallable, Category = "Abilities", Meta = (DisplayName = "AddLooseGameplayTag"))
 	void K2_AddLooseGameplayTag(const FGameplayTag& GameplayTag, int32 Count = 1);
@@ -231,6 +314,10 @@ protected:
 	/** Finds the existing FGameplayAbilityRepAnimMontageForMesh for the mesh or creates one if it does not exist */
 	FGameplayAbilityRepAnimMontageForMesh& GetGameplayAbilityRepAnimMontageInfoForMesh(USkeletalMeshComponent* InMesh);
 
+	/** Removes the local and replicated montage info of meshes destroyed or not attached to the avatar, so a respawned
+	  * avatar doesn't leave an item behind in RepAnimMontageInfoForMeshes */
+	void RemoveMontageInfoForOtherMeshes(const AActor* InAvatarActor);
+
 	/** Called when a prediction key that played a montage is rejected. */
 	void OnPredictiveMontageRejectedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* PredictiveMontage);
 
@@ -241,9 +328,12 @@ protected:
 	/** Copy over playing flags for duplicate animation data. */
 	void AnimMontage_UpdateForcedPlayFlagsForMesh(FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo);
 
-	UFUNCTION()
+	/** Processes the replicated montage info of every mesh, used when a montage rep arrived before we were ready for it. */
 	virtual void OnRep_ReplicatedAnimMontageForMesh();
 
+	/** Processes the replicated montage info of a single mesh, called when its item is added or changed. */
+	virtual void OnRep_ReplicatedAnimMontageForMesh(FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh);
+
 	/** Returns true if we are ready to handle replicated montage information. */
 	virtual bool IsReadyForReplicatedMontageForMesh();
 
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NRegenSubsystem.generated.h"
+
+class UNAttributeSetBase;
+class UGameplayEffect;
+
+/** Sections
+*	1. Settings
+*	2. State
+*	3. Overrides
+*	4. Interface and Methods
+*/
+
+/**
+ * [server] Drives Health, Mana, Stamina and Shield regeneration for every registered UNAttributeSetBase at a fixed rate,
+ * in place of a periodic regen GameplayEffect per character. Each update gathers the pools into contiguous arrays,
+ * integrates them in a single pass clamped to their Max, and writes back only the attributes that changed.
+ * Owners with State.Dead or State.RegenBlocked do not regenerate.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNRegenSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. Settings
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Number of regenerated pools per attribute set: Health, Mana, Stamina, Shield */
+	static constexpr int32 NumPools = 4;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Static gameplay tags */
+	FGameplayTag DeadTag;
+	FGameplayTag RegenBlockedTag;
+	FGameplayTag MaxStaminaTag;
+
+	/** Registered attribute sets, stale entries are removed during the gather. */
+	TArray<TWeakObjectPtr<UNAttributeSetBase>> AttributeSets;
+
+	/** Pool-major scratch buffers, indexed [Pool * Num + SetIndex]. Kept between updates to avoid reallocating. */
+	TArray<float> CurrentValues;
+	TArray<float> MaxValues;
+	TArray<float> RegenRates;
+	TArray<float> Deltas;
+
+	/** 1 if the set may regenerate this update, 0 if it is dead or regen is blocked. */
+	TArray<float> RegenScales;
+
+	FTimerHandle RegenTimerHandle;
+
+	/** Seconds between updates of the running timer, set when it is started */
+	float RegenInterval;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 4. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** [server] Adds the attribute set to the regen update, starts the update timer if it is not running. */
+	void RegisterAttributeSet(UNAttributeSetBase* AttributeSet);
+
+	/** [server] Removes the attribute set from the regen update. */
+	void UnregisterAttributeSet(UNAttributeSetBase* AttributeSet);
+
+	/** Returns true for periodic effects that modify a regenerated pool by a magnitude based on its regen rate attribute.
+	  * The subsystem replaces these, so they are not applied on top of it, see ANCharacterBase::AddStartupEffects(). */
+	static bool IsRegenEffect(const UGameplayEffect* Effect);
+
+private:
+	/** Runs at NRPG.Regen.UpdatesPerSecond. Gathers, integrates and applies regen for all registered sets. */
+	void RegenTick();
+
+	/** Copies attribute values into the contiguous buffers. Returns the number of valid sets. */
+	int32 GatherAttributes();
+
+	/** Integrates regen over the buffers, writing the clamped change of each pool to Deltas. */
+	void IntegrateRegen(int32 Num, float DeltaTime);
+
+	/** Applies non-zero Deltas to the attribute base values through the owning ASC. */
+	void ApplyDeltas(int32 Num);
+};
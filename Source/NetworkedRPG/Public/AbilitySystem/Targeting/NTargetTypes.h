@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Abilities/GameplayAbilityTargetTypes.h"
+#include "NetTypes.h"
 #include "NTargetTypes.generated.h"
 
 struct FGameplayEventData;
@@ -47,4 +48,38 @@ public:
 
 	/** Uses the passed in event data */
 	virtual void GetTargets(ANCharacterBase* TargetingCharacter, AActor* TargetingActor, FGameplayEventData EventData, TArray<FGameplayAbilityTargetDataHandle>& OutTargetData, TArray<FHitResult>& OutHitResults, TArray<AActor*>& OutActors) const override;
-};
\ No newline at end of file
+};
+
+
+/**
+ * Single target hit produced by ANGATA_Trace. Only replicates the fields read from trace target data: the hit actor,
+ * bBlockingHit, TraceStart, TraceEnd and ImpactPoint as packed vectors, and ImpactNormal as an octahedral unit vector.
+ * Location and Normal are rebuilt from the impact on receipt, which matches a line trace.
+ */
+USTRUCT()
+struct NETWORKEDRPG_API FNGameplayAbilityTargetData_TraceHit : public FGameplayAbilityTargetData_SingleTargetHit
+{
+	GENERATED_BODY()
+
+	FNGameplayAbilityTargetData_TraceHit() {}
+
+	FNGameplayAbilityTargetData_TraceHit(const FHitResult& InHitResult)
+		: FGameplayAbilityTargetData_SingleTargetHit(InHitResult)
+	{}
+
+	virtual UScriptStruct* GetScriptStruct() const override
+	{
+		return FNGameplayAbilityTargetData_TraceHit::StaticStruct();
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FNGameplayAbilityTargetData_TraceHit> : public TStructOpsTypeTraitsBase2<FNGameplayAbilityTargetData_TraceHit>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
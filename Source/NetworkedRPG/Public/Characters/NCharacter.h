@@ -91,6 +91,9 @@ public:
 	// Only called on the Server. Calls before Server's AcknowledgePossession.
 	virtual void PossessedBy(AController* NewController) override;
 
+	// Only called on the Server. Stops the PlayerState's attribute set regenerating while it has no character.
+	virtual void UnPossessed() override;
+
 	// Client only
 	virtual void OnRep_PlayerState() override;
 	virtual void OnRep_Controller() override;
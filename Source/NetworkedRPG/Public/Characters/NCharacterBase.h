@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "AbilitySystemInterface.h"
 #include "Interface/NDamageableInterface.h"
+#include "Interface/NSignificanceInterface.h"
 #include "AbilitySystem/NGameplayAbilityActorInterface.h"
 #include "GameFramework/Character.h"
 #include "NCharacterBase.generated.h"
@@ -16,6 +17,7 @@ class UNAttributeSetBase;
 class UGameplayEffect;
 class UNMovementSystemComponent;
 class UNCombatComponent;
+class UNNetFrequencyComponent;
 class ANCharacterBase;
 class USoundCue;
 class UNGameplayAbility;
@@ -30,7 +32,7 @@ class UNGameplayAbility;
 
 /** Character Base class for a character using the Gameplay Ability System. Subclass this for player characters and AI characters. */
 UCLASS()
-class NETWORKEDRPG_API ANCharacterBase : public ACharacter, public IAbilitySystemInterface, public INGameplayAbilityActorInterface, public INDamageableInterface
+class NETWORKEDRPG_API ANCharacterBase : public ACharacter, public IAbilitySystemInterface, public INGameplayAbilityActorInterface, public INDamageableInterface, public INSignificanceInterface
 {
 	GENERATED_BODY()
 
@@ -71,7 +73,7 @@ protected:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Settings|Abilities")
 	TSubclassOf<UGameplayEffect> DefaultAttributes;
 
-	/* These effects are only applied one time on startup */
+	/* These effects are only applied one time on startup. Periodic regen effects are skipped, UNRegenSubsystem drives regen. */
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Settings|Abilities")
 	TArray<TSubclassOf<UGameplayEffect>> StartupEffects;
 
@@ -87,6 +89,10 @@ protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Settings|Components")
 	UNCombatComponent* CombatComponent;
 
+	/** [server] Raises NetUpdateFrequency in combat */
+	UPROPERTY(VisibleAnywhere, Category="Settings|Components")
+	UNNetFrequencyComponent* NetFrequencyComponent;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// 3. References
@@ -107,6 +113,12 @@ protected:
 	UPROPERTY()
 	UNAttributeSetBase* AttributeSetBase;
 
+	/** Bucket last applied by the significance manager */
+	ENSignificance Significance;
+
+	/** The mesh's tick option when fully significant, restored when back in a bucket that ticks pose */
+	EVisibilityBasedAnimTickOption DefaultVisibilityBasedAnimTickOption;
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// 4. Overrides
@@ -115,6 +127,10 @@ public:
 	/** Replicates MovementSystemComponent */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/** Validates push model dirty marking when 'NRPG.Debug.PushModel' is set, for this and subclass properties.
+	  * Counted per net frequency state in 'stat NRPG'. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	/** IAbilitySystemInterface */
 	virtual UAbilitySystemComponent* GetAbilitySystemComponent() const override;
 
@@ -126,10 +142,17 @@ public:
 	/** INGameplayAbilityActorInterface */
 	virtual USceneComponent* GetTraceStartComponent() const override { return GetMesh(); };
 
+	/** INSignificanceInterface. Locally controlled characters always run at full rate. */
+	virtual void SetSignificance(ENSignificance InSignificance, const FNSignificanceSettings& Settings) override;
+
 protected:
-	/** Called when the game starts or when spawned */
+	/** Called when the game starts or when spawned. Registers with the significance manager, and on the server with AI
+	  * perception so AI can see the character. */
 	virtual void BeginPlay() override;
 
+	/** Unregisters from the significance manager and AI perception */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// 5. Interface and Methods
@@ -147,6 +170,9 @@ public:
 	/** Returns the owner's CombatComponent. */  
 	UNCombatComponent* GetCombatComponent() const { return CombatComponent; }
 
+	/** [server] Changes who can damage the character. Not replicated, only the server checks teams. */
+	void SetTeam(ENTeam InTeam) { Team = InTeam; }
+
 	/** Returns true if health > 0. */
 	UFUNCTION(BlueprintCallable, Category="Character")
 	virtual bool IsAlive() const { return GetHealth() > 0; }
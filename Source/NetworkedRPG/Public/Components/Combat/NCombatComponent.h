@@ -78,6 +78,25 @@ private:
 	TMap<ENHitReaction, UAnimMontage*> DefaultMontages;
 };
 
+/** The server's weapon equipped state for the owning client, and the last equip request it has applied. */
+USTRUCT()
+struct FNWeaponEquipAck
+{
+	GENERATED_USTRUCT_BODY()
+
+	FNWeaponEquipAck():
+		PredictionKey(0),
+		EquippedMask(0)
+	{}
+
+	/** Key of the last request applied, or rejected */
+	UPROPERTY()
+	uint8 PredictionKey;
+
+	/** Bit per WeaponSlots index, set if that weapon is equipped */
+	UPROPERTY()
+	uint8 EquippedMask;
+};
 
 class INCombatComponentInterface;
 class ANWeaponActor;
@@ -179,6 +198,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Settings|Animation")
 	TMap<ENHitReaction, UAnimMontage*> KnockMontages;
 
+	/** [owning client] Min seconds between equip requests to the server. Changes in between are sent as one request with the final state. */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"), Category = "Settings|Weapons")
+	float EquipRequestInterval;
+
+	/** Max unslotted weapon actors kept to slot the next weapon with, instead of spawning. */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"), Category = "Settings|Weapons")
+	int32 MaxPooledWeaponActors;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 2. State 
@@ -209,6 +236,29 @@ private:
 
 	/** Indicates whether there is a weapon change in progress (prevents calling another weapon change mid animation). */
 	bool bActiveWeaponChange;
+
+	/** ** Replicated to owner ** The server's equipped weapons and the last equip request applied, to reconcile predictions with. */
+	UPROPERTY(ReplicatedUsing=OnRep_EquipAck)
+	FNWeaponEquipAck EquipAck;
+
+	/** [owning client] Key of the latest predicted weapon change */
+	uint8 LocalEquipPredictionKey;
+
+	/** [owning client] A predicted weapon change is waiting to be sent */
+	bool bEquipRequestPending;
+
+	/** [owning client] World time the last equip request was sent */
+	float LastEquipRequestTime;
+
+	FTimerHandle EquipRequestTimerHandle;
+
+	/** [server] The weapons the owning client last requested equipped, applied one swap at a time */
+	uint8 RequestedEquippedMask;
+	uint8 RequestedEquipPredictionKey;
+
+	/** Released weapon actors, see AcquireWeaponActor() */
+	UPROPERTY()
+	TArray<ANWeaponActor*> WeaponActorPool;
 	
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -237,10 +287,16 @@ public:
 protected:
 	/** Called when the game starts, calls Initialize(). */ 
 	virtual void BeginPlay() override;
+
+	/** Destroys the pooled weapon actors. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
-	/** Replicates WeaponSlots, ArmourSlots, and ItemSlots. */
+	/** Replicates WeaponSlots, ArmourSlots, and ItemSlots. All push based, see MarkSlotDirty(). */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/** Validates push model dirty marking when 'NRPG.Debug.PushModel' is set. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 5. Interface and Methods
@@ -313,6 +369,9 @@ private:
 	/** Handles updating an item slot if it's state has changed */
 	void UpdateItemSlot(FNEquipmentSlot& ItemSlot, FNEquipmentSlot& OldItemSlot) const;
 
+	/** [server] Marks the slot array holding SlotId dirty for replication. Call after changing a slot. */
+	void MarkSlotDirty(ENItemSlotId SlotId);
+
 
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -355,13 +414,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Weapons")
 	bool IsWeaponHolstered(ENItemSlotId SlotId);
 
-	/** Equips the weapon in the slot matching the input SlotId if there is a weapon slotted. */
+	/** Equips the weapon in the slot matching the input SlotId if there is a weapon slotted.
+	  * Predicted on the owning client, the server is sent the final state of changes made within EquipRequestInterval. */
 	UFUNCTION(BlueprintCallable, Category = "Weapons")
 	void EquipWeapon(ENItemSlotId SlotId);
 
-	/** Holsters the weapon in the slot matching the input SlotId if there is a weapon slotted. */
+	/** Holsters the weapon in the slot matching the input SlotId if there is a weapon slotted. Predicted like EquipWeapon(). */
 	UFUNCTION(BlueprintCallable, Category = "Weapons")
 	void HolsterWeapon(ENItemSlotId SlotId);
+
+	/** Returns a pooled weapon actor of the class, or spawns one if there is none. Must be initialized after. */
+	ANWeaponActor* AcquireWeaponActor(TSubclassOf<ANWeaponActor> WeaponActorClass);
+
+	/** Releases the weapon actor into the pool, or destroys it if the pool is full. */
+	void ReleaseWeaponActor(ANWeaponActor* WeaponActor);
 	
 private:
 	/** [local] Generates the default aiming reticle for ranged weapons. */
@@ -382,9 +448,32 @@ private:
 	UFUNCTION()
 	void OnWeaponStateChange(ENStance InStance);
 
-	/** Callback for OnWeaponSwapping - Adds/Removes ActiveWeaponSwapGameplayTag. Delegate is fired during weapon change animation in ANWeaponActor. */
+	/** Callback for OnWeaponSwapping - Adds/Removes ActiveWeaponSwapGameplayTag. Delegate is fired during weapon change animation in ANWeaponActor.
+	  * When a swap ends, continues applying a requested weapon state on the server, or reconciling on the owning client. */
 	UFUNCTION()
 	void SetActiveWeaponSwap(bool InActiveWeaponSwap);
+
+	/** Returns a bit per WeaponSlots index, set if that weapon is equipped */
+	uint8 GetEquippedWeaponMask() const;
+
+	/** [owning client] Records a locally predicted weapon change, and schedules a request for the final state. */
+	void PredictWeaponChange();
+
+	/** [owning client] Sends the current equipped state with the latest prediction key */
+	void SendWeaponStateRequest();
+
+	/** [server] Starts the next swap towards the requested state. Acknowledges the request once no more swaps can be started. */
+	void ApplyRequestedWeaponState();
+
+	/** [server] Updates the equipped state replicated to the owner */
+	void UpdateEquipAck();
+
+	/** [owning client] Once the server has acknowledged the latest prediction, animates any weapon it disagrees with back to its state. */
+	void ReconcileWeaponState();
+
+	/** Calls ReconcileWeaponState() */
+	UFUNCTION()
+	void OnRep_EquipAck();
 	
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -423,6 +512,9 @@ public:
 
 	/** [local + sever] Removes target lock */
 	void UnLock();
+
+	/** [server] Locks on to TargetToLock for owners without a local player, like AI. Pass nullptr to unlock. */
+	void LockTarget(UPrimitiveComponent* TargetToLock);
 	
 private:
 	
@@ -476,15 +568,10 @@ private:
 	void ServerUnLock_Implementation();
 	bool ServerUnLock_Validate();
 
-	/** Calls HolsterWeapon() */
-	UFUNCTION(Server, Reliable)
-	void ServerHolsterWeapon(ENItemSlotId SlotId);
-	void ServerHolsterWeapon_Implementation(ENItemSlotId SlotId);
-
-	/** Calls EquipWeapon() */
+	/** Requests the final equipped state of the owning client's predicted weapon changes. Calls ApplyRequestedWeaponState(). */
 	UFUNCTION(Server, Reliable)
-	void ServerEquipWeapon(ENItemSlotId SlotId);
-	void ServerEquipWeapon_Implementation(ENItemSlotId SlotId);
+	void ServerSetWeaponsEquipped(uint8 EquippedMask, uint8 PredictionKey);
+	void ServerSetWeaponsEquipped_Implementation(uint8 EquippedMask, uint8 PredictionKey);
 };
 
 
@@ -76,6 +76,9 @@ public:
 	/** Replicates InventoryData. */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/** Validates push model dirty marking when 'NRPG.Debug.PushModel' is set. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 protected:
 	/** Called when component is created */
 	virtual void BeginPlay() override;
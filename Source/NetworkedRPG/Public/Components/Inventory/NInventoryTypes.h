@@ -263,6 +263,9 @@ struct FNWeaponSlot : public FNEquipmentSlot
 
 	/** Returns true if weapon is both slotted and holstered. */
 	bool IsHolstered() const;
+
+	/** [owning client] Keeps the locally predicted equipped state over the replicated one. */
+	void KeepPredictedState(const FNWeaponSlot& PredictedSlot) { bIsEquipped = PredictedSlot.bIsEquipped; }
 	
 	static FNWeaponSlot& NullSlot() { return NullWeaponSlot; }
 
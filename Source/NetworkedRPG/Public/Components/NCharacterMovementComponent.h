@@ -3,11 +3,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "NCharacterMovementComponent.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSprintStaminaDepletedDelegate);
+
 /**
- * 
+ * Character movement with predicted sprinting and aiming. Sprint stamina is drained per simulated move,
+ * on the server against the Stamina attribute and on the owning client against a predicted value. The prediction starts
+ * from the server's Stamina after a processed move, sent with the move acks, minus the drain of the moves since.
+ * The owner's packed UNMovementSystemComponent state is recorded per move. Its rotation mode, the only part the simulation
+ * reads, is sent in the move's flags and replayed with it, the rest is sent alongside the move.
  */
 UCLASS()
 class NETWORKEDRPG_API UNCharacterMovementComponent : public UCharacterMovementComponent
@@ -27,6 +34,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Settings")
 	float AimSpeedMultiplier;
 
+	/** The SprintCost attribute is drained once per this many seconds of moving while sprinting. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Settings")
+	float SprintCostInterval;
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 2.State
@@ -38,6 +49,24 @@ public:
 	/** Aim request Flag */
 	uint8 RequestToStartAiming : 1;
 
+	/** Fires when sprinting is stopped because there is no stamina left. */
+	UPROPERTY(BlueprintAssignable)
+	FOnSprintStaminaDepletedDelegate OnSprintStaminaDepleted;
+
+private:
+	FGameplayTag MaxStaminaTag;
+
+	/** [client] Server Stamina after the move at AckedStaminaTimeStamp, negative until the first arrives */
+	float AckedStamina;
+	float AckedStaminaTimeStamp;
+
+	/** [client] Predicted Stamina at the start of the move being replayed after a correction */
+	float ReplayStamina;
+	bool bReplayingMoves;
+
+	/** [server] Stamina last sent with a good move ack */
+	float LastSentStamina;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 3. Overrides
@@ -48,6 +77,20 @@ public:
 	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
 	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
 
+protected:
+	/** Drains sprint stamina for the move that was just simulated. */
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+
+	/** Restores the current sprint, aim and rotation flags after replaying moves, which apply their own. Replays
+	  * stamina from the server's value at the corrected move. */
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+
+	/** Sends the server's Stamina ahead of a correction, or of a good move ack when it changed. */
+	virtual void SendClientAdjustment() override;
+
+	/** Sends the movement state of NewMove ahead of the ServerMove until the server's replicated state matches it. */
+	virtual void CallServerMove(const FSavedMove_Character* NewMove, const FSavedMove_Character* OldMove) override;
+
 private:
 	class FNSavedMove : public FSavedMove_Character
 	{
@@ -64,6 +107,18 @@ private:
 		/** Aim Flag*/
 		uint8 SavedRequestToStartAiming : 1;
 
+		/** bOrientRotationToMovement, from the RotationMode of the movement state */
+		uint8 SavedOrientRotationToMovement : 1;
+
+		/** Packed UNMovementSystemComponent state when the move was made */
+		uint8 SavedMovementState;
+
+		/** Stamina drained by this move, used for the client's predicted stamina until the move is acknowledged. */
+		float SavedSprintCost;
+
+		/** Predicted stamina before this move, where a replay starts if the server's value for it didn't arrive */
+		float SavedStartStamina;
+
 		////////////////
 		// Overrides
 		////////////////
@@ -81,8 +136,11 @@ private:
 		/** Set up the move before sending it to the server. */
 		virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
 
-		// /** Sets variables on character movement component before making a predictive correction. */
-		// virtual void PrepMoveFor(ACharacter* C) override;
+		/** Records the sprint cost of the move after it is performed or replayed. */
+		virtual void PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode) override;
+
+		/** Records the replayed stamina at the start of the move before it is replayed. */
+		virtual void PrepMoveFor(ACharacter* C) override;
 	};
 
 	class FNNetworkPredictionData_Client : public FNetworkPredictionData_Client_Character
@@ -116,4 +174,32 @@ public:
 	
 	UFUNCTION(BlueprintCallable, Category = "Aim Down Sights")
 	void StopAiming();
-};
+
+	/** Returns the server's Stamina. On the owning client returns the last acknowledged Stamina minus the cost of the
+	  * moves after it, or while replaying, the Stamina at the start of the move being replayed. */
+	float GetPredictedStamina() const;
+
+private:
+	/** Returns the owner's MovementSystemComponent, if it has one. */
+	class UNMovementSystemComponent* GetMovementSystemComponent() const;
+
+	/** Returns the stamina cost of a move of DeltaSeconds with the current sprint, acceleration and movement mode. */
+	float GetSprintCostForMove(float DeltaSeconds) const;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 5. Server RPC's
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Applies the owner's packed movement state for the move at TimeStamp. Unreliable, the owner keeps resending
+	  * a changed state with its moves until it is replicated back. States older than the last processed move are dropped. */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerSetMovementState(float TimeStamp, uint8 InMovementState);
+	void ServerSetMovementState_Implementation(float TimeStamp, uint8 InMovementState);
+	bool ServerSetMovementState_Validate(float TimeStamp, uint8 InMovementState);
+
+	/** The server's Stamina after the move at TimeStamp. Unreliable, sent ahead of the move ack or correction. */
+	UFUNCTION(Client, Unreliable)
+	void ClientAckStamina(float TimeStamp, float Stamina);
+	void ClientAckStamina_Implementation(float TimeStamp, float Stamina);
+};
\ No newline at end of file
@@ -11,6 +11,7 @@
 int32 DebugInteractionComponent = 0;
 
 class UWidgetComponent;
+class USphereComponent;
 
 /** Sections
 *	1. Blueprint Settings
@@ -22,8 +23,16 @@ class UWidgetComponent;
 
 /**
  * Interaction component displays a visual cue (InteractableIndicatorWidgetClass) when an object can be interacted with.
- * Any object we wish to interact with must must have Collision Response -> TraceResponse -> Interactable (ECC_Interactable) set to Block,
- * and implement INInteractableInterface. Actual interaction only happens on the server.
+ * Any object we wish to interact with must have Collision Response -> Object Response -> Interaction (ECC_Interaction)
+ * set to Overlap, and implement INInteractableInterface. Actual interaction only happens on the server.
+ *
+ * Locally, a sphere of InteractionRadius keeps the set of interactables in reach from overlap events, so nothing runs
+ * while none are near. While there are candidates they are ranked every CandidateUpdateRate by how close they are to
+ * the owner's facing direction and distance, and only the best ranked is traced to check it is not occluded.
+ *
+ * Clients send the selected interactable with the request, the server checks it is in reach and not occluded.
+ * Requests carry a sequence number, duplicated and stale packets and repeats on the same interactable within
+ * InteractRequestInterval are dropped, so an interactable is not processed twice for one press.
  */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class NETWORKEDRPG_API UNInteractionComponent : public UActorComponent
@@ -39,13 +48,25 @@ public:
 	/// 1. Blueprint Settings
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 protected:
-	/** The rate of line traces */
+	/** Seconds between ranking the candidates, only while there are any in reach */
 	UPROPERTY(EditAnywhere, Category = "InteractionComponent")
-	float LineTraceTickRate;
+	float CandidateUpdateRate;
 
-	/** How far the line trace goes in detecting interactable objects */
+	/** How far from the owner interactable objects are detected */
 	UPROPERTY(EditAnywhere, Category = "InteractionComponent")
-	float LineTraceDistance;
+	float InteractionRadius;
+
+	/** Largest angle from the owner's facing direction an interactable can be selected at */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "180.0", UIMin = "0.0", UIMax = "180.0"), Category = "InteractionComponent")
+	float MaxInteractionAngle;
+
+	/** Seconds before another request on the same interactable is sent, or processed on the server */
+	UPROPERTY(EditAnywhere, Category = "InteractionComponent|Server")
+	float InteractRequestInterval;
+
+	/** Extra distance accepted on the server, for latency and the interactable's extent */
+	UPROPERTY(EditAnywhere, Category = "InteractionComponent|Server")
+	float ValidationTolerance;
 	
 	/** Sets the duration over which the indicator widget is animated in */
 	UPROPERTY(EditAnywhere, Category = "InteractionComponent|IndicatorWidget")
@@ -75,7 +96,26 @@ private:
 	UWidgetComponent* InteractableIndicatorWidgetComponent;
 	FTimeline IndicatorAnimationTimeline;
 	FVector IndicatorOffset;
-	FTimerHandle InteractableTraceTickTimerHandle;
+	FTimerHandle CandidateUpdateTimerHandle;
+
+	/** [local] Sphere of InteractionRadius, overlaps interactables in reach. Created in Initialize(). */
+	UPROPERTY()
+	USphereComponent* ReachSphere;
+
+	/** [local] Interactables overlapping ReachSphere */
+	UPROPERTY()
+	TArray<AActor*> Candidates;
+
+	/** [local] Sequence of the last request sent */
+	uint8 LocalInteractSequence;
+
+	/** [server] Sequence of the last request received */
+	uint8 LastInteractSequence;
+	bool bHasInteractSequence;
+
+	/** [local + server] Last interactable requested, and when */
+	TWeakObjectPtr<AActor> LastInteracted;
+	float LastInteractTime;
 
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -95,19 +135,42 @@ protected:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 public:	
 
-	/** [local] Initiates a line trace on the server, if it hits a valid interactable, calls Interact() on it */
+	/** [local] Requests interaction with the current interactable on the server, which calls Interact() on it if valid */
 	UFUNCTION()
 	void Interact();
 
 private:
-	/** [local] Initializes the InteractionIndicatorWidget, sets up it's animation, and starts Interactable Trace tick */
+	/** [local] Initializes the InteractionIndicatorWidget, sets up it's animation, and creates the ReachSphere */
 	void Initialize();
 
-	/** [local] Runs a line trace for an Interactable object and shows indicator if we hit an Interactable */
-	void InteractableTraceTick();
+	/** [local] Selects the best candidate and shows the indicator on it */
+	void UpdateCurrentInteractable();
+
+	/** [local + server] Returns the best ranked interactable in reach that is not occluded, or nullptr */
+	AActor* SelectInteractable() const;
 
-	/** [local + server] Runs a line trace for an Interactable object */
-	AActor* TraceForInteractable() const;
+	/** [local + server] Gets the interactables in reach, from the ReachSphere locally or an overlap query on the server */
+	void GatherCandidates(TArray<AActor*>& OutCandidates) const;
+
+	/** Returns true if something blocks visibility between the owner and the interactable */
+	bool IsOccluded(const AActor* Interactable) const;
+
+	/** [server] Returns true if the interactable is in reach and not occluded */
+	bool ValidateInteractable(AActor* Interactable) const;
+
+	/** [local + server] Returns true if the interactable was requested within InteractRequestInterval */
+	bool IsRecentlyInteracted(const AActor* Interactable) const;
+
+	/** [server] Calls Interact() on the interactable */
+	void ExecuteInteract(AActor* Interactable);
+
+	/** [local] Adds an interactable entering reach, and starts updating the candidates */
+	UFUNCTION()
+	void OnReachBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	/** [local] Removes an interactable leaving reach, and stops updating once there are none */
+	UFUNCTION()
+	void OnReachEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
 	/** [local] Initiates animation to show or hide the InteractionIndicatorWidget */
 	void SetCurrentInteractable(AActor* Interactable);
@@ -126,9 +189,10 @@ private:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
 	/** [server] Marked Unreliable so it will only work if good networking conditions,
-	*  since this shouldn't be crucial, a failed attempt can just try again. */
+	*  since this shouldn't be crucial, a failed attempt can just try again.
+	*  Sequence increments per request, so duplicated and out of order packets can be dropped. */
 	UFUNCTION(Server, Unreliable, WithValidation)
-	void ServerInteract();
-	void ServerInteract_Implementation();
-	bool ServerInteract_Validate();
+	void ServerInteract(AActor* Interactable, uint8 Sequence);
+	void ServerInteract_Implementation(AActor* Interactable, uint8 Sequence);
+	bool ServerInteract_Validate(AActor* Interactable, uint8 Sequence);
 };
@@ -5,146 +5,10 @@
 #include "CoreMinimal.h"
 #include "NetworkedRPG/NetworkedRPG.h"
 #include "NTypes.h"
+#include "NetTypes.h"
 #include "Components/ActorComponent.h"
 #include "NMovementSystemComponent.generated.h"
 
-// TODO create and move to NetTypes.h
-template<int32 MaxValue, int32 NumBits>
-bool SerializeFixedVector2D(FVector2D &Vector, FArchive& Ar)
-{
-	if (Ar.IsSaving())
-	{
-		bool success = true;
-		success &= WriteFixedCompressedFloat<MaxValue, NumBits>(Vector.X, Ar);
-		success &= WriteFixedCompressedFloat<MaxValue, NumBits>(Vector.Y, Ar);
-		return success;
-	}
-
-	ReadFixedCompressedFloat<MaxValue, NumBits>(Vector.X, Ar);
-	ReadFixedCompressedFloat<MaxValue, NumBits>(Vector.Y, Ar);
-	return true;
-}
-
-template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
-bool WritePackedVector2D(FVector2D Value, FArchive& Ar)	// Note Value is intended to not be a reference since we are scaling it before serializing!
-{
-	check(Ar.IsSaving());
-
-	// Scale vector by quant factor first
-	Value *= ScaleFactor;
-
-	// Nan Check
-	if( Value.ContainsNaN() )
-	{
-		logOrEnsureNanError(TEXT("WritePackedVector: Value contains NaN, clearing for safety."));
-		FVector2D	Dummy(0, 0);
-		WritePackedVector2D<ScaleFactor, MaxBitsPerComponent>(Dummy, Ar);
-		return false;
-	}
-
-	// Some platforms have RoundToInt implementations that essentially reduces the allowed inputs to 2^31.
-	const FVector2D ClampedValue(FMath::Clamp(Value.X, -1073741824.0f, 1073741760.0f), FMath::Clamp(Value.Y, -1073741824.0f, 1073741760.0f));
-	bool bClamp = ClampedValue != Value;
-
-	// Do basically FVector::SerializeCompressed
-	int32 IntX	= FMath::RoundToInt(ClampedValue.X);
-	int32 IntY	= FMath::RoundToInt(ClampedValue.Y);
-			
-	uint32 Bits	= FMath::Clamp<uint32>( FMath::CeilLogTwo( 1 + FMath::Max( FMath::Abs(IntX), FMath::Abs(IntY) ) ), 1, MaxBitsPerComponent ) - 1;
-
-	// Serialize how many bits each component will have
-	Ar.SerializeInt( Bits, MaxBitsPerComponent );
-
-	int32  Bias	= 1<<(Bits+1);
-	uint32 Max	= 1<<(Bits+2);
-	uint32 DX	= IntX + Bias;
-	uint32 DY	= IntY + Bias;
-
-	if (DX >= Max) { bClamp=true; DX = static_cast<int32>(DX) > 0 ? Max-1 : 0; }
-	if (DY >= Max) { bClamp=true; DY = static_cast<int32>(DY) > 0 ? Max-1 : 0; }
-	
-	Ar.SerializeInt( DX, Max );
-	Ar.SerializeInt( DY, Max );
-
-	return !bClamp;
-}
-
-template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
-bool ReadPackedVector2D(FVector2D &Value, FArchive& Ar)
-{
-	uint32 Bits	= 0;
-
-	// Serialize how many bits each component will have
-	Ar.SerializeInt( Bits, MaxBitsPerComponent );
-
-	int32  Bias = 1<<(Bits+1);
-	uint32 Max	= 1<<(Bits+2);
-	uint32 DX	= 0;
-	uint32 DY	= 0;
-	
-	Ar.SerializeInt( DX, Max );
-	Ar.SerializeInt( DY, Max );
-	
-	
-	float fact = (float)ScaleFactor;
-
-	Value.X = (float)(static_cast<int32>(DX)-Bias) / fact;
-	Value.Y = (float)(static_cast<int32>(DY)-Bias) / fact;
-
-	return true;
-}
-
-template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
-bool SerializePackedVector2D(FVector2D &Vector, FArchive& Ar)
-{
-	if (Ar.IsSaving())
-	{
-		return  WritePackedVector2D<ScaleFactor, MaxBitsPerComponent>(Vector, Ar);
-	}
-
-	ReadPackedVector2D<ScaleFactor, MaxBitsPerComponent>(Vector, Ar);
-	return true;
-}
-
-USTRUCT()
-struct FVector_NetQuantize2D : public FVector2D
-{
-	GENERATED_USTRUCT_BODY()
-
-FORCEINLINE FVector_NetQuantize2D()
-	{}
-
-	explicit FORCEINLINE FVector_NetQuantize2D(EForceInit E)
-: FVector2D(E)
-	{}
-
-	FORCEINLINE FVector_NetQuantize2D(float InX, float InY)
-: FVector2D(InX, InY)
-	{}
-
-	FORCEINLINE FVector_NetQuantize2D(const FVector2D &InVec)
-	{
-		FVector2D::operator=(InVec);
-	}
-
-	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
-	{
-		bOutSuccess = SerializePackedVector2D<1, 8>(*this, Ar);
-		return true;
-	}
-};
-
-template<>
-struct TStructOpsTypeTraits< FVector_NetQuantize2D > : public TStructOpsTypeTraitsBase2< FVector_NetQuantize2D >
-{
-	enum 
-	{
-		WithNetSerializer = true,
-WithNetSharedSerialization = true,
-};
-};
-
-
 enum class ENCombatType : unsigned char;
 
 // TODO Remove this delegate and replace with FNotifyDelegate - same functionality
@@ -155,6 +19,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnMovementSystemUpdatedDelegate,
 class UNSpringArmComponent;
 class UNCombatComponent;
 class ACharacter;
+class UCurveFloat;
 
 /** Sections
 *	1. Blueprint Settings
@@ -165,7 +30,6 @@ class ACharacter;
 *		5a. Equipments Slots
 *		5b. Weapons
 *		5c. Targeting
-*	6. Server RPC's
 */
 
 /**
@@ -187,10 +51,6 @@ public:
 	/// 1. Blueprint Settings
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 protected:
-	/** The rate of net updates for aim offset when not targeting */
-	UPROPERTY(EditAnywhere, Category="Settings|Network")
-	float AimOffsetNetUpdatesPerSecond;
-
 	/** Interp speed for transitioning between camera offsets */
 	UPROPERTY(EditAnywhere, Category="Settings|Camera")
 	float CameraSocketOffsetInterpSpeed;
@@ -198,14 +58,59 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Settings|Camera")
 	FCameraModeSettings DefaultCameraModeSettings;
 
+	/** Shortest delay remote aim is rendered behind the newest received sample */
+	UPROPERTY(EditAnywhere, Category="Settings|Network")
+	float AimInterpMinDelay;
+
+	/** Longest delay remote aim is rendered behind the newest received sample, longer gaps are treated as a new stream */
+	UPROPERTY(EditAnywhere, Category="Settings|Network")
+	float AimInterpMaxDelay;
+
+	/** Multiples of the measured arrival jitter added to the arrival interval to get the interpolation delay */
+	UPROPERTY(EditAnywhere, Category="Settings|Network")
+	float AimInterpJitterMultiplier;
+
+	/** How far remote aim is extrapolated past the newest sample before it holds */
+	UPROPERTY(EditAnywhere, Category="Settings|Network")
+	float AimMaxExtrapolationTime;
+
+	/** Optional easing between two remote aim samples, maps alpha [0, 1] to [0, 1]. Linear if not set. */
+	UPROPERTY(EditAnywhere, Category="Settings|Network")
+	UCurveFloat* AimInterpCurve;
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 2. State
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
-	/** Holds replicated version of the owning players camera rotation to be used for aim offset */
-	UPROPERTY(Replicated)
-	FVector_NetQuantize2D QuantizedCameraRotationVector2D;
+	/** Holds replicated version of the owning players camera rotation to be used for aim offset.
+	  * Set on the server from the control rotation each ServerMove carries, see PreReplication(). */
+	UPROPERTY(ReplicatedUsing=OnRep_QuantizedCameraRotationVector2D)
+	FVector2D_NetQuantizeAngles QuantizedCameraRotationVector2D;
+
+	/** A received aim sample. Yaw is unwound against the previous sample so samples can be lerped directly. */
+	struct FAimSample
+	{
+		float Time;
+		float Pitch;
+		float Yaw;
+	};
+
+	/** [remote] Received aim samples, oldest first. Samples older than the one before the render time are dropped. */
+	TArray<FAimSample> AimSamples;
+
+	/** [remote] Smoothed estimates of the time between aim samples and of its variation */
+	float AimArrivalInterval;
+	float AimArrivalJitter;
+
+	/** [remote] Current delay behind the newest sample, adapted from the arrival interval and jitter */
+	float AimInterpDelay;
+
+	/** [remote] Interpolated aim returned by GetCameraForwardRotator() */
+	FRotator SmoothedCameraRotator;
+
+	/** [remote] True while the render time is past the newest sample */
+	bool bAimExtrapolating;
 
 	UPROPERTY(VisibleInstanceOnly, Category="State")
 	ENMovementGait MovementGait;
@@ -213,10 +118,15 @@ private:
 	UPROPERTY(VisibleInstanceOnly, Category="State")
 	ENRotationMode RotationMode;
 
-	UPROPERTY(Replicated, VisibleInstanceOnly, Category="State")
+	UPROPERTY(VisibleInstanceOnly, Category="State")
 	ENStance Stance;
 
-	FTimerHandle NetTickTimerHandle;
+	/** Server's MovementGait, RotationMode, Stance and CombatType packed into one byte, see GetPackedMovementState().
+	  * Set in PreReplication() and applied on simulated proxies. The owner predicts its own state and only uses this
+	  * to know when the server has caught up, see UNCharacterMovementComponent::CallServerMove(). */
+	UPROPERTY(ReplicatedUsing=OnRep_MovementState)
+	uint8 MovementState;
+
 	FVector DesiredCameraSocketOffset;
 	ENCombatType CombatType;
 	FCameraModeSettings CameraModeSettings;
@@ -246,16 +156,17 @@ public:
 	/** Handles Camera offset transitions while tick is active, and draws debug arrows if bDrawDebugArrows is true */
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-	/** Replicate CombatComponent and QuantizedCameraRotationVector2D to other clients */
+	/** Replicate CombatComponent, MovementState and QuantizedCameraRotationVector2D */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** [server] Samples the owners control rotation into QuantizedCameraRotationVector2D and packs the movement
+	  * state into MovementState before each net update */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 	
 protected:
 	/** Overridden to call Initialize() */
 	virtual void BeginPlay() override;
 
-	/** Overridden to remove CombatComponent->OnTargetActorUpdated delegate binding */
-	virtual void BeginDestroy() override;
-
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 5. Interface and Methods
@@ -264,7 +175,7 @@ private:
 	/** Get required references and initialize camera state */
 	void Initialize();
 
-	/** [local] Called in Initialize(), sets combat component locally and on the server and binds OnTargetUpdated callback. */
+	/** [local/server] Called in Initialize(), sets the combat component. */
 	void SetCombatComponent(UNCombatComponent* InCombatComponent);
 
 public:
@@ -308,6 +219,18 @@ public:
 	
 	/** [local] Broadcasts the current MovementGait, RotationMode, CameraMode, and Stance */
 	void BroadcastSystemState() const;
+
+	/** Returns MovementGait, RotationMode, Stance and CombatType packed into one byte. */
+	uint8 GetPackedMovementState() const;
+
+	/** [server/remote] Unpacks and applies a state from GetPackedMovementState(), broadcasts once if anything changed. */
+	void SetPackedMovementState(uint8 InMovementState);
+
+	/** Returns the last MovementState the server replicated. */
+	uint8 GetReplicatedMovementState() const { return MovementState; }
+
+	/** Returns true if every field of a packed movement state is in range of its enum. */
+	static bool IsValidMovementState(uint8 InMovementState);
 	
 	/** [local] Updates the camera settings and sets DesiredCameraSocketOffset to interpolate to. */
 	void SetCameraMode(FCameraModeSettings NewCameraState);
@@ -322,16 +245,24 @@ private:
 	/**  Returns the eyes location of the owning character */
 	FVector GetEyesLocation() const;
 
-	/** [local] Starts NetUpdateTick() ticking if there is no TargetedActor, Stops ticking if there is */
+	/** Sets the Owner CharacterMovementComponent bOrientRotationToMovement property. The server follows the owner's
+	* RotationMode through the movement state, necessary for proper root motion gameplay abilities */
+	void SetOrientRotationToMovement(bool Value);
+
+	/** [remote] Applies the replicated MovementState on simulated proxies */
 	UFUNCTION()
-	void OnTargetUpdated(UPrimitiveComponent* InTargetActor);
+	void OnRep_MovementState();
 
-	/** [local] Sets the Owner CharacterMovementComponent bOrientRotationToMovement property */
-	void SetOrientRotationToMovement(bool Value);
+	/** [remote] Adds the new aim to AimSamples, updates the interpolation delay and enables tick to interpolate it */
+	UFUNCTION()
+	void OnRep_QuantizedCameraRotationVector2D();
 
-	/** [local] Called while there is no targeted actor at rate set with AimOffsetNetUpdatesPerSecond. 
-	* updates the replicated version of the camera rotation for aim offset with ServerUpdateCameraRotation() */
-	void NetUpdateTick();
+	/** [remote] Updates SmoothedCameraRotator for the current render time. Returns false once there is nothing left to
+	* interpolate or extrapolate, so tick can be disabled. */
+	bool UpdateRemoteAim();
+
+	/** [remote] Draws the aim buffer depth, delay and error above the owner */
+	void DrawAimInterpolationDebug() const;
 
 	/** Draws an arrow in the direction the actor is facing (ForwardActorRotation) */
 	void DrawActorForwardRotator(FColor Color, float ZOffset) const;
@@ -388,38 +319,4 @@ public:
 	*  Draws an arrow in the direction of the input Rotator */
 	UFUNCTION(BlueprintCallable, Category="MovementSystem")
 	void DrawLocomotionDebugArrow(FRotator Rotator, FColor Color, float ZOffset) const;
-
-	
-	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	/// 6. Server RPC's
-	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-private:
-	/** Updates the replicated camera rotation to replicate the aim offset when not targeting.
-	* 	Called in NetUpdateTick(), which is only active while the player is not targeting, at
-	* 	at a rate set by AimOffsetNetUpdatesPerSecond. */
-	UFUNCTION(Server, Unreliable, WithValidation)
-	void ServerUpdateCameraRotation(FVector_NetQuantize2D InVector);
-	void ServerUpdateCameraRotation_Implementation(FVector_NetQuantize2D InVector);
-	bool ServerUpdateCameraRotation_Validate(FVector_NetQuantize2D InVector);
-
-	/** Replicates the CombatComponent to remote players, used for aim offset */
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerSetCombatComponent(UNCombatComponent* InCombatComponent);
-	void ServerSetCombatComponent_Implementation(UNCombatComponent* InCombatComponent);
-	bool ServerSetCombatComponent_Validate(UNCombatComponent* InCombatComponent);
-
-	/** Sets the players bOrientRotationToMovement to server, necessary for proper root motion gameplay abilities */
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerSetOrientRotationToMovement(bool Value);
-	void ServerSetOrientRotationToMovement_Implementation(bool Value);
-	bool ServerSetOrientRotationToMovement_Validate(bool Value);
-
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerSetStance(ENStance InStance, bool bBroadcast = true);
-	void ServerSetStance_Implementation(ENStance InStance, bool bBroadcast = true);
-	bool ServerSetStance_Validate(ENStance InStance, bool bBroadcast = true);
 };
-
-
-
-
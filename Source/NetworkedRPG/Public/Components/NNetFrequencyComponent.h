@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "NNetFrequencyComponent.generated.h"
+
+/** Replication state of an actor with a UNNetFrequencyComponent */
+UENUM()
+enum class ENNetFrequencyState : uint8
+{
+	Idle,
+	Combat,
+};
+
+/** Sections
+*	1. Blueprint Settings
+*	2. State
+*	3. Overrides
+*	4. Interface and Methods
+*/
+
+/**
+ * [server] Adapts the owner's NetUpdateFrequency to what it is doing.
+ *	- Enters Combat as soon as the owner takes or deals damage, runs a combat ability, or is target locked.
+ *	- Returns to Idle only after CombatHoldTime without any of these, so short pauses in a fight don't drop the rate.
+ *	- The state's frequency is scaled by the significance manager's scale for the owner, see SetFrequencyScale().
+ * Used on characters and on PlayerStates, which host the player's ASC. For PlayerStates the signals are read from the
+ * ASC's avatar. View actors and updates per state with 'stat NRPG'.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class NETWORKEDRPG_API UNNetFrequencyComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Sets default values for this component's properties */
+	UNNetFrequencyComponent();
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. Blueprint Settings
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Owner's NetUpdateFrequency when idle */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1.0"), Category = "Settings|Net")
+	float IdleNetUpdateFrequency;
+
+	/** Owner's NetUpdateFrequency in combat */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1.0"), Category = "Settings|Net")
+	float CombatNetUpdateFrequency;
+
+	/** Seconds without a combat signal before returning to Idle */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Settings|Net")
+	float CombatHoldTime;
+
+	/** Seconds between checking the combat signals. Damage enters Combat immediately. */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Settings|Net")
+	float EvaluationInterval;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	ENNetFrequencyState State;
+
+	/** World time of the last combat signal, negative if there was none */
+	float LastCombatTime;
+
+	/** Set from the owner's significance */
+	float FrequencyScale;
+
+	/** True while the controller runs, on the server of a networked game */
+	bool bActive;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Checks the combat signals every EvaluationInterval */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	/** Starts the controller on the server */
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 4. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the current state */
+	ENNetFrequencyState GetState() const { return State; }
+
+	/** Enters Combat now, and stays for at least CombatHoldTime */
+	void NotifyCombat();
+
+	/** Calls NotifyCombat() on the actor's component, and on its PlayerState's if it is a pawn */
+	static void NotifyActorCombat(AActor* Actor);
+
+	/** Sets the scale on the state's frequency, from the owner's significance */
+	void SetFrequencyScale(float Scale);
+
+	/** Call from the owner's PreReplication. Counts an update in the current state, and returns the state's cycle stat
+	  * to scope the owner's PreReplication with. */
+	TStatId NotifyPreReplication() const;
+
+private:
+	/** Returns true if the owner or the ASC's avatar is running a combat ability or is target locked */
+	bool HasCombatSignal() const;
+
+	void SetState(ENNetFrequencyState NewState);
+
+	/** Sets the owner's NetUpdateFrequency for the state and scale */
+	void ApplyFrequency() const;
+};
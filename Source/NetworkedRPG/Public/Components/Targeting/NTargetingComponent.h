@@ -118,6 +118,9 @@ public:
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/** Validates push model dirty marking when 'NRPG.Debug.PushModel' is set. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 protected:
 	/** Called when the game starts or an actor owning this component is spawned */
 	virtual void BeginPlay() override;
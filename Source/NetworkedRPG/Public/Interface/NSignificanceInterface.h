@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NSignificanceManager.h"
+#include "UObject/Interface.h"
+#include "NSignificanceInterface.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI)
+class UNSignificanceInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors registered with UNSignificanceManager.
+ */
+class NETWORKEDRPG_API INSignificanceInterface
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Called when the actor changes significance bucket. Apply the bucket's tick, animation, net and cosmetic settings. */
+	virtual void SetSignificance(ENSignificance Significance, const FNSignificanceSettings& Settings) = 0;
+};
@@ -20,4 +20,7 @@ public:
 
 	/** Removes weapon overlap event. */
 	virtual void BeginDestroy() override;
+
+	/** Removes weapon overlap event and collision while pooled. */
+	virtual void Release() override;
 };
@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Interface/NInteractableInterface.h"
-#include "Components/TimelineComponent.h"
+#include "Interface/NSignificanceInterface.h"
 #include "GameFramework/Actor.h"
 #include "NPickupActor.generated.h"
 
@@ -12,7 +12,7 @@ class UCapsuleComponent;
 class UNItem;
 
 UCLASS()
-class NETWORKEDRPG_API ANPickupActor : public AActor, public INInteractableInterface
+class NETWORKEDRPG_API ANPickupActor : public AActor, public INInteractableInterface, public INSignificanceInterface
 {
 	GENERATED_BODY()
 
@@ -44,7 +44,7 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item|Mesh", meta = (EditCondition = "!bUseItemMesh"))
 	USkeletalMeshComponent* SkeletalMesh;
 
-	/** The curve for the bobbing animation, should start and end with a value of 0 */
+	/** The curve for the bobbing animation, should start and end with a value of 0. Animated by UNPickupAnimationSubsystem. */
 	UPROPERTY(EditAnywhere, Category = "Item|Animation")
 	UCurveFloat* BobbingCurve;
 
@@ -56,6 +56,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Item|Animation")
 	FRotator RotationSpeed;
 
+	/** Seconds after spawning the collision capsule stops simulating, if it hasn't gone to sleep by then */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"), Category = "Item|Physics")
+	float MaxSimulateTime;
+
 	/** The offset of the interaction indicator from the root component */
 	UPROPERTY(EditAnywhere, Category = "Item|Interaction")
 	FVector InteractionIndicatorOffset;
@@ -81,48 +85,68 @@ protected:
 	/// 3. References and State
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
-	FTimeline BobbingTimeline;
-	FVector InitialOffset;
 	FTimerHandle TimerHandle;
+	FTimerHandle SettleTimerHandle;
 
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 4. Overrides
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 public:
-	/** Called every frame if BobbingCurve and BobbingHeight or RotationSpeed are set */
-	virtual void Tick(float DeltaTime) override;
-
 	/** Updates the mesh to the Item mesh if bUseItemMesh is true */
 	virtual void OnConstruction(const FTransform& Transform) override;
 
-	/** Replicates ItemData. */
+	/** Replicates ItemData, push based so it is only compared after SetItem(). */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/** Validates push model dirty marking when 'NRPG.Debug.PushModel' is set. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	/** NInteractableInterface */
 	virtual void Interact(AActor*InActor) override;
 	virtual FVector GetIndicatorOffset() override;
 	virtual USceneComponent* GetInteractableRootComponent() override;
 	virtual ENInteractableType GetInteractableType() override;
+
+	/** INSignificanceInterface. Slows the animation updates, and stops them when culled. */
+	virtual void SetSignificance(ENSignificance Significance, const FNSignificanceSettings& Settings) override;
 	
 protected:
-	/** Called when the game starts or when spawned */
+	/** Called when the game starts or when spawned. Registers with the significance manager and the animation subsystem. */
 	virtual void BeginPlay() override;
 
+	/** Unregisters from the significance manager and the animation subsystem */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 5. Interface and Methods
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 public:
-	/** Sets the item and count and updates the mesh */
+	/** Sets the item and count and updates the mesh. Wakes the actor to replicate a new item. */
 	void SetItem(UNItem* InItem, int32 InCount);
 
+	UNItem* GetItemData() const { return ItemData; }
+	int32 GetItemCount() const { return ItemCount; }
+	int32 GetItemLevel() const { return ItemLevel; }
+
+	/** [server] Adds to the count picked up, when another drop merges into this one. The count doesn't replicate. */
+	void AddItemCount(int32 Count) { ItemCount += Count; }
+
 private:
+	/** Returns true if BobbingCurve and BobbingHeight or RotationSpeed are set */
+	bool HasAnimation() const;
+
 	/** Updates the item mesh to that of the Item data */
 	void UpdateItemMesh() const;
-	
+
+	/** Stops the collision capsule simulating, it keeps blocking as a static body. On the server, lets the drop
+	  * subsystem merge the pickup into a drop nearby. */
+	void Settle();
+
+	/** Settles when the physics body goes to sleep */
 	UFUNCTION()
-	void HandleTimelineAnimation(float Value);
+	void OnCollisionCapsuleSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
 
 	/** Updates the item mesh */
 	UFUNCTION()
@@ -55,6 +55,9 @@ public:
 	/** Only replicated ClipAmmo if not currently firing. */
 	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 
+	/** Resets the ammo to the class defaults in place, for the next weapon. */
+	virtual void Release() override;
+
 	
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 3. Interface and Methods
@@ -41,7 +41,7 @@ struct FAttachmentOffset;
 
 /**
  *  Base class for a weapon actor. NOT meant to be blueprinted, should spawned within game based off of UNWeaponItem data.
- *  MUST call Initialize() after spawning.
+ *  MUST call Initialize() after spawning. Pooled per owner by UNCombatComponent, Release() before initializing again.
  */
 UCLASS()
 class NETWORKEDRPG_API ANWeaponActor : public ANEquipmentActor, public IAbilitySystemInterface
@@ -55,12 +55,6 @@ public:
     /// 1. References and State
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 private:
-    // Internal State for socket attachment interpolation.
-    FVector RelativeLocation;
-    FVector TargetRelativeLocation;
-    FRotator RelativeRotation;
-    FRotator TargetRelativeRotation;
-
     bool bActiveWeaponSwap;
     bool bIsEquipped;
     FGameplayTag EquippedGameplayTag;
@@ -80,9 +74,6 @@ protected:
     /// 2. Overrides
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 public:
-    /** Handles interpolation for smooth socket attachment. */
-    virtual void TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
-
     virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
     /** IAbilitySystemInterface */
@@ -106,12 +97,19 @@ public:
     /** Returns true if weapon is currently equipped (not holstered). */
     bool IsEquipped() const { return bIsEquipped; }
 
+    /** Unbinds the weapon data, ends a weapon swap in progress and hides the actor, so it can be initialized again
+     * with other data instead of spawning a new actor. */
+    virtual void Release();
+
 protected:
     /** Sets the weapon mesh and attaches the actor to the owning character */
     void SetProperties(FWeaponActorData Data);
 
+    /** [Server] Wakes the dormant actor so its changes replicate once, it goes back to dormant after. */
+    void FlushReplicatedState();
+
     /** Attaches the weapon to the input SocketName with the input Offset.
-     * If bSmoothAttach is true, will interpolate in tick to the final position.
+     * If bSmoothAttach is true, will transition to the final position with UNAttachTransitionSubsystem.
      * If bSmoothAttach is false, will snap to the socket. */
     void AttachWeaponToSocket(FName& SocketName, FAttachmentOffset& Offset, bool bSmoothAttach = true);
 
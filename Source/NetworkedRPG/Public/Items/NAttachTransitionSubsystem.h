@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/NClientTickableSubsystem.h"
+#include "NAttachTransitionSubsystem.generated.h"
+
+/** A component moving from its relative transform at attachment to its target relative transform */
+struct FNAttachTransition
+{
+	TWeakObjectPtr<USceneComponent> Component;
+	FVector StartLocation;
+	FVector TargetLocation;
+	FQuat StartRotation;
+	FQuat TargetRotation;
+	float StartTime;
+	float Duration;
+};
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [client] Moves components to their relative transform after attaching to a new socket, in place of each owner ticking
+ * an interpolation. Every transition finishes in NRPG.AttachTransition.Duration along an ease out curve evaluated from
+ * its start time, so a frame skipped costs nothing and doesn't slow the transition down.
+ *	- One SetRelativeLocationAndRotation per transition and frame.
+ *	- Components of actors not recently rendered are only moved on the final frame.
+ * Not created on dedicated servers, where StartTransition() callers snap instead. View the counts with 'stat NRPG'.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNAttachTransitionSubsystem : public UNClientTickableSubsystem
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Running transitions, at most one per component */
+	TArray<FNAttachTransition> Transitions;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool HasWork() const override { return Transitions.Num() > 0; }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem, or nullptr on a dedicated server */
+	static UNAttachTransitionSubsystem* Get(const UWorld* World);
+
+	/** Moves the component from its current relative transform to the target. Replaces a running transition of the
+	  * component. Snaps on a dedicated server, or if the duration is 0. */
+	void StartTransition(USceneComponent* Component, const FVector& TargetLocation, const FRotator& TargetRotation);
+
+	/** Starts a transition with the world's subsystem, or snaps to the target if there is none */
+	static void StartOrSnap(USceneComponent* Component, const FVector& TargetLocation, const FRotator& TargetRotation);
+
+	/** Stops the component's transition where it is */
+	void CancelTransition(const USceneComponent* Component);
+
+	/** Calls CancelTransition() on the world's subsystem if there is one */
+	static void CancelTransitionFor(const USceneComponent* Component);
+
+private:
+	int32 FindTransition(const USceneComponent* Component) const;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "NClientTickableSubsystem.generated.h"
+
+/**
+ * [client] Base of the world subsystems that only move what local players see, ticking as an FTickableGameObject while
+ * HasWork() returns true.
+ * Not created on dedicated servers. A dedicated server started from the editor shares the process with its clients, so
+ * its world still gets one. Check IsDedicatedServerWorld() where that matters.
+ */
+UCLASS(Abstract)
+class NETWORKEDRPG_API UNClientTickableSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds since an actor was last rendered for it to still count as seen */
+	static constexpr float VisibleRenderTime = 0.2f;
+
+	/** Not created on dedicated servers */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override PURE_VIRTUAL(UNClientTickableSubsystem::Tick, );
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override PURE_VIRTUAL(UNClientTickableSubsystem::GetStatId, return TStatId(););
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+protected:
+	/** Returns true while there is anything to update */
+	virtual bool HasWork() const PURE_VIRTUAL(UNClientTickableSubsystem::HasWork, return false;);
+
+	/** Returns true if this subsystem's world is a dedicated server started from the editor */
+	bool IsDedicatedServerWorld() const;
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/NClientTickableSubsystem.h"
+#include "NPickupAnimationSubsystem.generated.h"
+
+class UCurveFloat;
+
+/** Idle animation of one registered actor */
+struct FNPickupAnimation
+{
+	TWeakObjectPtr<AActor> Owner;
+	TWeakObjectPtr<USceneComponent> AnimationRoot;
+	const UCurveFloat* BobbingCurve;
+	float BobbingCurveLength;
+	float BobbingHeight;
+	FRotator RotationSpeed;
+	FVector InitialOffset;
+	FRotator InitialRotation;
+
+	/** Added to world time to get the animation time. Starts the animation at registration, at a random point of its
+	  * cycle. */
+	float Phase;
+
+	/** Seconds between updates, from the owner's significance. 0 updates every frame. */
+	float UpdateInterval;
+	float NextUpdateTime;
+
+	/** False while the owner is culled by significance */
+	bool bEnabled;
+};
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [client] Animates the bobbing and rotation of every registered pickup in one pass, in place of a tick and timeline
+ * per pickup. The animation is evaluated from world time, so pickups that were skipped need no catch up.
+ * Each update only moves pickups that were recently rendered and within NRPG.PickupAnimation.CullDistance of a local
+ * viewer, with one SetRelativeLocationAndRotation each. Not created on dedicated servers, where nobody sees it.
+ * View the counts with 'stat NRPG'.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNPickupAnimationSubsystem : public UNClientTickableSubsystem
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Registered animations, stale entries are removed during the update */
+	TArray<FNPickupAnimation> Animations;
+
+	/** Index into Animations for each registered owner */
+	TMap<TWeakObjectPtr<AActor>, int32> AnimationIndices;
+
+	/** Reused each update */
+	TArray<FVector> ViewLocations;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool HasWork() const override { return Animations.Num() > 0; }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem, or nullptr on a dedicated server */
+	static UNPickupAnimationSubsystem* Get(const UWorld* World);
+
+	/** Adds the owner's idle animation, moving AnimationRoot from its current relative transform. */
+	void RegisterAnimation(AActor* Owner, USceneComponent* AnimationRoot, const UCurveFloat* BobbingCurve, float BobbingHeight, const FRotator& RotationSpeed);
+
+	/** Call from EndPlay of registered actors */
+	void UnregisterAnimation(AActor* Owner);
+
+	/** Enables or disables the owner's animation and sets its update interval, from its significance */
+	void SetAnimationSignificance(AActor* Owner, bool bEnabled, float UpdateInterval);
+
+private:
+	/** Gathers every local player's view location */
+	void GatherViewLocations();
+
+	/** Returns true if the owner was recently rendered and is within the cull distance of a view location */
+	bool IsVisible(const AActor* Owner, float CullDistanceSquared) const;
+
+	/** Moves the animation root to its transform at Time */
+	static void Evaluate(const FNPickupAnimation& Animation, float Time);
+
+	void RemoveAnimationAt(int32 Index);
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NPickupDropSubsystem.generated.h"
+
+class ANPickupActor;
+class UNItem;
+
+/** Sections
+*	1. State
+*	2. Overrides
+*	3. Interface and Methods
+*/
+
+/**
+ * [server] Keeps dropped pickups in a grid of NRPG.Pickup.AreaSize cells, to limit how many pile up.
+ *	- A new drop of the same item and level within NRPG.Pickup.MergeDistance of an existing drop adds its count to it
+ *	  instead of spawning, see MergeDrop(). Drops that roll together merge once they settle.
+ *	- An area holding more than NRPG.Pickup.MaxPerArea drops merges its oldest drop into a newer one of the same item,
+ *	  or destroys it if there is none.
+ * Only drops registered with RegisterDrop() are tracked, pickups placed in the level are never merged or evicted.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNPickupDropSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Drops in each area, oldest first */
+	TMap<FIntPoint, TArray<TWeakObjectPtr<ANPickupActor>>> AreaDrops;
+
+	/** Area each drop was added to */
+	TMap<TWeakObjectPtr<ANPickupActor>, FIntPoint> DropAreas;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void Deinitialize() override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Returns the world's subsystem */
+	static UNPickupDropSubsystem* Get(const UWorld* World);
+
+	/** [server] Adds the count to a drop of the same item and level near Location. Returns false if there is none,
+	  * then the caller spawns a new drop. */
+	bool MergeDrop(UNItem* ItemData, int32 ItemLevel, int32 Count, const FVector& Location);
+
+	/** [server] Tracks a newly spawned drop, and enforces the cap of its area */
+	void RegisterDrop(ANPickupActor* Pickup);
+
+	/** [server] Call from EndPlay of pickups. Does nothing for pickups that aren't tracked. */
+	void UnregisterDrop(ANPickupActor* Pickup);
+
+	/** [server] Call when a pickup stops simulating. Moves it to the area it settled in, and merges it into a drop of
+	  * the same item nearby. */
+	void OnDropSettled(ANPickupActor* Pickup);
+
+private:
+	/** Returns the tracked drop of the same item and level nearest to Location within the merge distance, or nullptr */
+	ANPickupActor* FindMergeTarget(const UNItem* ItemData, int32 ItemLevel, const FVector& Location, const ANPickupActor* Ignore) const;
+
+	/** Merges or destroys the oldest drops of the area until it is within the cap */
+	void EnforceAreaCap(const FIntPoint& Area);
+
+	static FIntPoint GetArea(const FVector& Location);
+
+	void AddToArea(ANPickupActor* Pickup, const FIntPoint& Area);
+	void RemoveFromArea(ANPickupActor* Pickup);
+};
@@ -7,11 +7,12 @@
 #include "NAssetManager.generated.h"
 
 class UNItem;
+class UAnimMontage;
 
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class NETWORKEDRPG_API UNAssetManager : public UAssetManager
 {
 	GENERATED_BODY()
@@ -31,5 +32,25 @@ public:
 	static UNAssetManager& Get();
 
 	UNItem* ForceLoadItem(const FPrimaryAssetId& PrimaryAssetId, bool bLogWarning = true);
-	
+
+	/** Montages replicated by index instead of object reference, see FGameplayAbilityRepAnimMontageForMesh::NetSerialize.
+	  * Set in DefaultGame.ini, must be the same list in the same order on server and clients. */
+	UPROPERTY(Config)
+	TArray<TSoftObjectPtr<UAnimMontage>> ReplicatedMontages;
+
+	/** Returns the replication id of the montage, INDEX_NONE if it is not in ReplicatedMontages. */
+	int32 GetMontageRepId(const UAnimMontage* Montage) const;
+
+	/** Returns the montage for a replication id, nullptr if the id is unknown. */
+	UAnimMontage* GetMontageFromRepId(int32 MontageRepId) const;
+
+private:
+	/** Loads ReplicatedMontages and builds the id lookup. */
+	void LoadReplicatedMontages();
+
+	/** Loaded ReplicatedMontages, the index is the replication id. Entries that failed to load stay null to keep ids aligned. */
+	UPROPERTY(Transient)
+	TArray<UAnimMontage*> LoadedReplicatedMontages;
+
+	TMap<const UAnimMontage*, int32> MontageRepIds;
 };
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+/**
+ * Push model replication for the module's replicated properties.
+ *
+ * Properties registered with FDoRepLifetimeParams::bIsPushBased are only compared for replication after being marked
+ * dirty, so every write to one of them on the server must be followed by NMARK_PROPERTY_DIRTY. Marking is a no-op
+ * when the engine is built without push model (WITH_PUSH_MODEL=0), where the properties are compared as before.
+ *
+ * With 'NRPG.Debug.PushModel 1' (not in Shipping), objects calling NPushModel::ValidateProperties() from
+ * PreReplication keep a copy of their replicated values, and ensure when one changed since the last net update without
+ * being marked dirty.
+ */
+
+#if !UE_BUILD_SHIPPING
+#define NMARK_PROPERTY_DIRTY(ClassName, PropertyName, Object) \
+	{ \
+		MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, Object); \
+		NPushModel::NotifyMarkedDirty(Object, GET_MEMBER_NAME_CHECKED(ClassName, PropertyName)); \
+	}
+#else
+#define NMARK_PROPERTY_DIRTY(ClassName, PropertyName, Object) \
+	{ \
+		MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, Object); \
+	}
+#endif
+
+namespace NPushModel
+{
+#if !UE_BUILD_SHIPPING
+	/** Records the mark for validation. Use NMARK_PROPERTY_DIRTY rather than calling this directly. */
+	NETWORKEDRPG_API void NotifyMarkedDirty(const UObject* Object, FName PropertyName);
+
+	/**
+	 * Call on the server from PreReplication. Ensures for any of the module's replicated properties on Object that
+	 * changed since the last call without being marked dirty. Does nothing unless 'NRPG.Debug.PushModel' is set.
+	 */
+	NETWORKEDRPG_API void ValidateProperties(const UObject* Object);
+#else
+	FORCEINLINE void NotifyMarkedDirty(const UObject* Object, FName PropertyName) {}
+	FORCEINLINE void ValidateProperties(const UObject* Object) {}
+#endif
+}
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "NReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_PlayerStateFrequencyLimiter;
+class UNReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+/** How actors of a class are routed to the graph nodes */
+enum class ENClassRepNodeMapping : uint32
+{
+	/** Not routed to a node, handled through another actor (weapons, owner's PlayerController and PlayerState) */
+	NotRouted,
+	/** Replicated to every connection */
+	RelevantAllConnections,
+	/** Replicated only to the owning connection */
+	RelevantOwnerOnly,
+	/** Moves, re-gridded every frame */
+	Spatialize_Dynamic,
+	/** Treated as static while dormant and dynamic while awake */
+	Spatialize_Dormancy,
+	/** Replicated through the equipping character's dependent actor list */
+	Dependent,
+};
+
+/** Sections
+*	1. Config Settings
+*	2. Nodes
+*	3. Overrides
+*	4. Interface and Methods
+*/
+
+/**
+ * Replication graph for the project, replaces per-actor, per-connection relevancy checks.
+ *	- Characters and projectiles are placed in a 2D spatial grid and culled by distance.
+ *	- Pickups are in the same grid but only move cells when they are awake, so dormant pickups cost nothing per frame.
+ *	- Equipment actors replicate with their owning character through its dependent actor list.
+ *	- Remote PlayerStates go through a frequency limited node, the owner's PlayerState and any owner-only actors
+ *	  through a per connection node.
+ *	- Any other replicated class is routed by its relevancy flags.
+ * Enabled as the ReplicationDriverClassName of the IpNetDriver in DefaultEngine.ini.
+ */
+UCLASS(Transient, Config = Engine)
+class NETWORKEDRPG_API UNReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UNReplicationGraph();
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. Config Settings
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Size of a spatial grid cell, in cm */
+	UPROPERTY(Config)
+	float SpatialGridCellSize;
+
+	/** Essentially "Min X/Y" of the grid, actors below it are clamped into the first cells */
+	UPROPERTY(Config)
+	float SpatialBiasX;
+
+	UPROPERTY(Config)
+	float SpatialBiasY;
+
+	/** Distance past which characters stop replicating to a connection */
+	UPROPERTY(Config)
+	float CharacterCullDistance;
+
+	/** Distance past which projectiles stop replicating to a connection */
+	UPROPERTY(Config)
+	float ProjectileCullDistance;
+
+	/** Distance past which pickups stop replicating to a connection */
+	UPROPERTY(Config)
+	float PickupCullDistance;
+
+	/** Remote PlayerStates replicated per frame, across all connections */
+	UPROPERTY(Config)
+	int32 PlayerStatesPerFrame;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. Nodes
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode;
+
+	/** Per connection nodes, used to route owner-only actors to their connection */
+	UPROPERTY()
+	TMap<UNetConnection*, UNReplicationGraphNode_AlwaysRelevant_ForConnection*> OwnerNodes;
+
+	/** Routing of each replicated class, filled in InitGlobalActorClassSettings() */
+	TClassMap<ENClassRepNodeMapping> ClassRepNodePolicies;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Track the number of dormant actors, which skip replication each tick, for 'stat NRPG' */
+	virtual void NotifyActorDormancyChange(AActor* Actor, ENetDormancy OldDormancyState) override;
+	virtual void FlushNetDormancy(AActor* Actor, bool bWasDormInitial) override;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 4. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Applies a runtime change of the actor's NetUpdateFrequency, the graph otherwise keeps the class's rate. Server only. */
+	static void UpdateActorNetUpdateFrequency(AActor* Actor);
+
+private:
+	/** Returns the routing of the actor's class */
+	ENClassRepNodeMapping GetMappingPolicy(const UClass* Class) const;
+
+	/** Returns the routing for a replicated class from its relevancy flags */
+	static ENClassRepNodeMapping GetDefaultMappingPolicy(const AActor* ActorCDO);
+
+	/** Sets the class settings, culling distance is only used for spatialized classes */
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize, float CullDistance) const;
+
+	/** Returns the per connection node of the actor's owning connection, if it has one yet */
+	UNReplicationGraphNode_AlwaysRelevant_ForConnection* GetOwnerNode(const AActor* Actor) const;
+};
+
+
+/**
+ * Per connection node. Adds the viewer's own PlayerState every frame, as remote PlayerStates are frequency limited,
+ * and any actors only relevant to the connection.
+ */
+UCLASS()
+class NETWORKEDRPG_API UNReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	/** Adds an actor only relevant to this connection */
+	void AddOwnerOnlyActor(AActor* Actor);
+
+	/** Removes an actor added with AddOwnerOnlyActor(). Returns false if it was not in this node. */
+	bool RemoveOwnerOnlyActor(AActor* Actor);
+
+private:
+	/** Actors only relevant to this connection */
+	FActorRepListRefView OwnerOnlyActors;
+
+	/** The viewers' PlayerStates, rebuilt each frame */
+	FActorRepListRefView PlayerStateList;
+};
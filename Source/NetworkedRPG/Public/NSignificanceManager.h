@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SignificanceManager.h"
+#include "Tickable.h"
+#include "NSignificanceManager.generated.h"
+
+/** Significance buckets, most significant first */
+UENUM()
+enum class ENSignificance : uint8
+{
+	Critical,
+	High,
+	Medium,
+	Low,
+	Culled,
+};
+
+/** What an actor runs at in a significance bucket */
+USTRUCT()
+struct FNSignificanceSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FNSignificanceSettings():
+		MaxDistance(0.f),
+		Budget(0),
+		TickInterval(0.f),
+		AnimTickInterval(0.f),
+		NetUpdateFrequencyScale(1.f),
+		bTickPoseWhenNotRendered(true),
+		bCosmetics(true),
+		bTickMesh(true),
+		bSimplifiedMovement(false)
+	{}
+
+	FNSignificanceSettings(float MaxDistance, int32 Budget, float TickInterval, float AnimTickInterval, float NetUpdateFrequencyScale, bool bTickPoseWhenNotRendered, bool bCosmetics, bool bTickMesh, bool bSimplifiedMovement):
+		MaxDistance(MaxDistance),
+		Budget(Budget),
+		TickInterval(TickInterval),
+		AnimTickInterval(AnimTickInterval),
+		NetUpdateFrequencyScale(NetUpdateFrequencyScale),
+		bTickPoseWhenNotRendered(bTickPoseWhenNotRendered),
+		bCosmetics(bCosmetics),
+		bTickMesh(bTickMesh),
+		bSimplifiedMovement(bSimplifiedMovement)
+	{}
+
+	/** Distance to the nearest viewer up to which actors are in this bucket. Out of view actors count as further. */
+	UPROPERTY(Config)
+	float MaxDistance;
+
+	/** Max actors of a tag in this bucket, the least significant over budget drop to the next. 0 for no limit. */
+	UPROPERTY(Config)
+	int32 Budget;
+
+	/** Interval for actor, movement and ability ticks, and of attached actors. 0 ticks every frame. */
+	UPROPERTY(Config)
+	float TickInterval;
+
+	/** Interval for the skeletal mesh tick, which updates animation. 0 ticks every frame. */
+	UPROPERTY(Config)
+	float AnimTickInterval;
+
+	/** Scale on the class NetUpdateFrequency. Server only. */
+	UPROPERTY(Config)
+	float NetUpdateFrequencyScale;
+
+	/** Keep the mesh's tick option, otherwise only montages tick when not rendered (always on a dedicated server). */
+	UPROPERTY(Config)
+	bool bTickPoseWhenNotRendered;
+
+	/** Particle, audio and widget components stay active. */
+	UPROPERTY(Config)
+	bool bCosmetics;
+
+	/** AI meshes tick at all, otherwise not even montages. Server only. */
+	UPROPERTY(Config)
+	bool bTickMesh;
+
+	/** AI walk on the navmesh instead of sweeping the capsule along the floor. Server only. */
+	UPROPERTY(Config)
+	bool bSimplifiedMovement;
+};
+
+/** Sections
+*	1. Config Settings
+*	2. State
+*	3. Overrides
+*	4. Interface and Methods
+*/
+
+/**
+ * Buckets registered actors by distance and visibility to the nearest viewer, and applies the bucket settings through
+ * INSignificanceInterface when an actor changes bucket.
+ *	- Viewers are every player controller's view point, so on the server all players and on clients the local ones,
+ *	  plus any extra viewpoints set for profiling.
+ *	- Actors outside a viewer's view cone, and not recently rendered, count as OutOfViewDistanceScale further away.
+ *	- Each bucket has a budget per tag, the least significant actors over budget drop to the next bucket.
+ * Ticks itself every UpdateInterval. Enabled as the SignificanceManagerClassName in DefaultEngine.ini.
+ * View the budget stats with 'stat NRPG'.
+ */
+UCLASS(Config = Engine)
+class NETWORKEDRPG_API UNSignificanceManager : public USignificanceManager, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UNSignificanceManager();
+
+	/** Returns the world's manager, or nullptr if significance is disabled */
+	static UNSignificanceManager* Get(const UWorld* World);
+
+	static const FName CharacterTag;
+	static const FName PickupTag;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 1. Config Settings
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** One entry per ENSignificance, in order */
+	UPROPERTY(Config)
+	TArray<FNSignificanceSettings> BucketSettings;
+
+	/** Seconds between significance updates */
+	UPROPERTY(Config)
+	float UpdateInterval;
+
+	/** Half angle of a viewer's view cone, in degrees */
+	UPROPERTY(Config)
+	float ViewConeHalfAngle;
+
+	/** Distance multiplier for actors outside every view cone */
+	UPROPERTY(Config)
+	float OutOfViewDistanceScale;
+
+	/** Actors within this distance are always in view */
+	UPROPERTY(Config)
+	float NearDistance;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 2. State
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+private:
+	/** Bucket applied to each registered actor */
+	TMap<TWeakObjectPtr<AActor>, ENSignificance> AppliedSignificance;
+
+	/** Reused each update */
+	TArray<FTransform> GatheredViewpoints;
+
+	/** Viewpoints used in addition to the players', to profile a headless server as if players were watching */
+	TArray<FTransform> ExtraViewpoints;
+
+	float TimeSinceUpdate;
+
+	float ViewConeCos;
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 3. Overrides
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	virtual void PostInitProperties() override;
+
+	/** Scores with the viewpoints, then assigns buckets per tag within budget */
+	virtual void Update(TArrayView<const FTransform> InViewpoints) override;
+
+	/** FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// 4. Interface and Methods
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Registers an actor implementing INSignificanceInterface. It starts in the Critical bucket. */
+	void RegisterActor(AActor* Actor, FName Tag);
+
+	/** Call from EndPlay of registered actors */
+	void UnregisterActor(AActor* Actor);
+
+	/** Returns the settings of a bucket */
+	const FNSignificanceSettings& GetSettings(ENSignificance Significance) const;
+
+	/** Replaces the viewpoints used in addition to the players'. Pass an empty array to only use the players'. */
+	void SetExtraViewpoints(const TArray<FTransform>& InViewpoints) { ExtraViewpoints = InViewpoints; }
+
+	/** Activates or deactivates the actor's particle, audio and widget components. Only components this deactivated
+	  * are activated again. */
+	static void SetCosmeticsActive(AActor* Actor, bool bActive);
+
+private:
+	/** Higher is more significant, the negative of the distance to the viewpoint scaled when out of view */
+	float CalculateSignificance(const AActor* Actor, const FTransform& Viewpoint) const;
+
+	/** Returns the bucket for a significance, before budgets */
+	ENSignificance GetBucket(float Significance) const;
+
+	/** Gathers every player controller's view point, and the extra viewpoints */
+	void GatherViewpoints();
+};
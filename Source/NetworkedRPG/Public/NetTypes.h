@@ -0,0 +1,593 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "NetTypes.generated.h"
+
+/** Sections
+*	1. Packed 2D Vectors
+*	2. Compile-time Quantizers
+*	3. Quantized Structs
+*/
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// 1. Packed 2D Vectors
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<int32 MaxValue, int32 NumBits>
+bool SerializeFixedVector2D(FVector2D &Vector, FArchive& Ar)
+{
+	if (Ar.IsSaving())
+	{
+		bool success = true;
+		success &= WriteFixedCompressedFloat<MaxValue, NumBits>(Vector.X, Ar);
+		success &= WriteFixedCompressedFloat<MaxValue, NumBits>(Vector.Y, Ar);
+		return success;
+	}
+
+	ReadFixedCompressedFloat<MaxValue, NumBits>(Vector.X, Ar);
+	ReadFixedCompressedFloat<MaxValue, NumBits>(Vector.Y, Ar);
+	return true;
+}
+
+template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
+bool WritePackedVector2D(FVector2D Value, FArchive& Ar)	// Note Value is intended to not be a reference since we are scaling it before serializing!
+{
+	check(Ar.IsSaving());
+
+	// Scale vector by quant factor first
+	Value *= ScaleFactor;
+
+	// Nan Check
+	if( Value.ContainsNaN() )
+	{
+		logOrEnsureNanError(TEXT("WritePackedVector: Value contains NaN, clearing for safety."));
+		FVector2D	Dummy(0, 0);
+		WritePackedVector2D<ScaleFactor, MaxBitsPerComponent>(Dummy, Ar);
+		return false;
+	}
+
+	// Some platforms have RoundToInt implementations that essentially reduces the allowed inputs to 2^31.
+	const FVector2D ClampedValue(FMath::Clamp(Value.X, -1073741824.0f, 1073741760.0f), FMath::Clamp(Value.Y, -1073741824.0f, 1073741760.0f));
+	bool bClamp = ClampedValue != Value;
+
+	// Do basically FVector::SerializeCompressed
+	int32 IntX	= FMath::RoundToInt(ClampedValue.X);
+	int32 IntY	= FMath::RoundToInt(ClampedValue.Y);
+			
+	uint32 Bits	= FMath::Clamp<uint32>( FMath::CeilLogTwo( 1 + FMath::Max( FMath::Abs(IntX), FMath::Abs(IntY) ) ), 1, MaxBitsPerComponent ) - 1;
+
+	// Serialize how many bits each component will have
+	Ar.SerializeInt( Bits, MaxBitsPerComponent );
+
+	int32  Bias	= 1<<(Bits+1);
+	uint32 Max	= 1<<(Bits+2);
+	uint32 DX	= IntX + Bias;
+	uint32 DY	= IntY + Bias;
+
+	if (DX >= Max) { bClamp=true; DX = static_cast<int32>(DX) > 0 ? Max-1 : 0; }
+	if (DY >= Max) { bClamp=true; DY = static_cast<int32>(DY) > 0 ? Max-1 : 0; }
+	
+	Ar.SerializeInt( DX, Max );
+	Ar.SerializeInt( DY, Max );
+
+	return !bClamp;
+}
+
+template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
+bool ReadPackedVector2D(FVector2D &Value, FArchive& Ar)
+{
+	uint32 Bits	= 0;
+
+	// Serialize how many bits each component will have
+	Ar.SerializeInt( Bits, MaxBitsPerComponent );
+
+	int32  Bias = 1<<(Bits+1);
+	uint32 Max	= 1<<(Bits+2);
+	uint32 DX	= 0;
+	uint32 DY	= 0;
+	
+	Ar.SerializeInt( DX, Max );
+	Ar.SerializeInt( DY, Max );
+	
+	
+	float fact = (float)ScaleFactor;
+
+	Value.X = (float)(static_cast<int32>(DX)-Bias) / fact;
+	Value.Y = (float)(static_cast<int32>(DY)-Bias) / fact;
+
+	return true;
+}
+
+template<uint32 ScaleFactor, int32 MaxBitsPerComponent>
+bool SerializePackedVector2D(FVector2D &Vector, FArchive& Ar)
+{
+	if (Ar.IsSaving())
+	{
+		return  WritePackedVector2D<ScaleFactor, MaxBitsPerComponent>(Vector, Ar);
+	}
+
+	ReadPackedVector2D<ScaleFactor, MaxBitsPerComponent>(Vector, Ar);
+	return true;
+}
+
+USTRUCT()
+struct FVector_NetQuantize2D : public FVector2D
+{
+	GENERATED_USTRUCT_BODY()
+
+FORCEINLINE FVector_NetQuantize2D()
+	{}
+
+	explicit FORCEINLINE FVector_NetQuantize2D(EForceInit E)
+: FVector2D(E)
+	{}
+
+	FORCEINLINE FVector_NetQuantize2D(float InX, float InY)
+: FVector2D(InX, InY)
+	{}
+
+	FORCEINLINE FVector_NetQuantize2D(const FVector2D &InVec)
+	{
+		FVector2D::operator=(InVec);
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		bOutSuccess = SerializePackedVector2D<1, 8>(*this, Ar);
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits< FVector_NetQuantize2D > : public TStructOpsTypeTraitsBase2< FVector_NetQuantize2D >
+{
+	enum 
+	{
+		WithNetSerializer = true,
+WithNetSharedSerialization = true,
+};
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// 2. Compile-time Quantizers
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Fixed size quantizers, parameterized at compile time so each payload documents its precision and bit cost where it
+ * is used. Each has:
+ *	Pack()		- Value to the integer that is sent, clamped to the representable range.
+ *	Unpack()	- Integer back to the value.
+ *	Quantize()	- Round trip, use on the sending side so it holds exactly what receivers will see.
+ *	Serialize()	- Reads or writes exactly NumBits per component. Returns false when saving a value that was clamped.
+ * Use inside a custom NetSerialize, or through the WithNetSerializer structs in section 3.
+ */
+namespace NNetQuantize
+{
+	/** Signed fixed point: Value * Scale in NumBits, two's complement range. */
+	template<int32 Scale, uint32 NumBits>
+	struct TFixed
+	{
+		static_assert(Scale > 0, "Scale must be positive.");
+		static_assert(NumBits >= 2 && NumBits <= 30, "NumBits must be in [2, 30].");
+
+		static constexpr uint32 NumBitsUsed = NumBits;
+		static constexpr int32 MaxInt = (1 << (NumBits - 1)) - 1;
+		static constexpr int32 MinInt = -(1 << (NumBits - 1));
+		static constexpr float MaxValue = float(MaxInt) / Scale;
+		static constexpr float MinValue = float(MinInt) / Scale;
+		static constexpr float Step = 1.f / Scale;
+
+		static uint32 Pack(float Value, bool* bOutClamped = nullptr)
+		{
+			const int32 Scaled = FMath::IsNaN(Value) ? 0 : FMath::RoundToInt(FMath::Clamp(Value * Scale, -1073741824.0f, 1073741760.0f));
+			const int32 Clamped = FMath::Clamp(Scaled, MinInt, MaxInt);
+			if (bOutClamped)
+			{
+				*bOutClamped = Clamped != Scaled;
+			}
+
+			return uint32(Clamped - MinInt);
+		}
+
+		static float Unpack(uint32 Packed)
+		{
+			return float(int32(Packed) + MinInt) / Scale;
+		}
+
+		static float Quantize(float Value)
+		{
+			return Unpack(Pack(Value));
+		}
+
+		static bool Serialize(float& Value, FArchive& Ar)
+		{
+			bool bClamped = false;
+			uint32 Packed = Ar.IsSaving() ? Pack(Value, &bClamped) : 0;
+			Ar.SerializeInt(Packed, 1u << NumBits);
+			if (Ar.IsLoading())
+			{
+				Value = Unpack(Packed);
+			}
+
+			return !bClamped;
+		}
+	};
+
+	/** Unsigned fixed point: Value * Scale in NumBits, for values that are never negative (times, positions, rates). */
+	template<int32 Scale, uint32 NumBits>
+	struct TUnsignedFixed
+	{
+		static_assert(Scale > 0, "Scale must be positive.");
+		static_assert(NumBits >= 1 && NumBits <= 30, "NumBits must be in [1, 30].");
+
+		static constexpr uint32 NumBitsUsed = NumBits;
+		static constexpr int32 MaxInt = (1 << NumBits) - 1;
+		static constexpr float MaxValue = float(MaxInt) / Scale;
+		static constexpr float Step = 1.f / Scale;
+
+		static uint32 Pack(float Value, bool* bOutClamped = nullptr)
+		{
+			const int32 Scaled = FMath::IsNaN(Value) ? 0 : FMath::RoundToInt(FMath::Clamp(Value * Scale, -1073741824.0f, 1073741760.0f));
+			const int32 Clamped = FMath::Clamp(Scaled, 0, MaxInt);
+			if (bOutClamped)
+			{
+				*bOutClamped = Clamped != Scaled;
+			}
+
+			return uint32(Clamped);
+		}
+
+		static float Unpack(uint32 Packed)
+		{
+			return float(Packed) / Scale;
+		}
+
+		static float Quantize(float Value)
+		{
+			return Unpack(Pack(Value));
+		}
+
+		static bool Serialize(float& Value, FArchive& Ar)
+		{
+			bool bClamped = false;
+			uint32 Packed = Ar.IsSaving() ? Pack(Value, &bClamped) : 0;
+			Ar.SerializeInt(Packed, 1u << NumBits);
+			if (Ar.IsLoading())
+			{
+				Value = Unpack(Packed);
+			}
+
+			return !bClamped;
+		}
+	};
+
+	/** Bounded range: [MinValue, MaxValue] spread evenly over NumBits. Both ends are exactly representable. */
+	template<int32 MinValue, int32 MaxValue, uint32 NumBits>
+	struct TRange
+	{
+		static_assert(MinValue < MaxValue, "MinValue must be less than MaxValue.");
+		static_assert(NumBits >= 1 && NumBits <= 30, "NumBits must be in [1, 30].");
+
+		static constexpr uint32 NumBitsUsed = NumBits;
+		static constexpr int32 MaxInt = (1 << NumBits) - 1;
+		static constexpr float Step = float(MaxValue - MinValue) / MaxInt;
+
+		static uint32 Pack(float Value, bool* bOutClamped = nullptr)
+		{
+			const float Safe = FMath::IsNaN(Value) ? float(MinValue) : Value;
+			const float Clamped = FMath::Clamp(Safe, float(MinValue), float(MaxValue));
+			if (bOutClamped)
+			{
+				*bOutClamped = Clamped != Safe;
+			}
+
+			return uint32(FMath::RoundToInt((Clamped - MinValue) / Step));
+		}
+
+		static float Unpack(uint32 Packed)
+		{
+			return MinValue + Packed * Step;
+		}
+
+		static float Quantize(float Value)
+		{
+			return Unpack(Pack(Value));
+		}
+
+		static bool Serialize(float& Value, FArchive& Ar)
+		{
+			bool bClamped = false;
+			uint32 Packed = Ar.IsSaving() ? Pack(Value, &bClamped) : 0;
+			Ar.SerializeInt(Packed, 1u << NumBits);
+			if (Ar.IsLoading())
+			{
+				Value = Unpack(Packed);
+			}
+
+			return !bClamped;
+		}
+	};
+
+	/** Angle in degrees over the full circle in NumBits. Wraps rather than clamps, unpacks to (-180, 180]. */
+	template<uint32 NumBits>
+	struct TAngle
+	{
+		static_assert(NumBits >= 2 && NumBits <= 30, "NumBits must be in [2, 30].");
+
+		static constexpr uint32 NumBitsUsed = NumBits;
+		static constexpr uint32 NumSteps = 1u << NumBits;
+		static constexpr float Step = 360.f / NumSteps;
+
+		static uint32 Pack(float Value, bool* bOutClamped = nullptr)
+		{
+			if (bOutClamped)
+			{
+				*bOutClamped = false;
+			}
+
+			const float Safe = FMath::IsNaN(Value) ? 0.f : Value;
+			return uint32(FMath::RoundToInt(FRotator::ClampAxis(Safe) / Step)) & (NumSteps - 1);
+		}
+
+		static float Unpack(uint32 Packed)
+		{
+			return FRotator::NormalizeAxis(Packed * Step);
+		}
+
+		static float Quantize(float Value)
+		{
+			return Unpack(Pack(Value));
+		}
+
+		static bool Serialize(float& Value, FArchive& Ar)
+		{
+			uint32 Packed = Ar.IsSaving() ? Pack(Value) : 0;
+			Ar.SerializeInt(Packed, NumSteps);
+			if (Ar.IsLoading())
+			{
+				Value = Unpack(Packed);
+			}
+
+			return true;
+		}
+	};
+
+	/** Applies the scalar quantizer TScalar to each component of a 2D vector. */
+	template<typename TScalar>
+	struct TVector2D
+	{
+		static constexpr uint32 NumBitsUsed = 2 * TScalar::NumBitsUsed;
+
+		static FVector2D Quantize(const FVector2D& Value)
+		{
+			return FVector2D(TScalar::Quantize(Value.X), TScalar::Quantize(Value.Y));
+		}
+
+		static bool Serialize(FVector2D& Value, FArchive& Ar)
+		{
+			bool bSuccess = TScalar::Serialize(Value.X, Ar);
+			bSuccess &= TScalar::Serialize(Value.Y, Ar);
+			return bSuccess;
+		}
+	};
+
+	/** Applies the scalar quantizer TScalar to each component of a 3D vector. */
+	template<typename TScalar>
+	struct TVector
+	{
+		static constexpr uint32 NumBitsUsed = 3 * TScalar::NumBitsUsed;
+
+		static FVector Quantize(const FVector& Value)
+		{
+			return FVector(TScalar::Quantize(Value.X), TScalar::Quantize(Value.Y), TScalar::Quantize(Value.Z));
+		}
+
+		static bool Serialize(FVector& Value, FArchive& Ar)
+		{
+			bool bSuccess = TScalar::Serialize(Value.X, Ar);
+			bSuccess &= TScalar::Serialize(Value.Y, Ar);
+			bSuccess &= TScalar::Serialize(Value.Z, Ar);
+			return bSuccess;
+		}
+	};
+
+	/** Rotator as NumBits per axis. Roll is optional since most aim and facing payloads never roll. */
+	template<uint32 NumBits, bool bWithRoll = true>
+	struct TRotator
+	{
+		using FAxis = TAngle<NumBits>;
+		static constexpr uint32 NumBitsUsed = (bWithRoll ? 3 : 2) * NumBits;
+
+		static FRotator Quantize(const FRotator& Value)
+		{
+			return FRotator(FAxis::Quantize(Value.Pitch), FAxis::Quantize(Value.Yaw), bWithRoll ? FAxis::Quantize(Value.Roll) : 0.f);
+		}
+
+		static bool Serialize(FRotator& Value, FArchive& Ar)
+		{
+			FAxis::Serialize(Value.Pitch, Ar);
+			FAxis::Serialize(Value.Yaw, Ar);
+			if (bWithRoll)
+			{
+				FAxis::Serialize(Value.Roll, Ar);
+			}
+			else if (Ar.IsLoading())
+			{
+				Value.Roll = 0.f;
+			}
+
+			return true;
+		}
+	};
+
+	/** Unit vector as two octahedral components of NumBits each, the receiver renormalizes. */
+	template<uint32 NumBits>
+	struct TUnitVector
+	{
+		using FComponent = TRange<-1, 1, NumBits>;
+		static constexpr uint32 NumBitsUsed = 2 * NumBits;
+
+		/** +1 for zero, so a component of 0 still folds to one side. FMath::Sign() would collapse it to the upper hemisphere. */
+		static float SignNotZero(float Value)
+		{
+			return Value >= 0.f ? 1.f : -1.f;
+		}
+
+		static FVector2D Encode(const FVector& Value)
+		{
+			const float L1 = FMath::Abs(Value.X) + FMath::Abs(Value.Y) + FMath::Abs(Value.Z);
+			if (L1 < SMALL_NUMBER)
+			{
+				return FVector2D::ZeroVector;
+			}
+
+			FVector2D Oct(Value.X / L1, Value.Y / L1);
+			if (Value.Z < 0.f)
+			{
+				// Fold the lower hemisphere over the diagonals
+				Oct = FVector2D((1.f - FMath::Abs(Oct.Y)) * SignNotZero(Oct.X), (1.f - FMath::Abs(Oct.X)) * SignNotZero(Oct.Y));
+			}
+
+			return Oct;
+		}
+
+		static FVector Decode(const FVector2D& Oct)
+		{
+			FVector Value(Oct.X, Oct.Y, 1.f - FMath::Abs(Oct.X) - FMath::Abs(Oct.Y));
+			if (Value.Z < 0.f)
+			{
+				Value.X = (1.f - FMath::Abs(Oct.Y)) * SignNotZero(Oct.X);
+				Value.Y = (1.f - FMath::Abs(Oct.X)) * SignNotZero(Oct.Y);
+			}
+
+			return Value.GetSafeNormal();
+		}
+
+		static FVector Quantize(const FVector& Value)
+		{
+			const FVector2D Oct = Encode(Value);
+			return Decode(FVector2D(FComponent::Quantize(Oct.X), FComponent::Quantize(Oct.Y)));
+		}
+
+		static bool Serialize(FVector& Value, FArchive& Ar)
+		{
+			FVector2D Oct = Ar.IsSaving() ? Encode(Value) : FVector2D::ZeroVector;
+			FComponent::Serialize(Oct.X, Ar);
+			FComponent::Serialize(Oct.Y, Ar);
+			if (Ar.IsLoading())
+			{
+				Value = Decode(Oct);
+			}
+
+			return true;
+		}
+	};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// 3. Quantized Structs
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Pitch (X) and yaw (Y) in degrees, 12 bits each (0.088 degrees) */
+USTRUCT()
+struct FVector2D_NetQuantizeAngles : public FVector2D
+{
+	GENERATED_USTRUCT_BODY()
+
+	using FQuantizer = NNetQuantize::TVector2D<NNetQuantize::TAngle<12>>;
+
+	FORCEINLINE FVector2D_NetQuantizeAngles()
+	{}
+
+	FORCEINLINE FVector2D_NetQuantizeAngles(float InPitch, float InYaw)
+		: FVector2D(InPitch, InYaw)
+	{}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		bOutSuccess = FQuantizer::Serialize(*this, Ar);
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVector2D_NetQuantizeAngles> : public TStructOpsTypeTraitsBase2<FVector2D_NetQuantizeAngles>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+	};
+};
+
+
+/** Unit vector, octahedral with 10 bits per component (20 bits, against 48 for FVector_NetQuantizeNormal) */
+USTRUCT()
+struct FVector_NetQuantizeUnitOct : public FVector
+{
+	GENERATED_USTRUCT_BODY()
+
+	using FQuantizer = NNetQuantize::TUnitVector<10>;
+
+	FORCEINLINE FVector_NetQuantizeUnitOct()
+	{}
+
+	FORCEINLINE FVector_NetQuantizeUnitOct(const FVector& InVec)
+		: FVector(InVec)
+	{}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		bOutSuccess = FQuantizer::Serialize(*this, Ar);
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVector_NetQuantizeUnitOct> : public TStructOpsTypeTraitsBase2<FVector_NetQuantizeUnitOct>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+	};
+};
+
+
+/** Rotator with 16 bits per axis (0.0055 degrees) */
+USTRUCT()
+struct FRotator_NetQuantize : public FRotator
+{
+	GENERATED_USTRUCT_BODY()
+
+	using FQuantizer = NNetQuantize::TRotator<16>;
+
+	FORCEINLINE FRotator_NetQuantize()
+	{}
+
+	FORCEINLINE FRotator_NetQuantize(const FRotator& InRot)
+		: FRotator(InRot)
+	{}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		bOutSuccess = FQuantizer::Serialize(*this, Ar);
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FRotator_NetQuantize> : public TStructOpsTypeTraitsBase2<FRotator_NetQuantize>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+	};
+};
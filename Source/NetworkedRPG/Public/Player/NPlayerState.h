@@ -12,6 +12,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FNOnGameplayAttributeValueChanged
 
 class UNAbilitySystemComponent;
 class UNAttributeSetBase;
+class UNNetFrequencyComponent;
 /**
  * 
  */
@@ -31,6 +32,10 @@ protected:
 
 	UPROPERTY()
 	UNAttributeSetBase* AttributeSetBase;
+
+	/** [server] Raises NetUpdateFrequency while the player is in combat */
+	UPROPERTY(VisibleAnywhere)
+	UNNetFrequencyComponent* NetFrequencyComponent;
 	
 	FGameplayTag DeadTag;
 	
@@ -40,6 +45,10 @@ protected:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// 2. Overrides
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+	/** Counted per net frequency state in 'stat NRPG'. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 protected:
 	/** Called when the player state is created. */
 	virtual void BeginPlay() override;